@@ -0,0 +1,36 @@
+// adv_mgr.h -- 广播管理：一个扩展广播集承载定向与非定向广播
+// 慢速广播先以快速间隔广播一段时间，之后按功耗模式降到 adv_profile_get() 的间隔，
+// 重连退避中再按退避次数放慢。
+// 载荷只有 flags、首选连接间隔和戒指标识，不需要扫描响应
+#ifndef ADV_MGR_H
+#define ADV_MGR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/addr.h>
+
+// 戒指标识：制造商数据（公司 ID + "RNG" + 协议版本），扫描端按此过滤
+#define RING_ADV_COMPANY_ID 0x0059   // 开发阶段使用 Nordic 的公司 ID
+#define RING_ADV_ID_VERSION 1
+#define RING_ADV_ID_BYTES                                                   \
+    (RING_ADV_COMPANY_ID & 0xff), (RING_ADV_COMPANY_ID >> 8), 'R', 'N', 'G', \
+    RING_ADV_ID_VERSION
+
+enum adv_mgr_mode {
+    ADV_MGR_OFF,
+    ADV_MGR_DIRECTED_HIGH,   // 高占空比定向，控制器 1.28 s 后自行停止
+    ADV_MGR_DIRECTED_LOW,    // 低占空比定向，快速间隔
+    ADV_MGR_BEACON,          // 慢速广播：有 peer 时为低占空比定向，否则为非定向
+};
+
+int adv_mgr_init(void);
+// 只能在系统工作队列中调用；burst 为 true 时慢速广播先快速广播一段时间
+int adv_mgr_start(enum adv_mgr_mode mode, const bt_addr_le_t *peer, bool burst);
+void adv_mgr_stop(void);
+// 慢速广播重新快速广播一段时间（用户活动后）
+void adv_mgr_burst(void);
+// 设置慢速广播的退避次数，间隔见 adv_profile_backoff()；0 恢复功耗模式的间隔。
+// 只能在系统工作队列中调用
+void adv_mgr_backoff(uint32_t attempt);
+
+#endif // ADV_MGR_H
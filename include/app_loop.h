@@ -0,0 +1,31 @@
+// app_loop.h -- 应用事件循环：一个专用工作队列承载 HR 转发、状态记录、LED 图案和链路统计
+// 蓝牙主机相关的短任务（广播/重连）仍在系统工作队列上
+#ifndef APP_LOOP_H
+#define APP_LOOP_H
+
+#include <stddef.h>
+#include <zephyr/kernel.h>
+
+struct app_loop_stats {
+    size_t stack_size;
+    size_t stack_used;     // 栈使用高水位 (B)，未开启 CONFIG_INIT_STACKS 时为 0
+    int reclaimed;         // 相比基线的 HR 转发/状态监视线程节省的 RAM (B)，负数为多用
+};
+
+int app_loop_init(void);
+struct k_work_q *app_loop_queue(void);
+void app_loop_get_stats(struct app_loop_stats *stats);
+
+static inline int app_loop_submit(struct k_work *work) {
+    return k_work_submit_to_queue(app_loop_queue(), work);
+}
+
+static inline int app_loop_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return k_work_schedule_for_queue(app_loop_queue(), dwork, delay);
+}
+
+static inline int app_loop_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return k_work_reschedule_for_queue(app_loop_queue(), dwork, delay);
+}
+
+#endif // APP_LOOP_H
@@ -0,0 +1,24 @@
+// battery.h -- 电池电量计：SAADC 过采样、电压-电量曲线、BAS 发布
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include <errno.h>
+#include <stdint.h>
+
+#if defined(CONFIG_RING_BATTERY)
+int battery_init(void);
+// 立即采样一次并发布（电量变化时通知功耗管理和 BAS）
+int battery_sample_now(void);
+// 最近一次测得的电池电压 (mV)，尚未采样时为 0
+uint16_t battery_get_mv(void);
+// 设置 ADC 模拟器 (native_sim) 上的电池电压 (mV)，下一次采样生效；没有模拟器时返回 -ENOTSUP
+int battery_emul_set_mv(uint16_t mv);
+#else
+// 没有电池 ADC 通道的板子（BabbleSim）：电量保持 100%
+static inline int battery_init(void) { return 0; }
+static inline int battery_sample_now(void) { return -ENOTSUP; }
+static inline uint16_t battery_get_mv(void) { return 0; }
+static inline int battery_emul_set_mv(uint16_t mv) { return -ENOTSUP; }
+#endif
+
+#endif // BATTERY_H
@@ -0,0 +1,52 @@
+// beat_detect.h -- PPG 心搏检测：斜率和函数 (SSF) + 自适应阈值，按批处理
+// 纯逻辑，不依赖内核，全部为整数运算。SSF 为约 128 ms 窗口内上升斜率之和，
+// 每个脉搏的上升沿形成一个峰；SSF 越过阈值的时刻（样本间线性插值）作为心搏时刻。
+// 阈值为近期 SSF 峰值均值的 60%，长时间没有心搏时逐渐降低。
+// 输入约定收缩期向上（反射式 PPG 的原始计数需先取反）
+#ifndef BEAT_DETECT_H
+#define BEAT_DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BEAT_SSF_MAX       32     // SSF 窗口最大样本数，支持到 250 Hz
+#define BEAT_LEARN_MS      2000   // 启动后只学习幅度、不检测的时长
+#define BEAT_REFRACTORY_MS 300    // 两次心搏的最小间隔
+#define BEAT_LOST_MS       4000   // 超过该时长没有心搏时 hr 置 0（脱落或运动伪差）
+#define BEAT_RR_MIN        307    // 1/1024 s，约 300 ms
+#define BEAT_RR_MAX        2048   // 约 2 s，更长的间隔不输出 RR
+#define BEAT_HR_AVG        4      // hr 取最近几个 RR 的平均
+
+struct beat_detect {
+    uint16_t rate_hz;
+    uint8_t w;                   // SSF 窗口（样本）
+    uint8_t d_pos;
+    int32_t d[BEAT_SSF_MAX];     // 窗口内的正斜率
+    int32_t lp;                  // 平滑后的样本
+    int32_t ssf;
+    int32_t ssf_prev;
+    int32_t level;               // 近期 SSF 峰值均值
+    int32_t threshold;
+    int32_t peak;                // 当前脉搏的 SSF 峰值
+    uint32_t onset;              // 当前脉搏越过阈值的时刻 (1/1024 s)
+    bool in_pulse;
+    bool have_beat;
+    bool started;                // 已收到第一个样本
+    uint16_t learn;              // 剩余的学习样本数
+    uint32_t n;                  // 已处理样本数，只用于统计，回绕不影响检测
+    uint32_t t;                  // 当前样本时刻 (1/1024 s)，逐样本累加
+    uint16_t t_rem;              // t 的余数，单位 1/rate_hz 个 1/1024 s
+    uint32_t last_beat;          // 上一次心搏时刻 (1/1024 s)
+    uint16_t rr_hist[BEAT_HR_AVG];
+    uint8_t rr_count;
+    // 结果
+    uint16_t hr;                 // bpm，0 表示没有有效心搏
+    uint32_t beats;
+};
+
+void beat_detect_init(struct beat_detect *bd, uint16_t rate_hz);
+// 处理一批样本；本批检测到的 RR 间期（1/1024 s）写入 rr，最多 rr_max 个，返回个数
+uint8_t beat_detect_run(struct beat_detect *bd, const int32_t *x, uint16_t count, uint16_t *rr,
+                        uint8_t rr_max);
+
+#endif // BEAT_DETECT_H
@@ -0,0 +1,63 @@
+// bulk.h -- 批量传输：在 L2CAP CoC 上传输历史块、诊断记录和测速数据
+// 发起方先把链路切到大数据包（DLE）、2M PHY 和 ACTIVE 连接参数，再连接通道并发送请求；
+// 服务端逐条回送 SDU，每个 SDU 以条目类型开头，以 END 结束。发起方收到 END 后断开通道，
+// 恢复 1M PHY 和按功耗模式的连接参数。流控使用 LE 信用：对方未给信用时 SDU 留在
+// 发送缓冲中，发送缓冲用尽后等 sent 回调再继续
+#ifndef BULK_H
+#define BULK_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/toolchain.h>
+
+// 请求内容位
+#define BULK_REQ_HISTORY  BIT(0)
+#define BULK_REQ_DIAG     BIT(1)
+#define BULK_REQ_TEST     BIT(2)
+
+// 每个 SDU 的第一个字节
+enum bulk_item {
+    BULK_ITEM_HISTORY = 1,   // 历史块（块头 + 记录，见 history_codec.h）
+    BULK_ITEM_ENERGY = 2,    // struct ring_energy_record
+    BULK_ITEM_TEST = 3,      // 测速填充数据
+    BULK_ITEM_END = 0xff,    // struct bulk_end
+};
+
+struct bulk_request {
+    uint8_t what;            // BULK_REQ_*
+    uint16_t test_kib;       // BULK_REQ_TEST 的数据量
+} __packed;
+
+struct bulk_end {
+    uint16_t items;
+    uint32_t bytes;          // 服务端发出的 SDU 字节数，不含 END
+} __packed;
+
+struct bulk_stats {
+    uint32_t transfers;
+    uint32_t failures;       // 通道在 END 之前断开
+    uint32_t served;         // 作为服务端完成的请求
+    // 最近一次拉取
+    uint32_t bytes;
+    uint16_t items;
+    uint32_t ms;
+    uint32_t airtime_us;     // 射频开启时间估算，见 bulk_airtime_us()
+    uint16_t mtu;
+    uint16_t mps;
+    uint16_t ll_octets;
+    bool phy_2m;
+};
+
+#if defined(CONFIG_RING_BULK)
+int bulk_init(void);
+// 从对方拉取数据，结果写入日志（history/energy 记录）和统计；只能有一次在进行
+int bulk_pull(struct bt_conn *conn, uint8_t what, uint16_t test_kib);
+void bulk_get_stats(struct bulk_stats *stats);
+#else
+static inline int bulk_init(void) { return 0; }
+static inline int bulk_pull(struct bt_conn *conn, uint8_t what, uint16_t test_kib) { return -ENOTSUP; }
+#endif
+
+#endif // BULK_H
@@ -0,0 +1,25 @@
+// conn_params.h -- 每条链路的连接参数协商：跟踪请求/生效参数，失败退避重试
+#ifndef CONN_PARAMS_H
+#define CONN_PARAMS_H
+
+#include <zephyr/bluetooth/conn.h>
+#include "ring_analytics.h"
+
+struct conn_params_stats {
+    uint32_t requests;     // 本端发起的更新请求
+    uint32_t applied;      // 达到目标参数的次数
+    uint32_t rejected;     // 被拒绝或结果不符
+    uint32_t timeouts;     // 等不到 le_param_updated
+    uint32_t peer_requests;
+};
+
+int conn_params_init(void);
+// 各功耗模式的目标连接参数（中心端建连时也直接使用）
+const struct bt_le_conn_param *conn_params_for_mode(power_mode_t mode);
+// 链路当前参数是否已符合该模式
+bool conn_params_link_settled(struct bt_conn *conn);
+// 批量传输期间让链路保持 ACTIVE 参数，结束后回到当前模式
+void conn_params_bulk(struct bt_conn *conn, bool on);
+void conn_params_get_stats(struct conn_params_stats *stats);
+
+#endif // CONN_PARAMS_H
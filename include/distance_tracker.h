@@ -0,0 +1,60 @@
+// distance_tracker.h -- 带迟滞和最短驻留时间的距离区域状态机
+// 纯逻辑，不依赖蓝牙协议栈和内核
+#ifndef DISTANCE_TRACKER_H
+#define DISTANCE_TRACKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ring_analytics.h"
+
+// 相邻区域之间的边界数：VERY_CLOSE|CLOSE|MEDIUM|FAR|VERY_FAR
+#define DISTANCE_BOUNDARY_COUNT RSSI_THRESHOLD_COUNT
+
+#ifdef CONFIG_RING_DISTANCE_HYSTERESIS_DB
+#define DISTANCE_HYSTERESIS_DB CONFIG_RING_DISTANCE_HYSTERESIS_DB
+#else
+#define DISTANCE_HYSTERESIS_DB 4
+#endif
+
+#ifdef CONFIG_RING_DISTANCE_DWELL_MS
+#define DISTANCE_DWELL_MS CONFIG_RING_DISTANCE_DWELL_MS
+#else
+#define DISTANCE_DWELL_MS 6000
+#endif
+
+struct distance_tracker_config {
+    // threshold[i]: 区域 i+1 的下限 (dBm)，即区域 i+1 与 i+2 的边界
+    int8_t threshold[DISTANCE_BOUNDARY_COUNT];
+    // hysteresis[i]: 跨越边界 i 需要额外超过的余量 (dB)
+    uint8_t hysteresis[DISTANCE_BOUNDARY_COUNT];
+    // 新区域需要持续的最短时间
+    uint32_t dwell_ms;
+};
+
+#define DISTANCE_TRACKER_CONFIG_DEFAULT {                                     \
+    .threshold = { RSSI_VERY_CLOSE_THRESHOLD, RSSI_CLOSE_THRESHOLD,            \
+                   RSSI_MEDIUM_THRESHOLD, RSSI_FAR_THRESHOLD },                \
+    .hysteresis = { DISTANCE_HYSTERESIS_DB, DISTANCE_HYSTERESIS_DB,            \
+                    DISTANCE_HYSTERESIS_DB, DISTANCE_HYSTERESIS_DB },          \
+    .dwell_ms = DISTANCE_DWELL_MS,                                             \
+}
+
+struct distance_tracker {
+    distance_level_t zone;       // 已确认的区域
+    distance_level_t candidate;  // 等待驻留时间确认的区域
+    uint32_t candidate_since;
+};
+
+// 设置各边界阈值（递减）并据此重新计算迟滞：每个边界的迟滞为 hysteresis_db，
+// 但不超过相邻区域宽度减 1 的一半，使中间区域两侧的迟滞之和小于区域宽度，
+// 从两侧都能以区域内的读数进入。阈值在运行时修改后必须经此更新
+void distance_tracker_config_set(struct distance_tracker_config *cfg,
+                                 const int8_t threshold[DISTANCE_BOUNDARY_COUNT],
+                                 uint8_t hysteresis_db);
+void distance_tracker_init(struct distance_tracker *tracker);
+// 输入一次滤波后的 RSSI；区域确认变化时返回 true
+bool distance_tracker_update(struct distance_tracker *tracker,
+                             const struct distance_tracker_config *cfg,
+                             int8_t rssi, uint32_t now_ms);
+
+#endif // DISTANCE_TRACKER_H
@@ -0,0 +1,78 @@
+// energy_stats.h -- 能耗统计：各功耗模式时长、射频/HCI/LED/UART 活动计数，
+// 结合 Kconfig 中的电流表（RING_ENERGY_*）估算消耗电荷，用于比较固件改动前后的续航
+#ifndef ENERGY_STATS_H
+#define ENERGY_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ring_analytics.h"
+#include "ring_status.h"
+
+#define ENERGY_MODE_COUNT (POWER_MODE_DEEP_SLEEP + 1)
+
+enum energy_link {
+    ENERGY_LINK_CENTRAL,     // 本端作为中心
+    ENERGY_LINK_PERIPHERAL,  // 本端作为外设
+    ENERGY_LINK_COUNT
+};
+
+// 各自独立计时的广播集，射频上互不重叠，空口时间相加
+enum energy_adv {
+    ENERGY_ADV_LINK,         // adv_mgr 的可连接广播
+    ENERGY_ADV_PRESENCE,     // 承载周期广播的扩展广播（仅带 SyncInfo）
+    ENERGY_ADV_PERIODIC,     // 周期广播列车
+    ENERGY_ADV_COUNT
+};
+
+// 电荷分项，顺序与二进制记录 charge_uc[] 一致
+enum energy_category {
+    ENERGY_CAT_BASE,         // 各模式基础电流 × 时长
+    ENERGY_CAT_RADIO,        // 连接事件
+    ENERGY_CAT_HCI,          // 应用发起的控制器命令
+    ENERGY_CAT_LED,
+    ENERGY_CAT_UART,         // 日志输出字节
+    ENERGY_CAT_SCAN,         // 扫描接收窗口
+    ENERGY_CAT_ADV,          // 广播发射
+    ENERGY_CAT_COUNT
+};
+
+struct energy_report {
+    uint32_t window_ms;                       // 统计窗口（上次清零至今）
+    uint32_t mode_ms[ENERGY_MODE_COUNT];
+    uint32_t conn_events[ENERGY_LINK_COUNT];  // 按间隔和从机延迟估算
+    uint32_t hci_cmds;
+    uint32_t led_on_ms;                       // 各 LED 点亮时长之和
+    uint32_t uart_bytes;
+    uint32_t scan_ms;                         // 扫描开启时长
+    uint32_t scan_rx_ms;                      // 其中接收窗口时长
+    uint32_t adv_events;                      // 按广播间隔估算，各广播集之和
+    uint32_t adv_airtime_ms;
+    uint32_t per_adv_airtime_ms;              // 其中周期广播
+    uint64_t charge_nc[ENERGY_CAT_COUNT];
+    uint64_t total_nc;
+};
+
+int energy_stats_init(void);
+// 重新开始统计窗口（对比测试前调用）
+void energy_stats_reset(void);
+void energy_stats_hci_cmd(void);
+// led 为 DK LED 编号，重复设置同一状态不计时
+void energy_stats_led(uint8_t led, bool on);
+// 扫描开始（间隔/窗口，0.625 ms 单位）或停止（window 为 0）
+void energy_stats_scan(uint16_t interval, uint16_t window);
+// 广播集 set 开始（事件平均间隔与单次事件空口时间，µs）或停止（period_us 为 0）
+void energy_stats_adv(enum energy_adv set, uint32_t period_us, uint32_t airtime_us);
+void energy_stats_get(struct energy_report *report);
+void energy_stats_record_fill(struct ring_energy_record *rec);
+
+// 平均电流 (µA) = nC / ms
+static inline uint32_t energy_report_avg_ua(const struct energy_report *report) {
+    return report->window_ms ? (uint32_t)(report->total_nc / report->window_ms) : 0;
+}
+
+// 扫描占空比 (‰)
+static inline uint32_t energy_report_scan_duty(const struct energy_report *report) {
+    return report->scan_ms ? (uint32_t)((uint64_t)report->scan_rx_ms * 1000 / report->scan_ms) : 0;
+}
+
+#endif // ENERGY_STATS_H
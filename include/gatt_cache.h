@@ -0,0 +1,32 @@
+// gatt_cache.h -- 已绑定对端的 GATT 发现结果缓存
+// 以对端身份地址为键保存在 settings "ring/gatt/<addr>"，用对端的 Database Hash 校验有效性
+#ifndef GATT_CACHE_H
+#define GATT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/addr.h>
+
+#define GATT_CACHE_HASH_LEN 16
+#define GATT_CACHE_LOCATION_UNKNOWN 0xFF
+
+struct gatt_cache_entry {
+    uint8_t db_hash[GATT_CACHE_HASH_LEN];
+    uint16_t hrs_measurement;       // 值句柄
+    uint16_t hrs_measurement_ccc;
+    uint16_t hrs_location;
+    uint8_t sensor_location;        // GATT_CACHE_LOCATION_UNKNOWN 表示未读到
+    uint16_t lbs_button;
+    uint16_t lbs_button_ccc;
+    uint16_t lbs_led;
+};
+
+// 没有该对端的条目时返回 -ENOENT
+int gatt_cache_find(const bt_addr_le_t *addr, struct gatt_cache_entry *entry);
+// 只应为已绑定对端调用；表满时替换已不再绑定的条目
+int gatt_cache_store(const bt_addr_le_t *addr, const struct gatt_cache_entry *entry);
+// addr 为 NULL 时清空全部
+void gatt_cache_delete(const bt_addr_le_t *addr);
+int gatt_cache_count(void);
+
+#endif // GATT_CACHE_H
@@ -0,0 +1,65 @@
+// gatt_ops.h -- 每条连接的 GATT 操作编排器
+// 同一链路同一时刻只有一个 ATT 操作在途；操作按提交顺序在应用事件循环上发起，
+// 发起时 -ENOMEM/-EBUSY 按退避重试；已在队列中的操作重复提交会被忽略，
+// 因此连接、加密等事件无论先后到达，都不会产生重复的 ATT 往返
+#ifndef GATT_OPS_H
+#define GATT_OPS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#define GATT_OPS_QUEUE_LEN 8
+// start() 返回值：操作已同步完成，不等待 ATT 响应
+#define GATT_OP_DONE 1
+
+// 需要写入对端绑定状态的操作（如 CCC）等待加密完成后再发起
+#define GATT_OP_F_ENCRYPTED BIT(0)
+
+struct gatt_ops;
+
+struct gatt_op {
+    const char *name;
+    // 返回 0 表示请求已发出，完成时须调用 gatt_ops_complete()；
+    // GATT_OP_DONE 表示同步完成；-ENOMEM/-EBUSY 退避重试；其他负值视为失败
+    int (*start)(struct bt_conn *conn);
+    uint8_t flags;
+};
+
+struct gatt_ops_stats {
+    uint32_t att_ops;       // 发出的异步操作数
+    uint32_t retries;
+    uint32_t failures;
+};
+
+struct gatt_ops {
+    struct k_spinlock lock;
+    struct bt_conn *conn;
+    const struct gatt_op *queue[GATT_OPS_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+    const struct gatt_op *in_flight;
+    uint8_t attempts;
+    bool encrypted;         // 加密已完成（或已确定失败），放行 GATT_OP_F_ENCRYPTED 操作
+    struct k_work_delayable pump;
+    // 操作最终失败时调用（应用事件循环或蓝牙 RX 上下文）
+    void (*failed)(const struct gatt_op *op, int err);
+    // 队列排空时在应用事件循环上调用
+    void (*idle)(void);
+    struct gatt_ops_stats stats;
+};
+
+void gatt_ops_init(struct gatt_ops *ops, void (*failed)(const struct gatt_op *op, int err),
+                   void (*idle)(void));
+// 绑定到新连接并清空队列和统计
+void gatt_ops_attach(struct gatt_ops *ops, struct bt_conn *conn);
+void gatt_ops_detach(struct gatt_ops *ops);
+// 队列满时返回 -ENOMEM，未连接时返回 -ENOTCONN
+int gatt_ops_submit(struct gatt_ops *ops, const struct gatt_op *op);
+// 在途操作的 ATT 完成回调中调用；err 非 0 时计为失败
+void gatt_ops_complete(struct gatt_ops *ops, struct bt_conn *conn, int err);
+void gatt_ops_set_encrypted(struct gatt_ops *ops);
+
+#endif // GATT_OPS_H
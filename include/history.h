@@ -0,0 +1,48 @@
+// history.h -- 心率与距离历史记录：差分编码后按块写入 settings 分区
+// 块在 RAM 中累积，写满或超过当前模式的缓存时间（history_profile_get）时整块保存为
+// 一个 settings 条目 "ring/hist/<槽>"，CONFIG_RING_HISTORY_BLOCKS 个槽循环覆盖；
+// 磨损均衡交给 settings 后端（nRF54L 上为 ZMS）。块格式见 history_codec.h
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hr_ring.h"
+#include "hrv.h"
+
+struct history_stats {
+    uint32_t records;
+    uint32_t dropped;      // 两个块缓冲都未写出时丢弃的记录
+    uint32_t flushes;
+    uint32_t write_errors;
+    uint32_t bytes;        // 写入 settings 的块字节数（含块头）
+    uint32_t seq;          // 最近写出的块序号
+    uint16_t boot;
+};
+
+#if defined(CONFIG_RING_HISTORY)
+// 在 settings_load() 之后调用
+int history_init(void);
+void history_hr(const struct hr_sample *sample);
+// 按当前模式的 hrv_s 周期记录 HRV 指标，窗口不足时不记录
+void history_hrv(const struct hrv *h);
+void history_touch(bool pressed, bool remote);
+void history_get_stats(struct history_stats *stats);
+// 立即写出缓存中的记录并等待完成；不能在事件循环中调用
+void history_sync(void);
+// 已写出的块数；第 i 块（0 为最旧）的块头加记录读到 buf，返回字节数
+uint16_t history_block_count(void);
+int history_block_read(uint16_t i, void *buf, size_t len);
+#else
+static inline int history_init(void) { return 0; }
+static inline void history_hr(const struct hr_sample *sample) {}
+static inline void history_hrv(const struct hrv *h) {}
+static inline void history_touch(bool pressed, bool remote) {}
+static inline void history_sync(void) {}
+static inline uint16_t history_block_count(void) { return 0; }
+static inline int history_block_read(uint16_t i, void *buf, size_t len) { return -ENOTSUP; }
+#endif
+
+#endif // HISTORY_H
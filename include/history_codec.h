@@ -0,0 +1,66 @@
+// history_codec.h -- 历史记录块的差分编码，纯逻辑，不依赖内核
+// 块 = 16 字节块头 + 记录区。每条记录：
+//   1 字节 type(低 4 位) | arg(高 4 位)，varint 距上一条记录的秒数，之后按类型：
+//   HR     zigzag varint，与块内上一条 HR 的差（块内首条与 0 比较）
+//   RR     arg 为个数，每个为 zigzag varint，与块内上一个 RR 的差（1/1024 s）
+//   ZONE   arg 为 distance_level_t，无载荷
+//   TOUCH  arg 为 HISTORY_TOUCH_* 位，无载荷
+//   HRV    (v2) varint RMSSD (ms)、SDNN (ms)、压力指数，不做差分
+// varint 为 LEB128，块头字段为小端。格式变化时递增 HISTORY_FORMAT_VERSION
+// 并同步更新 scripts/decode_status.py 与 README「History Store」
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HISTORY_FORMAT_VERSION 2   // v2 增加 HRV 记录，v1 块仍可读
+#define HISTORY_HEADER_SIZE    16
+#define HISTORY_RR_MAX         15
+
+enum history_type {
+    HISTORY_HR = 1,
+    HISTORY_RR = 2,
+    HISTORY_ZONE = 3,
+    HISTORY_TOUCH = 4,
+    HISTORY_HRV = 5,
+};
+
+#define HISTORY_TOUCH_PRESSED  (1u << 0)
+#define HISTORY_TOUCH_REMOTE   (1u << 1)   // 对方戒指的触摸
+
+struct history_block_header {
+    uint8_t version;
+    uint8_t flags;       // 保留，写 0
+    uint16_t boot;       // 写入时的启动计数
+    uint32_t seq;        // 块序号，单调递增，用于找到最旧/最新块
+    uint32_t start_s;    // 本次启动后的秒数，块内时间的基准
+    uint16_t count;      // 记录数
+    uint16_t len;        // 记录区字节数
+};
+
+struct history_encoder {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t len;
+    uint16_t count;
+    uint32_t start_s;
+    uint32_t last_s;
+    uint16_t last_hr;
+    uint16_t last_rr;
+};
+
+void history_encoder_init(struct history_encoder *enc, uint8_t *buf, uint16_t size, uint32_t start_s);
+// 空间不足时返回 false，编码器不变；t_s 早于上一条时按同一时刻记录
+bool history_encode_hr(struct history_encoder *enc, uint32_t t_s, uint16_t hr);
+bool history_encode_rr(struct history_encoder *enc, uint32_t t_s, const uint16_t *rr, uint8_t count);
+bool history_encode_zone(struct history_encoder *enc, uint32_t t_s, uint8_t zone);
+bool history_encode_touch(struct history_encoder *enc, uint32_t t_s, uint8_t flags);
+bool history_encode_hrv(struct history_encoder *enc, uint32_t t_s, uint16_t rmssd_ms,
+                        uint16_t sdnn_ms, uint16_t stress);
+
+void history_header_write(uint8_t out[HISTORY_HEADER_SIZE], const struct history_block_header *hdr);
+// 版本不认识时返回 false
+bool history_header_read(const uint8_t in[HISTORY_HEADER_SIZE], struct history_block_header *hdr);
+
+#endif // HISTORY_CODEC_H
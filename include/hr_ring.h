@@ -0,0 +1,37 @@
+// hr_ring.h -- 单生产者/单消费者无锁心率样本环形缓冲区
+// 生产者为蓝牙 RX 回调，消费者为 HR 转发线程
+#ifndef HR_RING_H
+#define HR_RING_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HR_RING_SIZE      CONFIG_RING_HR_RING_SIZE
+#define HR_SAMPLE_RR_MAX  CONFIG_RING_HR_SAMPLE_RR_MAX
+
+BUILD_ASSERT((HR_RING_SIZE & (HR_RING_SIZE - 1)) == 0, "HR ring size must be a power of two");
+
+// 紧凑心率样本，只保留实际使用的字段
+struct hr_sample {
+    uint32_t timestamp;              // k_uptime_get_32()，单位 ms
+    uint16_t hr;                     // bpm
+    uint8_t rr_count;
+    uint16_t rr[HR_SAMPLE_RR_MAX];   // RR 间期，单位 1/1024 s
+} __packed;
+
+struct hr_ring {
+    atomic_t head;      // 仅生产者写
+    atomic_t tail;      // 仅消费者写
+    atomic_t dropped;
+    struct hr_sample buf[HR_RING_SIZE];
+};
+
+// 生产者：满时丢弃新样本并计数，返回 false
+bool hr_ring_push(struct hr_ring *ring, const struct hr_sample *sample);
+// 消费者：空时返回 false
+bool hr_ring_pop(struct hr_ring *ring, struct hr_sample *sample);
+uint32_t hr_ring_count(const struct hr_ring *ring);
+
+#endif // HR_RING_H
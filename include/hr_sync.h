@@ -0,0 +1,68 @@
+// hr_sync.h -- 心率同步流式分析：双方心率序列的滑动窗口互相关与一致度
+// 纯逻辑，不依赖蓝牙协议栈和内核，全部为整数/定点运算。
+// 每个样本 O(1) 更新：窗口内的和、平方和以及各滞后的乘积和随进出窗口的样本增减，
+// 不重新遍历窗口；整数累加没有舍入漂移，不需要定期重算。
+// 同步带迟滞，只在状态变化时返回事件。心率等级（告警）与同步分开，由调用方对选定的序列判断
+#ifndef HR_SYNC_H
+#define HR_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ring_analytics.h"
+
+#ifdef CONFIG_RING_HR_SYNC_WINDOW
+#define HR_SYNC_WINDOW CONFIG_RING_HR_SYNC_WINDOW
+#else
+#define HR_SYNC_WINDOW 32        // 样本，约 1 Hz
+#endif
+
+#define HR_SYNC_MAX_LAG     4    // 对方相对本端的最大滞后（样本），两个方向
+#define HR_SYNC_LAGS        (2 * HR_SYNC_MAX_LAG + 1)
+#define HR_SYNC_MIN_SAMPLES 8    // 窗口内少于该样本数不判断同步
+#define HR_SYNC_HISTORY     64   // 样本环形缓冲，2 的幂，不小于 WINDOW + 2 * MAX_LAG
+
+#define HR_SYNC_Q15_ONE     (1 << 15)
+// 一致度进入/退出同步的阈值 (Q15)：0.6 / 0.4
+#define HR_SYNC_ENTER_Q15   19661
+#define HR_SYNC_EXIT_Q15    13107
+// 心率等级回到正常需要越过阈值的余量 (bpm)
+#define HR_LEVEL_HYSTERESIS 5
+
+_Static_assert(HR_SYNC_HISTORY >= HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG,
+               "HR sync history too short for the window");
+_Static_assert((HR_SYNC_HISTORY & (HR_SYNC_HISTORY - 1)) == 0,
+               "HR sync history must be a power of two");
+
+// hr_sync_update() 返回的事件位
+#define HR_SYNC_EV_SYNC_ON   (1u << 0)
+#define HR_SYNC_EV_SYNC_OFF  (1u << 1)
+
+struct hr_sync {
+    uint16_t hr[HR_SYNC_HISTORY];        // 本端序列
+    uint16_t partner[HR_SYNC_HISTORY];   // 对方序列
+    uint32_t n;                          // 已收到的成对样本数
+    uint16_t count;                      // 窗口内样本数
+    // 窗口 W = [n-1-L-count+1, n-1-L]，滞后 k 的配对为 hr[i] 与 partner[i+k]
+    int32_t sum;
+    int32_t sum_sq;
+    int32_t p_sum[HR_SYNC_LAGS];
+    int32_t p_sum_sq[HR_SYNC_LAGS];
+    int32_t cross[HR_SYNC_LAGS];
+    // 结果
+    bool synced;
+    int16_t corr;                        // 最佳滞后的相关系数 (Q15)，序列平稳时为 0
+    int8_t lag;                          // 最佳滞后（样本），正值为对方落后
+    uint16_t coherence;                  // 一致度 (Q15)
+    uint16_t mean_diff_x16;              // 窗口内平均心率差 (1/16 bpm)
+};
+
+void hr_sync_init(struct hr_sync *s);
+// 输入一对心率样本：own_hr 为本端，partner_hr 为对方；任一为 0 表示未知，清空窗口。
+// 返回 HR_SYNC_EV_* 位
+uint8_t hr_sync_update(struct hr_sync *s, const struct ring_tunables *t, uint16_t own_hr,
+                       uint16_t partner_hr);
+// 心率等级，带迟滞：越过 HIGH/LOW 阈值进入，回到阈值内 HR_LEVEL_HYSTERESIS 才恢复正常。
+// hr 为 0（未知）时保持原等级
+hr_level_t hr_level_update(hr_level_t level, uint16_t hr);
+
+#endif // HR_SYNC_H
@@ -0,0 +1,55 @@
+// hrv.h -- 心率变异性流式计算：RR 间期滑动窗口上的 RMSSD、SDNN 与压力指数
+// 纯逻辑，不依赖蓝牙协议栈和内核，全部为整数运算，内存固定。
+// 每个 RR 间期 O(1) 更新窗口内的和、平方和与相邻差平方和；压力指数（Baevsky SI）
+// 用 50 ms 直方图计算，每次扫描固定的 HRV_BINS 个桶，因此每拍的开销有上界。
+// 明显的伪差（超出 300..2000 ms 或与上一拍相差超过 20%）不进入窗口
+#ifndef HRV_H
+#define HRV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_RING_HRV_WINDOW
+#define HRV_WINDOW CONFIG_RING_HRV_WINDOW
+#else
+#define HRV_WINDOW 128           // 拍，静息时约 2 分钟
+#endif
+
+#define HRV_RR_MIN_MS    300
+#define HRV_RR_MAX_MS    2000
+#define HRV_BIN_MS       50
+#define HRV_BINS         ((HRV_RR_MAX_MS - HRV_RR_MIN_MS) / HRV_BIN_MS + 1)
+#define HRV_MIN_BEATS    16      // 窗口内少于该拍数时指标为 0
+#define HRV_RESYNC       3       // 连续被拒的拍数达到该值时以新值为基准重新开始
+#define HRV_NO_DIFF      INT16_MIN
+
+_Static_assert(HRV_WINDOW >= HRV_MIN_BEATS && HRV_WINDOW <= 512, "HRV window out of range");
+
+struct hrv {
+    uint16_t rr[HRV_WINDOW];     // ms
+    int16_t diff[HRV_WINDOW];    // 与上一拍的差 (ms)，HRV_NO_DIFF 表示前一拍缺失
+    uint16_t hist[HRV_BINS];
+    uint16_t head;
+    uint16_t count;              // 窗口内拍数
+    uint16_t diff_count;         // 窗口内有效相邻差个数
+    uint16_t ref;                // 上一个接受的 RR (ms)，0 表示没有
+    uint8_t rejected_run;
+    bool chained;                // 下一拍可以与 ref 求差
+    uint32_t sum;
+    uint32_t sum_sq;
+    uint32_t diff_sq;
+    // 结果，每拍更新
+    uint16_t rmssd_ms;
+    uint16_t sdnn_ms;
+    uint16_t stress;             // Baevsky 压力指数，静息约 50..150
+    uint32_t beats;              // 累计接受的拍数
+    uint32_t rejected;           // 累计拒绝的拍数
+};
+
+void hrv_init(struct hrv *h);
+// rr 单位 1/1024 s（HRS 测量的格式）；接受时返回 true
+bool hrv_add_rr(struct hrv *h, uint16_t rr);
+// 数据中断（如链路断开）：下一拍不与之前的拍求差，窗口保留
+void hrv_break(struct hrv *h);
+
+#endif // HRV_H
@@ -0,0 +1,23 @@
+// link_stats.h -- 链路统计服务：在系统工作队列上批量读取连接 RSSI，结果在应用事件循环中发布
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <zephyr/sys/slist.h>
+#include "ring_types.h"
+
+// 距离区域变化监听器，回调在应用事件循环中执行
+struct distance_listener {
+    void (*zone_changed)(struct ring_connection *ring,
+                         distance_level_t old_zone, distance_level_t new_zone);
+    sys_snode_t node;
+};
+
+int link_stats_init(void);
+// 请求对所有活动连接做一次 RSSI 读取，立即返回，结果写回 central_ring/peripheral_ring
+// 之后按当前功耗模式的周期继续轮询，直到没有活动连接
+void link_stats_request_update(void);
+// 新连接/断开时清空滤波器和距离状态机
+void link_stats_reset(struct ring_connection *ring);
+void link_stats_distance_listener_register(struct distance_listener *listener);
+
+#endif // LINK_STATS_H
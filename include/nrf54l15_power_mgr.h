@@ -2,28 +2,40 @@
 #ifndef NRF54L15_POWER_MGR_H
 #define NRF54L15_POWER_MGR_H
 #include "ring_types.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/sys/slist.h>
 
-typedef enum {
-    POWER_MODE_ACTIVE,
-    POWER_MODE_IDLE,
-    POWER_MODE_SLEEP,
-    POWER_MODE_DEEP_SLEEP
-} power_mode_t;
+// 功耗模式变化监听器：模式切换只在系统工作队列中进行，mode_changed 在那里按切换顺序调用；
+// 各 on_*() 事件可在任意线程调用，只更新输入并唤醒判断
+struct power_mode_listener {
+    void (*mode_changed)(power_mode_t old_mode, power_mode_t new_mode);
+    // 可选：每次用户活动时在 on_user_activity() 的调用者上下文中调用（模式未变时也调用），
+    // 应只做轻量处理
+    void (*user_activity)(void);
+    // 可选：电量百分比变化时在 on_battery_level_changed() 的调用者上下文中调用，
+    // 此时 get_battery_level() 已返回新值
+    void (*battery_changed)(uint8_t level);
+    sys_snode_t node;
+};
 
 int init_nrf54l15_power_optimization(void);
-// 主循环周期性调用，有需要时主动唤醒
-void rssi_update_internal(void);
 // 用户活跃定时调用（按钮/远程/数据包/连接建立等）
 void on_user_activity(void);
 // 新连接建立时
 void on_connection_established(struct bt_conn *conn);
 // 连接丢失时
 void on_connection_lost(void);
-// 电池和统计
+// 电池电量变化时（低电量立即进入深睡）
+void on_battery_level_changed(uint8_t level);
+void power_mode_listener_register(struct power_mode_listener *listener);
+// 各模式下的 RSSI 轮询周期，0 表示不轮询
+uint32_t get_rssi_update_interval(power_mode_t mode);
+// 电池和当前模式；各模式时长与能耗见 energy_stats.h
 uint8_t get_battery_level(void);
+// 低电量（超低功耗）状态，带迟滞；重连退避等按电量分档的模块都以此为准
+bool get_battery_low(void);
 power_mode_t get_current_power_mode(void);
-void print_power_statistics(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+// ppg.h -- 本端 PPG 心率采集：传感器 FIFO 达到水位时整批读出，逐批做心搏检测
+// 设备为 devicetree 别名 ppg0（native_sim 上是回放记录的模拟器 ppg_replay.c）。
+// CPU 每批唤醒一次：水位触发只提交工作项，读出（sensor_read）、解码和心搏检测
+// 都在应用事件循环中进行。每批的心率和本批的 RR 间期以 hr_sample 交给回调；
+// DEEP_SLEEP 下传感器停止采样
+#ifndef PPG_H
+#define PPG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hr_ring.h"
+
+struct ppg_stats {
+    uint32_t batches;        // 唤醒次数
+    uint32_t samples;
+    uint32_t beats;
+    uint32_t read_errors;
+    uint16_t batch_max;      // 单批最多样本数
+    uint32_t cycles_max;     // 单批读出、解码和检测的耗时峰值
+    uint16_t rate_hz;
+    uint16_t hr;             // 最近一批的心率，0 表示没有有效心搏
+    bool running;
+};
+
+// 在应用事件循环中调用；hr 变为 0 时也会调用一次（脱落、停止采样）
+typedef void (*ppg_sample_cb_t)(const struct hr_sample *sample);
+
+#if defined(CONFIG_RING_PPG)
+int ppg_init(ppg_sample_cb_t cb);
+void ppg_get_stats(struct ppg_stats *stats);
+#else
+static inline int ppg_init(ppg_sample_cb_t cb) { return 0; }
+#endif
+
+#endif // PPG_H
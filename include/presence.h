@@ -0,0 +1,42 @@
+// presence.h -- 无连接在场广播：周期广播承载心率、按钮、电量和序号
+// 连接时通过 PAST 把本端周期广播的同步信息交给对方，对方断开后仍保持同步。
+// 双方都已同步且功耗模式进入 DEEP_SLEEP 时主动断开连接，由周期广播代替链路，
+// 直到同步丢失或用户活动再重连（见 reconnect.c）
+#ifndef PRESENCE_H
+#define PRESENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+#include "ring_client.h"
+
+#define RING_PRESENCE_VERSION 1
+
+// flags 位
+#define RING_PRESENCE_BUTTON  BIT(0)
+#define RING_PRESENCE_SYNCED  BIT(1)   // 发送方已同步到接收方的周期广播
+
+// 周期广播载荷，放在制造商数据中 RING_ADV_COMPANY_ID 之后
+struct ring_presence_data {
+    uint8_t version;
+    uint8_t seq;          // 内容每变化一次加 1
+    uint16_t hr;          // bpm，0 表示未知
+    uint8_t flags;
+    uint8_t battery;      // %
+} __packed;
+
+#if defined(CONFIG_RING_PRESENCE)
+// cb 与 ring_client 共用，在蓝牙 RX 上下文中调用
+int presence_init(const struct ring_client_cb *cb);
+void presence_set_hr(uint16_t hr);
+void presence_set_button(bool pressed);
+// 双方互相同步，可以不保持连接
+bool presence_linked(void);
+#else
+static inline int presence_init(const struct ring_client_cb *cb) { return 0; }
+static inline void presence_set_hr(uint16_t hr) {}
+static inline void presence_set_button(bool pressed) {}
+static inline bool presence_linked(void) { return false; }
+#endif
+
+#endif // PRESENCE_H
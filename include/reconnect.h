@@ -0,0 +1,33 @@
+// reconnect.h -- 寻找对方戒指：广播、扫描与断线重连
+// 按身份地址选举角色：较小的一端做 central，较大的一端做 peripheral。
+// 意外断线后先快速重连（定向广播 / 接受列表自动建连），之后 central 按功耗模式和
+// 电量档位指数退避地开扫描窗口，peripheral 慢速广播、间隔随退避放慢；用户活动立即重置退避。
+// 双方互相同步了周期广播（presence.h）时断开后不再寻找，直到同步丢失
+#ifndef RECONNECT_H
+#define RECONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct reconnect_stats {
+    uint32_t attempts;     // 快速重连和搜索窗口次数
+    uint32_t reconnects;
+    uint32_t last_ms;      // 最近一次从开始寻找到连上的时间
+    uint32_t max_ms;
+    uint32_t total_ms;
+    uint32_t paused;       // 低电量下次数用尽而暂停的次数
+};
+
+// 在 settings_load() 之后调用，载入绑定对端并配置扫描
+int reconnect_init(void);
+// 启动或没有连接时开始寻找对方；已在进行时不重复开始
+void reconnect_start(void);
+// 连接断开后调用，按断开原因决定是否先快速重连
+void reconnect_link_lost(uint8_t reason);
+// 建立连接后停止所有广播、扫描和自动建连
+void reconnect_stop(void);
+// 退避、暂停或在场同步中立即重新开始寻找（用户活动、在场同步丢失）
+void reconnect_kick(void);
+void reconnect_get_stats(struct reconnect_stats *stats);
+
+#endif // RECONNECT_H
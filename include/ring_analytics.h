@@ -0,0 +1,158 @@
+// ring_analytics.h -- 戒指纯逻辑（距离估算/心率分析/功耗策略），RSSI滤波见 rssi_filter.h
+// 本模块不依赖蓝牙协议栈和内核，可单独在 native_sim 上构建
+// 下面的阈值宏只是默认值，运行时使用 struct ring_tunables（见 ring_tune.h）
+#ifndef RING_ANALYTICS_H
+#define RING_ANALYTICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RSSI_VERY_CLOSE_THRESHOLD  (-35)
+#define RSSI_CLOSE_THRESHOLD       (-55)
+#define RSSI_MEDIUM_THRESHOLD      (-70)
+#define RSSI_FAR_THRESHOLD         (-85)
+#define RSSI_THRESHOLD_COUNT       4
+
+#define HR_SYNC_THRESHOLD 15
+#define HR_HIGH_THRESHOLD 110
+#define HR_LOW_THRESHOLD 50
+
+#define BATTERY_LOW_ENTER_LEVEL      15
+#define BATTERY_LOW_EXIT_LEVEL       25
+#define BATTERY_REDUCED_LEVEL        50
+
+#define IDLE_THRESHOLD_MS            5000
+#define SLEEP_THRESHOLD_MS           30000
+#define DEEP_SLEEP_THRESHOLD_MS      120000
+
+#define RSSI_INTERVAL_ACTIVE         3000
+#define RSSI_INTERVAL_IDLE           8000
+#define RSSI_INTERVAL_SLEEP          20000
+#define RSSI_INTERVAL_DEEP_SLEEP     0
+
+typedef enum {
+    DISTANCE_UNKNOWN,
+    DISTANCE_VERY_CLOSE,
+    DISTANCE_CLOSE,
+    DISTANCE_MEDIUM,
+    DISTANCE_FAR,
+    DISTANCE_VERY_FAR
+} distance_level_t;
+
+typedef enum {
+    POWER_MODE_ACTIVE,
+    POWER_MODE_IDLE,
+    POWER_MODE_SLEEP,
+    POWER_MODE_DEEP_SLEEP
+} power_mode_t;
+
+// 电量档位，用于选择重连退避曲线
+enum battery_band {
+    BATTERY_BAND_NORMAL,
+    BATTERY_BAND_REDUCED,    // 不高于 BATTERY_REDUCED_LEVEL
+    BATTERY_BAND_LOW,        // 低电量迟滞状态
+    BATTERY_BAND_COUNT
+};
+
+// 重连退避曲线：每次搜索窗口后等待 base_ms << 次数，不超过 max_ms
+struct reconnect_profile {
+    uint32_t base_ms;
+    uint32_t max_ms;
+    uint16_t max_attempts;   // 超过后停止搜索直到用户活动，0 表示不限
+};
+
+// 扫描间隔/窗口（0.625 ms 单位），窗口/间隔即接收占空比
+struct scan_profile {
+    uint16_t interval;
+    uint16_t window;
+};
+
+// 退避中慢速广播间隔的上限（0.625 ms 单位）：2 s，加上 advDelay 仍短于 2.1 s 的搜索窗口
+#define ADV_BACKOFF_INTERVAL_MAX 0x0C80
+
+// 慢速广播间隔（0.625 ms 单位）
+struct adv_profile {
+    uint16_t interval_min;
+    uint16_t interval_max;
+};
+
+// 历史记录降采样：心率平均周期、未满块的最长缓存时间、是否记录 RR
+struct history_profile {
+    uint16_t hr_period_s;
+    uint16_t flush_s;
+    uint16_t hrv_s;      // HRV 指标记录周期，0 不记录
+    bool rr;
+};
+
+typedef enum {
+    HR_LEVEL_NORMAL,
+    HR_LEVEL_HIGH,
+    HR_LEVEL_LOW
+} hr_level_t;
+
+// 运行时可调参数
+struct ring_tunables {
+    int8_t rssi_threshold[RSSI_THRESHOLD_COUNT]; // VERY_CLOSE/CLOSE/MEDIUM/FAR 下限 (dBm)，递减
+    uint8_t hr_sync_threshold;                   // 同步的平均心率差尺度 (bpm)，见 hr_sync.h
+    uint32_t power_threshold_ms[3];              // 进入 IDLE/SLEEP/DEEP_SLEEP 的空闲时长，递增
+    uint32_t rssi_interval_ms[4];                // 各功耗模式 RSSI 轮询周期，0 为不轮询
+};
+
+#define RING_TUNABLES_DEFAULT {                                                  \
+    .rssi_threshold = { RSSI_VERY_CLOSE_THRESHOLD, RSSI_CLOSE_THRESHOLD,         \
+                        RSSI_MEDIUM_THRESHOLD, RSSI_FAR_THRESHOLD },             \
+    .hr_sync_threshold = HR_SYNC_THRESHOLD,                                      \
+    .power_threshold_ms = { IDLE_THRESHOLD_MS, SLEEP_THRESHOLD_MS,               \
+                            DEEP_SLEEP_THRESHOLD_MS },                           \
+    .rssi_interval_ms = { RSSI_INTERVAL_ACTIVE, RSSI_INTERVAL_IDLE,              \
+                          RSSI_INTERVAL_SLEEP, RSSI_INTERVAL_DEEP_SLEEP },       \
+}
+
+// 检查阈值顺序，防止 shell/设置写入互相矛盾的参数
+bool ring_tunables_valid(const struct ring_tunables *t);
+
+distance_level_t estimate_distance(const struct ring_tunables *t, int8_t rssi);
+const char *distance_level_str(distance_level_t level);
+
+// 根据空闲时长选择目标功耗模式
+power_mode_t power_policy_target_mode(const struct ring_tunables *t, uint32_t idle_time_ms);
+// 距离下一次空闲阈值跨越还有多少 ms；已处于最深模式时返回 UINT32_MAX
+uint32_t power_policy_next_deadline(const struct ring_tunables *t, uint32_t idle_time_ms);
+
+// 电压(mV) 转电量(%)，按锂聚合物电池放电曲线分段线性插值
+uint8_t battery_soc_from_mv(uint16_t mv);
+// 低电量状态迟滞：低于进入阈值进入，高于退出阈值才退出
+bool battery_low_state(bool low, uint8_t level);
+enum battery_band battery_band_get(bool low, uint8_t level);
+
+const struct reconnect_profile *reconnect_profile_get(power_mode_t mode, enum battery_band band);
+// 第 attempt 次（从 0 开始）搜索失败后的等待时间；超过次数上限返回 UINT32_MAX
+uint32_t reconnect_backoff_ms(const struct reconnect_profile *p, uint32_t attempt);
+
+// 各功耗模式的扫描占空比，越深越低
+const struct scan_profile *scan_profile_get(power_mode_t mode);
+// 扫描 elapsed_ms 期间的接收时长 (ms)
+uint32_t scan_rx_ms(uint16_t interval, uint16_t window, uint32_t elapsed_ms);
+
+// 各功耗模式的慢速广播间隔，均不超过 1 s，保证对方一个搜索窗口内能收到两次
+const struct adv_profile *adv_profile_get(power_mode_t mode);
+// 退避中的慢速广播间隔：第 attempt 次退避时按 2^attempt 放大，不超过 ADV_BACKOFF_INTERVAL_MAX，
+// 对方一个搜索窗口内仍至少能收到一次
+struct adv_profile adv_profile_backoff(const struct adv_profile *p, uint32_t attempt);
+// 单个广播事件的空口时间 (µs)，payload 为 AdvA 之后的字节数（AD 数据或 TargetA）。
+// legacy 在三个主信道各发一次；扩展广播发三次 ADV_EXT_IND 加一次 AUX_ADV_IND
+#define ADV_DELAY_AVG_US 5000   // advDelay（0~10 ms 随机）的平均值，周期广播没有
+uint32_t adv_event_airtime_us(uint8_t payload, bool extended, bool coded);
+// 周期广播一个事件的空口时间 (µs)：次信道上一个 AUX_SYNC_IND，payload 为 AD 数据字节数
+uint32_t per_adv_event_airtime_us(uint8_t payload, bool coded);
+
+// 批量传输（L2CAP CoC）的射频开启时间估算 (µs)：sdu_bytes 为 sdus 个 SDU 的载荷总字节数，
+// mps 为对方的 MPS，ll_octets 为协商后的 LL 载荷上限。每个加密数据包对方回一个空包，
+// 两次 T_IFS 计为开启
+uint32_t bulk_airtime_us(uint32_t sdu_bytes, uint32_t sdus, uint16_t mps, uint16_t ll_octets,
+                         bool phy_2m);
+
+// 各功耗模式的历史记录降采样，越深心率平均周期越长、写闪存越少
+const struct history_profile *history_profile_get(power_mode_t mode);
+
+#endif // RING_ANALYTICS_H
@@ -0,0 +1,36 @@
+// ring_client.h -- 中心端访问对方戒指 HRS/LBS 的 GATT 客户端
+// 已绑定的对端命中发现缓存（Database Hash 一致）时跳过服务发现，订阅为非易失
+#ifndef RING_CLIENT_H
+#define RING_CLIENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+#include "hr_ring.h"
+
+struct ring_client_cb {
+    // 在蓝牙 RX 上下文中调用，只应入队；sample 为 NULL 表示收到无效测量
+    void (*hr_received)(const struct hr_sample *sample);
+    // 对方按钮状态（已去抖）
+    void (*button_changed)(bool pressed);
+};
+
+struct ring_client_stats {
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    // 连接建立到第一条心率通知的时间 (ms)，0 表示尚未测得
+    uint32_t first_notify_hit_ms;
+    uint32_t first_notify_miss_ms;
+    // 最近一次建链发出的 ATT 操作数和退避重试次数
+    uint32_t setup_att_ops;
+    uint32_t setup_retries;
+};
+
+int ring_client_init(const struct ring_client_cb *cb);
+// 中心端连接建立后调用；同一链路重复调用无副作用
+void ring_client_start(struct bt_conn *conn);
+// 写对方 LED；未就绪时返回 -EAGAIN，排队中的写入合并为最新状态
+int ring_client_led_write(bool on);
+void ring_client_get_stats(struct ring_client_stats *stats);
+
+#endif // RING_CLIENT_H
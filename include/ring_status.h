@@ -0,0 +1,65 @@
+// ring_status.h -- 二进制状态快照记录
+// 以 LOG_HEXDUMP_INF(..., "<记录名>") 输出，主机端用 scripts/decode_status.py 解码
+// 修改布局时必须同时递增对应的 *_VERSION 并更新解码脚本
+#ifndef RING_STATUS_H
+#define RING_STATUS_H
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#include <stdint.h>
+
+#define RING_STATUS_VERSION 3
+#define RING_ENERGY_VERSION 3
+
+// flags 位定义
+#define RING_STATUS_CENTRAL_CONN     BIT(0)
+#define RING_STATUS_CENTRAL_HRS      BIT(1)
+#define RING_STATUS_CENTRAL_LBS      BIT(2)
+#define RING_STATUS_PERIPHERAL_CONN  BIT(3)
+#define RING_STATUS_BUTTON           BIT(4)
+#define RING_STATUS_LED_FLASH        BIT(5)
+
+struct ring_status_link {
+    int8_t rssi;         // dBm，已滤波
+    uint8_t distance;    // distance_level_t
+    uint16_t hr;         // bpm，0 表示未知
+    uint16_t conn_s;     // 连接时长 (s)
+} __packed;
+
+struct ring_status_snapshot {
+    uint8_t version;
+    uint32_t uptime_s;
+    uint8_t battery;     // %
+    uint8_t power_mode;  // power_mode_t
+    uint8_t flags;
+    uint8_t led_state;
+    struct ring_status_link central;
+    struct ring_status_link peripheral;
+    uint8_t hr_ring_used;
+    uint16_t hr_dropped;
+    uint16_t hr_rx_errors;
+    uint16_t hr_rx_avg_us;
+    uint16_t hr_rx_max_us;
+    uint16_t loop_stack_used;   // v2：应用事件循环栈高水位 (B)
+    uint16_t hrv_rmssd_ms;      // v3：对方 RR 的 HRV，窗口不足时为 0
+    uint16_t hrv_sdnn_ms;
+    uint16_t hrv_stress;
+} __packed;
+
+// 能耗记录，记录名 "energy"，见 energy_stats.h
+struct ring_energy_record {
+    uint8_t version;
+    uint32_t uptime_s;
+    uint32_t mode_s[4];        // 各 power_mode_t 累计时长
+    uint32_t conn_events[2];   // 中心/外设链路连接事件数（估算）
+    uint32_t hci_cmds;
+    uint32_t led_on_ms;
+    uint32_t uart_bytes;
+    uint32_t charge_uc[7];     // 基础/射频/HCI/LED/UART/扫描/广播 电荷 (µC)，v1 只有前 5 项，v2 前 6 项
+    uint32_t scan_ms;          // v2：扫描开启时长
+    uint32_t scan_rx_ms;       // v2：扫描接收窗口时长
+    uint32_t adv_events;       // v3：广播事件数（估算）
+    uint32_t adv_airtime_ms;   // v3：广播空口时间
+} __packed;
+
+#endif // RING_STATUS_H
@@ -0,0 +1,23 @@
+// ring_tune.h -- 运行时可调参数（RSSI 阈值/心率同步阈值/功耗模式阈值/RSSI 轮询周期）
+// 通过 shell `ring tune` 修改，经 settings 子系统持久化到 "ring/tune"
+#ifndef RING_TUNE_H
+#define RING_TUNE_H
+
+#include <zephyr/sys/slist.h>
+#include "ring_analytics.h"
+
+// 参数变化监听器，回调在修改发生的线程上下文中执行（shell 或 settings_load）
+struct ring_tune_listener {
+    void (*changed)(const struct ring_tunables *t);
+    sys_snode_t node;
+};
+
+// 当前参数，只读；修改必须经 ring_tune_set()
+const struct ring_tunables *ring_tune_get(void);
+// 校验后生效并保存，参数矛盾时返回 -EINVAL
+int ring_tune_set(const struct ring_tunables *t);
+// 恢复编译期默认值并删除已保存的参数
+int ring_tune_reset(void);
+void ring_tune_listener_register(struct ring_tune_listener *listener);
+
+#endif // RING_TUNE_H
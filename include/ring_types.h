@@ -5,23 +5,9 @@
 #include <zephyr/bluetooth/conn.h>
 #include <stdbool.h>
 #include <stdint.h>
-
-#define RSSI_HISTORY_SIZE 5
-
-typedef enum {
-    DISTANCE_UNKNOWN,
-    DISTANCE_VERY_CLOSE,
-    DISTANCE_CLOSE,
-    DISTANCE_MEDIUM,
-    DISTANCE_FAR,
-    DISTANCE_VERY_FAR
-} distance_level_t;
-
-struct rssi_filter {
-    int8_t history[RSSI_HISTORY_SIZE];
-    uint8_t index;
-    bool full;
-};
+#include "ring_analytics.h"
+#include "rssi_filter.h"
+#include "distance_tracker.h"
 
 struct ring_connection {
     struct bt_conn *conn;
@@ -29,7 +15,8 @@ struct ring_connection {
     bool lbs_ready;
     struct rssi_filter rssi_filter;
     int8_t current_rssi;
-    distance_level_t distance;
+    struct distance_tracker distance_tracker;
+    distance_level_t distance;      // 已确认区域，变化通过 link_stats 监听器通知
     uint32_t last_rssi_update;
     uint16_t last_hr_value;
     uint32_t connection_time;
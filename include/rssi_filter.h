@@ -0,0 +1,74 @@
+// rssi_filter.h -- 可插拔 RSSI 滤波引擎（滑动平均/EMA/中值/卡尔曼）
+// 所有模式单次更新为常数时间（窗口长度固定），不做动态分配
+#ifndef RSSI_FILTER_H
+#define RSSI_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_RING_RSSI_FILTER_WINDOW
+#define RSSI_FILTER_WINDOW CONFIG_RING_RSSI_FILTER_WINDOW
+#else
+#define RSSI_FILTER_WINDOW 5
+#endif
+
+#ifdef CONFIG_RING_RSSI_EMA_ALPHA
+#define RSSI_FILTER_EMA_ALPHA CONFIG_RING_RSSI_EMA_ALPHA
+#else
+#define RSSI_FILTER_EMA_ALPHA 64
+#endif
+
+#ifdef CONFIG_RING_RSSI_KALMAN_Q
+#define RSSI_FILTER_KALMAN_Q CONFIG_RING_RSSI_KALMAN_Q
+#else
+#define RSSI_FILTER_KALMAN_Q 128
+#endif
+
+#ifdef CONFIG_RING_RSSI_KALMAN_R
+#define RSSI_FILTER_KALMAN_R CONFIG_RING_RSSI_KALMAN_R
+#else
+#define RSSI_FILTER_KALMAN_R 1024
+#endif
+
+typedef enum {
+    RSSI_FILTER_BOXCAR,   // 滑动平均（累加和）
+    RSSI_FILTER_EMA,      // 指数滑动平均，alpha 为 Q8
+    RSSI_FILTER_MEDIAN,   // 滑动中值
+    RSSI_FILTER_KALMAN    // 一维定点卡尔曼
+} rssi_filter_mode_t;
+
+#if defined(CONFIG_RING_RSSI_FILTER_BOXCAR)
+#define RSSI_FILTER_DEFAULT_MODE RSSI_FILTER_BOXCAR
+#elif defined(CONFIG_RING_RSSI_FILTER_MEDIAN)
+#define RSSI_FILTER_DEFAULT_MODE RSSI_FILTER_MEDIAN
+#elif defined(CONFIG_RING_RSSI_FILTER_KALMAN)
+#define RSSI_FILTER_DEFAULT_MODE RSSI_FILTER_KALMAN
+#else
+#define RSSI_FILTER_DEFAULT_MODE RSSI_FILTER_EMA
+#endif
+
+struct rssi_filter {
+    rssi_filter_mode_t mode;
+    uint8_t count;                      // 窗口内样本数
+    uint8_t index;                      // 下一个写入位置
+    int8_t history[RSSI_FILTER_WINDOW]; // 滑动平均/中值共用的原始样本窗口
+    union {
+        int16_t sum;                        // BOXCAR: 窗口累加和
+        int8_t sorted[RSSI_FILTER_WINDOW];  // MEDIAN: 有序窗口
+        int32_t ema_q8;                     // EMA: 估计值 (dBm, Q8)
+        struct {
+            int32_t x_q8;                   // KALMAN: 估计值 (dBm, Q8)
+            int32_t p_q8;                   // KALMAN: 估计方差 (dB^2, Q8)
+        } kalman;
+    };
+};
+
+void rssi_filter_init(struct rssi_filter *filter, rssi_filter_mode_t mode);
+// 切换模式会清空历史
+void rssi_filter_set_mode(struct rssi_filter *filter, rssi_filter_mode_t mode);
+void rssi_filter_add(struct rssi_filter *filter, int8_t rssi);
+// 没有样本时返回 false，不再返回伪造的默认值
+bool rssi_filter_get(const struct rssi_filter *filter, int8_t *rssi);
+const char *rssi_filter_mode_str(rssi_filter_mode_t mode);
+
+#endif // RSSI_FILTER_H
@@ -0,0 +1,12 @@
+# ring_logic.cmake -- 纯逻辑库，应用和 tests/ 下的测试、基准程序都包含这一份
+zephyr_library_named(ring_logic)
+zephyr_library_sources(
+  ${CMAKE_CURRENT_LIST_DIR}/src/ring_analytics.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/rssi_filter.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/distance_tracker.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/history_codec.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/hr_sync.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/hrv.c
+  ${CMAKE_CURRENT_LIST_DIR}/src/beat_detect.c
+)
+zephyr_library_include_directories(${CMAKE_CURRENT_LIST_DIR}/include)
@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+#
+# Decode binary ring records from the dictionary log.
+#
+# The firmware logs with CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY, so the raw
+# UART stream is first turned into text by Zephyr's dictionary parser:
+#
+#   $ZEPHYR_BASE/scripts/logging/dictionary/log_parser_uart.py \
+#       build/zephyr/log_dictionary.json /dev/ttyACM0 | scripts/decode_status.py
+#
+# Hexdump messages tagged with a known record name ("status", "energy",
+# "history") are
+# reassembled and decoded; every other line is passed through unchanged.
+# A single record can also be decoded directly:
+#
+#   scripts/decode_status.py --record status --hex "01 2a 00 00 00 ..."
+#
+# Record layouts must match the packed structs in include/ring_status.h; the
+# history block format is described in include/history_codec.h.
+# The energy record also prints the average current over its window, which is
+# the figure to compare between two firmware builds.
+
+import argparse
+import re
+import struct
+import sys
+
+POWER_MODES = ["ACTIVE", "IDLE", "SLEEP", "DEEP_SLEEP"]
+DISTANCES = ["Unknown", "Very Close", "Close", "Medium", "Far", "Very Far"]
+LED_STATES = ["OFF", "ON", "FLASHING", "BREATHING"]
+
+STATUS_FLAGS = [
+    (0x01, "central"),
+    (0x02, "hrs"),
+    (0x04, "lbs"),
+    (0x08, "peripheral"),
+    (0x10, "button"),
+    (0x20, "flash"),
+]
+
+
+def _name(table, idx):
+    return table[idx] if 0 <= idx < len(table) else str(idx)
+
+
+def _flags(value, table):
+    return ",".join(name for bit, name in table if value & bit) or "-"
+
+
+def _link(rssi, distance, hr, conn_s):
+    return "rssi %d dBm, %s, hr %d, up %d s" % (
+        rssi, _name(DISTANCES, distance), hr, conn_s)
+
+
+def decode_status(data):
+    # v2 appends the app loop stack high-water mark, v3 the HRV metrics
+    fmt = "<BIBBBB" + "bBHH" * 2 + "BHHHH"
+    if data[0] == 2:
+        fmt += "H"
+    elif data[0] == 3:
+        fmt += "HHHH"
+    elif data[0] != 1:
+        return "status: unsupported version %d" % data[0]
+    f = struct.unpack_from(fmt, data)
+    out = [
+        "status v%d @ %d s" % (f[0], f[1]),
+        "  battery %d%%, power %s, led %s, flags %s" % (
+            f[2], _name(POWER_MODES, f[3]), _name(LED_STATES, f[5]),
+            _flags(f[4], STATUS_FLAGS)),
+    ]
+    if f[4] & 0x01:
+        out.append("  central:    " + _link(*f[6:10]))
+    if f[4] & 0x08:
+        out.append("  peripheral: " + _link(*f[10:14]))
+    out.append("  hr ring %d used, %d dropped, %d rx errors, rx avg %d us max %d us" % f[14:19])
+    if len(f) > 19:
+        out.append("  app loop stack peak %d B" % f[19])
+    if len(f) > 20 and f[20]:
+        out.append("  hrv rmssd %d ms, sdnn %d ms, stress %d" % f[20:23])
+    return "\n".join(out)
+
+
+ENERGY_CATEGORIES = ["base", "radio", "hci", "led", "uart", "scan", "adv"]
+
+
+def _uah(uc):
+    return "%.3f uAh" % (uc / 3600.0)
+
+
+# version -> (charge categories, trailing fields)
+ENERGY_LAYOUTS = {1: (5, 0), 2: (6, 2), 3: (7, 4)}
+
+
+def decode_energy(data):
+    # v2 adds scan charge and scan on/receive time, v3 adv charge, events and airtime
+    if data[0] not in ENERGY_LAYOUTS:
+        return "energy: unsupported version %d" % data[0]
+    ncat, nextra = ENERGY_LAYOUTS[data[0]]
+    fmt = "<BI" + "I" * (9 + ncat + nextra)
+    f = struct.unpack_from(fmt, data)
+    mode_s, events = f[2:6], f[6:8]
+    hci, led_ms, uart = f[8:11]
+    charge = f[11:11 + ncat]
+    extra = f[11 + ncat:]
+    window = sum(mode_s)
+    total = sum(charge)
+    out = [
+        "energy v%d @ %d s, window %d s, total %s, average %d uA" % (
+            f[0], f[1], window, _uah(total), total / window if window else 0),
+        "  " + ", ".join("%s %d s" % (m.lower(), s) for m, s in zip(POWER_MODES, mode_s)),
+        "  conn events central %d, peripheral %d; hci %d, led %d ms, uart %d B" % (
+            events + (hci, led_ms, uart)),
+    ]
+    if nextra >= 2:
+        scan_ms, rx_ms = extra[0:2]
+        out.append("  scan %d ms, rx %d ms, duty %.1f%%" % (
+            scan_ms, rx_ms, 100.0 * rx_ms / scan_ms if scan_ms else 0))
+    if nextra >= 4:
+        out.append("  adv events %d, airtime %d ms" % extra[2:4])
+    out.append("  " + ", ".join("%s %s" % (c, _uah(q)) for c, q in zip(ENERGY_CATEGORIES, charge)))
+    return "\n".join(out)
+
+
+HISTORY_VERSION = 2      # v2 adds HRV records; v1 blocks decode unchanged
+HISTORY_HEADER = "<BBHIIHH"
+TOUCH_FLAGS = [(0x01, "pressed"), (0x02, "remote")]
+
+
+def _varint(data, pos):
+    value, shift = 0, 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7f) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def _zigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def history_records(data):
+    """Yield (time_s, kind, value) for each record in a history block."""
+    version, _, _, _, start_s, count, length = struct.unpack_from(HISTORY_HEADER, data)
+    if not 1 <= version <= HISTORY_VERSION:
+        raise ValueError("unsupported history version %d" % version)
+    body = data[struct.calcsize(HISTORY_HEADER):][:length]
+    pos, t, hr, rr = 0, start_s, 0, 0
+    for _ in range(count):
+        kind, arg = body[pos] & 0x0f, body[pos] >> 4
+        dt, pos = _varint(body, pos + 1)
+        t += dt
+        if kind == 1:
+            delta, pos = _varint(body, pos)
+            hr += _zigzag(delta)
+            yield t, "hr", hr
+        elif kind == 2:
+            values = []
+            for _ in range(arg):
+                delta, pos = _varint(body, pos)
+                rr += _zigzag(delta)
+                values.append(rr)
+            yield t, "rr", values
+        elif kind == 3:
+            yield t, "zone", arg
+        elif kind == 4:
+            yield t, "touch", arg
+        elif kind == 5 and version >= 2:
+            rmssd, pos = _varint(body, pos)
+            sdnn, pos = _varint(body, pos)
+            stress, pos = _varint(body, pos)
+            yield t, "hrv", (rmssd, sdnn, stress)
+        else:
+            raise ValueError("unknown history record type %d" % kind)
+
+
+def decode_history(data):
+    if not 1 <= data[0] <= HISTORY_VERSION:
+        return "history: unsupported version %d" % data[0]
+    _, _, boot, seq, start_s, count, length = struct.unpack_from(HISTORY_HEADER, data)
+    out = ["history v%d block %d, boot %d @ %d s, %d records, %d B" % (
+        data[0], seq, boot, start_s, count, length)]
+    for t, kind, value in history_records(data):
+        if kind == "hr":
+            text = "hr %d bpm" % value
+        elif kind == "rr":
+            text = "rr " + " ".join("%d ms" % (v * 1000 // 1024) for v in value)
+        elif kind == "zone":
+            text = "zone %s" % _name(DISTANCES, value)
+        elif kind == "hrv":
+            text = "hrv rmssd %d ms, sdnn %d ms, stress %d" % value
+        else:
+            text = "touch %s" % _flags(value, TOUCH_FLAGS)
+        out.append("  %6d s  %s" % (t, text))
+    return "\n".join(out)
+
+
+RECORDS = {
+    "status": decode_status,
+    "energy": decode_energy,
+    "history": decode_history,
+}
+
+HEX_LINE = re.compile(r"^\s+([0-9a-fA-F]{2}(?:\s{1,2}[0-9a-fA-F]{2})*)\s*(?:\|.*)?$")
+TAG_LINE = re.compile(r"\b(%s)\s*$" % "|".join(RECORDS))
+
+
+def decode(name, data):
+    try:
+        return RECORDS[name](bytes(data))
+    except (struct.error, IndexError, ValueError) as e:
+        return "%s: malformed record (%s)" % (name, e)
+
+
+def filter_stream(lines):
+    pending, data = None, bytearray()
+    for line in lines:
+        line = line.rstrip("\n")
+        if pending:
+            m = HEX_LINE.match(line)
+            if m:
+                data += bytes.fromhex("".join(m.group(1).split()))
+                continue
+            print(decode(pending, data))
+            pending, data = None, bytearray()
+        m = TAG_LINE.search(line)
+        if m:
+            pending = m.group(1)
+            continue
+        print(line)
+    if pending:
+        print(decode(pending, data))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--record", choices=sorted(RECORDS), default="status")
+    parser.add_argument("--hex", help="decode a single record given as hex bytes")
+    args = parser.parse_args()
+    if args.hex:
+        print(decode(args.record, bytes.fromhex(args.hex.replace(" ", ""))))
+    else:
+        filter_stream(sys.stdin)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+#
+# Estimate the flash cost of the history store (src/history.c).
+#
+# A synthetic day is fed through a model of the firmware path: HR samples are
+# averaged per power mode, RR intervals are kept only in ACTIVE, HRV metrics
+# are sampled at the mode's HRV period, zone changes
+# and touches are recorded as they happen, and blocks are written when full or
+# when the mode's flush period expires. The encoder mirrors
+# src/history_codec.c and every block is decoded back with decode_status.py
+# to check the round trip.
+#
+#   scripts/history_bench.py
+#   scripts/history_bench.py --partition-kib 36 --block 496 --day ACTIVE=2,IDLE=6
+#
+# The per-mode table must match history_profile_get() in src/ring_analytics.c.
+
+import argparse
+import os
+import random
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import decode_status  # noqa: E402
+
+MODES = decode_status.POWER_MODES
+# mode -> (hr_period_s, flush_s, hrv_s, rr)
+PROFILES = {
+    "ACTIVE": (10, 300, 60, True),
+    "IDLE": (60, 300, 300, False),
+    "SLEEP": (300, 900, 900, False),
+    "DEEP_SLEEP": (900, 3600, 0, False),
+}
+# events per hour in each mode: (zone changes, touches)
+EVENTS = {
+    "ACTIVE": (20, 30),
+    "IDLE": (6, 2),
+    "SLEEP": (1, 0),
+    "DEEP_SLEEP": (0, 0),
+}
+DEFAULT_DAY = {"ACTIVE": 2, "IDLE": 6, "SLEEP": 8, "DEEP_SLEEP": 8}
+HEADER_SIZE = 16
+ENTRY_OVERHEAD = 16   # settings backend allocation table entry (ZMS)
+
+
+def _varint(v):
+    out = bytearray()
+    while True:
+        b = v & 0x7f
+        v >>= 7
+        out.append(b | (0x80 if v else 0))
+        if not v:
+            return bytes(out)
+
+
+def _zigzag(v):
+    return v << 1 if v >= 0 else (-v << 1) - 1
+
+
+class Encoder:
+    def __init__(self, size, start_s):
+        self.size, self.start_s, self.last_s = size, start_s, start_s
+        self.body, self.count, self.hr, self.rr = bytearray(), 0, 0, 0
+
+    def _put(self, kind, arg, t, payload):
+        rec = bytes([kind | (arg << 4)]) + _varint(max(t - self.last_s, 0)) + payload
+        if len(self.body) + len(rec) > self.size:
+            return False
+        self.body += rec
+        self.count += 1
+        self.last_s = max(self.last_s, t)
+        return True
+
+    def hr_record(self, t, hr):
+        if not self._put(1, 0, t, _varint(_zigzag(hr - self.hr))):
+            return False
+        self.hr = hr
+        return True
+
+    def rr_record(self, t, values):
+        payload, last = b"", self.rr
+        for v in values:
+            payload += _varint(_zigzag(v - last))
+            last = v
+        if not self._put(2, len(values), t, payload):
+            return False
+        self.rr = last
+        return True
+
+    def hrv_record(self, t, values):
+        return self._put(5, 0, t, b"".join(_varint(v) for v in values))
+
+    def event(self, t, kind, arg):
+        return self._put(kind, arg, t, b"")
+
+    def block(self, seq):
+        return struct.pack(decode_status.HISTORY_HEADER, decode_status.HISTORY_VERSION, 0, 1,
+                           seq, self.start_s, self.count, len(self.body)) + self.body
+
+
+class Store:
+    def __init__(self, block_size):
+        self.block_size = block_size
+        self.blocks = []
+        self.enc, self.deadline = None, None
+
+    def _flush(self):
+        if self.enc and self.enc.count:
+            self.blocks.append(self.enc.block(len(self.blocks) + 1))
+        self.enc, self.deadline = None, None
+
+    def put(self, t, flush_s, fn, *args):
+        if self.enc is None:
+            self.enc = Encoder(self.block_size, t)
+        if not getattr(self.enc, fn)(t, *args):
+            self._flush()
+            self.enc = Encoder(self.block_size, t)
+            getattr(self.enc, fn)(t, *args)
+        if self.deadline is None:
+            self.deadline = t + flush_s
+
+    def tick(self, t):
+        if self.deadline is not None and t >= self.deadline:
+            self._flush()
+
+
+def simulate(day, block_size, seed):
+    rng = random.Random(seed)
+    store = Store(block_size)
+    expected, per_mode = [], {}
+    t, hr = 0, 70
+    acc, start, last = [], None, None
+    zone, pressed = 2, False
+    hrv_last = None
+    for mode in MODES:
+        hours = day.get(mode, 0)
+        if not hours:
+            continue
+        period, flush_s, hrv_s, keep_rr = PROFILES[mode]
+        zones, touches = EVENTS[mode]
+        first = len(store.blocks)
+        for _ in range(int(hours * 3600)):
+            hr = min(max(hr + rng.choice((-1, 0, 0, 1)), 45), 160)
+            if acc and t - start >= period:
+                avg = (sum(acc) + len(acc) // 2) // len(acc)
+                store.put(last, flush_s, "hr_record", avg)
+                expected.append((last, "hr", avg))
+                acc = []
+            if not acc:
+                start = t
+            acc.append(hr)
+            last = t
+            if keep_rr:
+                rr = [61440 // hr + rng.randint(-8, 8) for _ in range(rng.choice((1, 1, 2)))]
+                store.put(t, flush_s, "rr_record", rr)
+                expected.append((t, "rr", rr))
+            if hrv_s and (hrv_last is None or t - hrv_last >= hrv_s):
+                hrv = (rng.randint(20, 80), rng.randint(30, 90), rng.randint(40, 300))
+                store.put(t, flush_s, "hrv_record", hrv)
+                expected.append((t, "hrv", hrv))
+                hrv_last = t
+            if rng.random() < zones / 3600:
+                zone = 2 if zone == 1 else 4 if zone == 5 else zone + rng.choice((-1, 1))
+                store.put(t, flush_s, "event", 3, zone)
+                expected.append((t, "zone", zone))
+            if rng.random() < touches / 3600 or pressed:
+                pressed = not pressed
+                store.put(t, flush_s, "event", 4, 1 if pressed else 0)
+                expected.append((t, "touch", 1 if pressed else 0))
+            store.tick(t)
+            t += 1
+        # blocks are charged to the mode in which they are written
+        blocks = store.blocks[first:]
+        per_mode[mode] = (hours, len(blocks), sum(len(b) for b in blocks))
+    store._flush()
+    decoded = [r for b in store.blocks for r in decode_status.history_records(b)]
+    if decoded != expected:
+        raise SystemExit("round trip mismatch after %d records" % len(decoded))
+    return store.blocks, per_mode
+
+
+def parse_day(text):
+    day = dict.fromkeys(MODES, 0)
+    for item in text.split(","):
+        mode, hours = item.split("=")
+        if mode not in day:
+            raise argparse.ArgumentTypeError("unknown mode %s" % mode)
+        day[mode] = float(hours)
+    return day
+
+
+def main():
+    parser = argparse.ArgumentParser(description="History store flash cost per day")
+    parser.add_argument("--block", type=int, default=496, help="CONFIG_RING_HISTORY_BLOCK_SIZE")
+    parser.add_argument("--partition-kib", type=int, default=36, help="settings partition size")
+    parser.add_argument("--day", type=parse_day, default=DEFAULT_DAY,
+                        help="hours per mode, e.g. ACTIVE=2,IDLE=6,SLEEP=8,DEEP_SLEEP=8")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    blocks, per_mode = simulate(args.day, args.block, args.seed)
+    print("%-10s %6s %8s %10s %8s" % ("mode", "hours", "writes/h", "bytes/h", "fill"))
+    for mode, (hours, n, size) in per_mode.items():
+        written = size + n * ENTRY_OVERHEAD
+        print("%-10s %6g %8.1f %10.0f %7.0f%%" % (
+            mode, hours, n / hours, written / hours,
+            100.0 * (size - n * HEADER_SIZE) / (n * args.block) if n else 0))
+    total = sum(len(b) for b in blocks) + len(blocks) * ENTRY_OVERHEAD
+    hours = sum(args.day.values())
+    per_day = total * 24 / hours
+    print("total %d blocks, %d B over %g h, %.0f B/day" % (len(blocks), total, hours, per_day))
+    print("erase cycles/day on a %d KiB partition: %.3f (%.0f years to 10k cycles)" % (
+        args.partition_kib, per_day / (args.partition_kib * 1024),
+        10000 / (per_day / (args.partition_kib * 1024)) / 365 if per_day else 0))
+
+
+if __name__ == "__main__":
+    main()
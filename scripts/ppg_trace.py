@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# PPG traces for the native_sim sensor emulator (src/ppg_replay.c).
+#
+# A trace is an 8-byte header followed by the samples:
+#   "PPGT", u16 sample rate (Hz), u16 reserved (0)
+#   little-endian int16 per sample, systole upwards
+# CONFIG_RING_PPG_REPLAY_TRACE selects the trace that is built into the
+# emulator. The emulator replays it in a loop.
+#
+#   scripts/ppg_trace.py synth traces/ppg_synthetic_50hz.bin
+#   scripts/ppg_trace.py convert recording.csv out.bin --rate 125 --column 1 --invert
+#   scripts/ppg_trace.py check
+#   scripts/ppg_trace.py check --trace out.bin
+#
+# "synth" writes a synthetic trace: the HR steps from rest through exercise
+# back to rest, with respiratory sinus arrhythmia, baseline wander and noise.
+# "convert" turns one CSV column of a recording into a trace. The column is
+# resampled when --resample is given. "check" builds src/beat_detect.c for the
+# host and runs a trace through it. For the synthetic trace it also matches
+# the detected beats against the known ones.
+
+import argparse
+import csv
+import math
+import os
+import random
+import shutil
+import struct
+import subprocess
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MAGIC = b"PPGT"
+HEADER = "<4sHH"
+
+DRIVER = r"""
+#include <stdio.h>
+#include "beat_detect.h"
+
+static struct beat_detect bd;
+
+int main(int argc, char **argv) {
+    unsigned rate;
+    int x;
+    uint16_t rr[8];
+    uint32_t beats = 0;
+
+    if (scanf("%u", &rate) != 1)
+        return 1;
+    beat_detect_init(&bd, (uint16_t)rate);
+    while (scanf("%d", &x) == 1) {
+        int32_t v = x;
+        uint8_t n = beat_detect_run(&bd, &v, 1, rr, 8);
+        if (bd.beats != beats) {
+            beats = bd.beats;
+            printf("%u %u %u\n", bd.last_beat, n ? rr[0] : 0, bd.hr);
+        }
+    }
+    return 0;
+}
+"""
+
+
+def write_trace(path, rate, samples):
+    with open(path, "wb") as f:
+        f.write(struct.pack(HEADER, MAGIC, rate, 0))
+        f.write(struct.pack("<%dh" % len(samples), *samples))
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, rate, _ = struct.unpack_from(HEADER, data)
+    if magic != MAGIC:
+        raise SystemExit("%s: not a PPG trace" % path)
+    body = data[struct.calcsize(HEADER):]
+    return rate, list(struct.unpack("<%dh" % (len(body) // 2), body))
+
+
+def synth(rate, seconds, seed):
+    """Return (samples, beat times in s)."""
+    rng = random.Random(seed)
+    # (until s, bpm): rest, walking, running, recovery
+    plan = [(seconds * 0.3, 62), (seconds * 0.5, 95), (seconds * 0.75, 140), (seconds, 70)]
+    beats, t, bpm = [], 0.5, 62.0
+    while t < seconds:
+        target = next(b for until, b in plan if t < until)
+        bpm += (target - bpm) * 0.08
+        rsa = 0.04 * math.sin(2 * math.pi * 0.25 * t)
+        rr = 60.0 / bpm * (1 + rsa) + rng.gauss(0, 0.012)
+        beats.append(t)
+        t += rr
+    out, k = [], 0
+    for i in range(int(seconds * rate)):
+        t = i / rate
+        while k + 1 < len(beats) and beats[k + 1] <= t:
+            k += 1
+        v = 0.0
+        for b in beats[max(k - 1, 0):k + 1]:
+            tau = t - b
+            if tau >= 0:
+                v += math.exp(-((tau - 0.12) / 0.06) ** 2)
+                v += 0.35 * math.exp(-((tau - 0.38) / 0.07) ** 2)
+        v += 0.3 * math.sin(2 * math.pi * 0.25 * t) + rng.gauss(0, 0.03)
+        out.append(int(round(12000 + 2000 * v)))
+    return out, beats
+
+
+def convert(args):
+    with open(args.csv, newline="") as f:
+        rows = [r for r in csv.reader(f) if r]
+    values = []
+    for row in rows:
+        try:
+            values.append(float(row[args.column]))
+        except (ValueError, IndexError):
+            continue           # header or short line
+    rate = args.rate
+    if args.resample and args.resample != rate:
+        n = int(len(values) * args.resample / rate)
+        values = [values[min(int(i * rate / args.resample), len(values) - 1)] for i in range(n)]
+        rate = args.resample
+    if args.invert:
+        values = [-v for v in values]
+    lo, hi = min(values), max(values)
+    scale = 30000.0 / (hi - lo) if hi > lo else 1.0
+    samples = [int(round((v - lo) * scale - 15000)) for v in values]
+    write_trace(args.out, rate, samples)
+    print("%s: %d samples at %d Hz (%.0f s)" % (args.out, len(samples), rate, len(samples) / rate))
+
+
+def run_detector(cc, rate, samples):
+    workdir = tempfile.mkdtemp(prefix="ppg_trace")
+    try:
+        driver = os.path.join(workdir, "driver.c")
+        exe = os.path.join(workdir, "beat_detect")
+        with open(driver, "w") as f:
+            f.write(DRIVER)
+        subprocess.run([cc, "-O2", "-std=c11", "-Wall", "-I", os.path.join(ROOT, "include"),
+                        driver, os.path.join(ROOT, "src", "beat_detect.c"), "-o", exe],
+                       check=True)
+        out = subprocess.run([exe], input="%d\n" % rate + "\n".join(map(str, samples)) + "\n",
+                             capture_output=True, text=True, check=True).stdout
+    finally:
+        shutil.rmtree(workdir)
+    return [tuple(map(int, line.split())) for line in out.splitlines()]
+
+
+def check(args):
+    if args.trace:
+        rate, samples = read_trace(args.trace)
+        truth = None
+    else:
+        rate = args.rate
+        samples, truth = synth(rate, args.seconds, args.seed)
+    detected = run_detector(args.cc, rate, samples)
+    times = [d[0] / 1024.0 for d in detected]
+    rrs = [d[1] for d in detected if d[1]]
+    print("%d samples at %d Hz, %d beats detected, %d RR intervals" % (
+        len(samples), rate, len(detected), len(rrs)))
+    step = max(1, len(detected) // 10)
+    for t, (_, _, hr) in list(zip(times, detected))[::step]:
+        print("  %7.1f s  hr %d" % (t, hr))
+    if truth is None:
+        return
+    # detections sit a fixed time after the pulse start; align on the median
+    truth = [b for b in truth if b >= 2.0]      # learning phase
+    offsets = sorted(min((t - b for b in truth), key=abs) for t in times)
+    offset = offsets[len(offsets) // 2]
+    matched, errors, used = 0, [], set()
+    for t in times:
+        j = min(range(len(truth)), key=lambda k: abs(t - offset - truth[k]))
+        if abs(t - offset - truth[j]) < 0.1 and j not in used:
+            used.add(j)
+            matched += 1
+            errors.append(abs(t - offset - truth[j]) * 1000)
+    sens = 100.0 * matched / len(truth)
+    ppv = 100.0 * matched / len(times) if times else 0
+    print("vs %d true beats: sensitivity %.1f%%, PPV %.1f%%, timing error mean %.1f ms, max %.1f ms" % (
+        len(truth), sens, ppv, sum(errors) / len(errors) if errors else 0, max(errors or [0])))
+    if sens < args.min_sensitivity or ppv < args.min_sensitivity:
+        raise SystemExit("below %.0f%%" % args.min_sensitivity)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PPG traces for the sensor emulator")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("synth", help="write a synthetic trace")
+    p.add_argument("out")
+    p.add_argument("--rate", type=int, default=50)
+    p.add_argument("--seconds", type=int, default=120)
+    p.add_argument("--seed", type=int, default=1)
+    p = sub.add_parser("convert", help="convert a CSV recording")
+    p.add_argument("csv")
+    p.add_argument("out")
+    p.add_argument("--rate", type=int, required=True, help="sample rate of the recording")
+    p.add_argument("--column", type=int, default=0)
+    p.add_argument("--resample", type=int, help="target rate, e.g. 50")
+    p.add_argument("--invert", action="store_true", help="raw reflective PPG (systole down)")
+    p = sub.add_parser("check", help="run src/beat_detect.c over a trace")
+    p.add_argument("--trace", help="trace file; default is a fresh synthetic trace")
+    p.add_argument("--rate", type=int, default=50)
+    p.add_argument("--seconds", type=int, default=120)
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("--min-sensitivity", type=float, default=98.0)
+    p.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    args = parser.parse_args()
+
+    if args.cmd == "synth":
+        samples, beats = synth(args.rate, args.seconds, args.seed)
+        write_trace(args.out, args.rate, samples)
+        print("%s: %d samples at %d Hz, %d beats" % (args.out, len(samples), args.rate, len(beats)))
+    elif args.cmd == "convert":
+        convert(args)
+    else:
+        check(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# RSSI captures for the ring_logic bench (tests/ring_logic_bench).
+#
+# A capture is a C include file: a comment header naming the source, then one
+# int8 RSSI value (dBm) per poll, comma separated. The bench replays every
+# capture listed in tests/ring_logic_bench/src/captures.h through each filter
+# mode and the distance tracker and prints zone changes and flaps.
+#
+#   scripts/rssi_capture.py convert ring.log tests/ring_logic_bench/captures/desk.inc
+#   scripts/rssi_capture.py convert sniffer.csv out.inc --csv --time-column 1 --rssi-column 5
+#
+# Log input is the text log of a build with link statistics at debug level:
+#   west build -b nrf54l15dk/nrf54l15/cpuapp -- -DCONFIG_RING_LOG_LEVEL_DBG=y
+# decoded with Zephyr's scripts/logging/dictionary/log_parser.py. Every
+# "Hardware RSSI: <n> dBm" line is one HCI read; "Using estimated RSSI" lines
+# (no hardware value) are skipped. CSV input, e.g. a sniffer export, takes the
+# time in seconds from one column and the RSSI from another.
+# Readings are resampled to the ACTIVE poll interval: each slot keeps the last
+# reading at or before its end, like the HCI command that returns the RSSI of
+# the last received packet. Slots without a reading repeat the previous value.
+
+import argparse
+import csv
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+LOG_LINE = re.compile(r"\[(\d+):(\d+):(\d+)\.(\d+),(\d+)\].*Hardware RSSI: (-?\d+) dBm")
+PER_LINE = 16
+
+
+def active_interval_ms():
+    with open(os.path.join(ROOT, "include", "ring_analytics.h")) as f:
+        m = re.search(r"#define RSSI_INTERVAL_ACTIVE\s+(\d+)", f.read())
+    return int(m.group(1))
+
+
+def read_log(path):
+    """Return [(time in ms, rssi)]."""
+    out = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = LOG_LINE.search(line)
+            if not m:
+                continue
+            h, mi, s, ms, us, rssi = (int(g) for g in m.groups())
+            out.append((((h * 60 + mi) * 60 + s) * 1000 + ms + us / 1000.0, rssi))
+    return out
+
+
+def read_csv(path, time_column, rssi_column):
+    out = []
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            try:
+                out.append((float(row[time_column]) * 1000.0, int(round(float(row[rssi_column])))))
+            except (ValueError, IndexError):
+                continue    # header or short row
+    return out
+
+
+def resample(readings, interval):
+    readings.sort()
+    start = readings[0][0]
+    out, i, last = [], 0, readings[0][1]
+    end = start + interval
+    while i < len(readings):
+        while i < len(readings) and readings[i][0] < end:
+            last = readings[i][1]
+            i += 1
+        out.append(max(-127, min(20, last)))
+        end += interval
+    return out
+
+
+def write_capture(path, samples, interval, source, note):
+    name = os.path.splitext(os.path.basename(path))[0]
+    with open(path, "w") as f:
+        f.write("/* RSSI capture \"%s\": %d samples, %d ms per sample\n" % (name, len(samples), interval))
+        f.write(" * source: %s\n" % source)
+        if note:
+            f.write(" * %s\n" % note)
+        f.write(" * generated by scripts/rssi_capture.py, do not edit\n */\n")
+        for i in range(0, len(samples), PER_LINE):
+            f.write(" ".join("%d," % v for v in samples[i:i + PER_LINE]) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RSSI captures for the ring_logic bench")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("convert", help="convert a ring log or CSV into a capture")
+    p.add_argument("input")
+    p.add_argument("out")
+    p.add_argument("--csv", action="store_true", help="input is CSV, not a ring log")
+    p.add_argument("--time-column", type=int, default=0, help="CSV column with the time in s")
+    p.add_argument("--rssi-column", type=int, default=1)
+    p.add_argument("--interval", type=int, help="ms per sample; default RSSI_INTERVAL_ACTIVE")
+    p.add_argument("--note", help="extra line for the header, e.g. the setup")
+    args = parser.parse_args()
+
+    interval = args.interval or active_interval_ms()
+    if args.csv:
+        readings = read_csv(args.input, args.time_column, args.rssi_column)
+    else:
+        readings = read_log(args.input)
+    if not readings:
+        raise SystemExit("%s: no RSSI readings" % args.input)
+    samples = resample(readings, interval)
+    write_capture(args.out, samples, interval, os.path.basename(args.input), args.note)
+    print("%s: %d readings -> %d samples at %d ms, %d..%d dBm" %
+          (args.out, len(readings), len(samples), interval, min(samples), max(samples)))
+
+
+if __name__ == "__main__":
+    main()
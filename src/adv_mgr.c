@@ -0,0 +1,256 @@
+// adv_mgr.c -- 广播管理
+// 启停与参数切换都在系统工作队列中进行（reconnect 的工作项和本模块的降速工作项），
+// 功耗模式监听器和退避次数变化只唤醒降速工作项。定向广播的 PDU 不能带数据，切到定向前先清空载荷。
+// 高占空比定向只能用 legacy PDU；CONFIG_RING_ADV_EXT 时其余模式使用扩展广播 PDU
+#include "adv_mgr.h"
+#include "energy_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+LOG_MODULE_REGISTER(ring_adv, CONFIG_RING_LOG_LEVEL);
+
+#define ADV_BURST_MS            3000
+#define ADV_BURST_INT_MIN       0x0030  // 30 ms
+#define ADV_BURST_INT_MAX       0x0060  // 60 ms
+#define ADV_HIGH_DUTY_PERIOD_US 3750    // 高占空比定向：3.75 ms 内三个信道各发一次
+#define ADV_DIRECT_PAYLOAD      6       // ADV_DIRECT_IND 的 TargetA
+
+static const struct bt_data ad[] = {
+    BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+    // 首选连接间隔，与 GAP PPCP 一致，对端按此建连无需再做参数更新
+    BT_DATA_BYTES(BT_DATA_PERIPHERAL_INT_RANGE,
+        BT_BYTES_LIST_LE16(CONFIG_BT_PERIPHERAL_PREF_MIN_INT),
+        BT_BYTES_LIST_LE16(CONFIG_BT_PERIPHERAL_PREF_MAX_INT)),
+    BT_DATA_BYTES(BT_DATA_MANUFACTURER_DATA, RING_ADV_ID_BYTES),
+};
+
+static const char * const mode_names[] = { "off", "directed", "directed low duty", "beacon" };
+
+static struct k_work_delayable adv_step_work;
+static atomic_t adv_live;           // 控制器正在广播；连接或超时后由回调清零
+
+static struct {
+    struct bt_le_ext_adv *set;
+    enum adv_mgr_mode mode;
+    bool has_peer;
+    bt_addr_le_t peer;
+    bool has_data;                  // 广播集中是否有载荷
+    bool fast;                      // 慢速广播的快速阶段
+    uint32_t backoff;               // 慢速广播的退避次数（reconnect 设置）
+    uint16_t interval_min;
+    uint16_t interval_max;
+    uint8_t ad_len;
+    uint32_t event_us;              // 当前单次广播事件空口时间
+} adv;
+
+static bool adv_directed(void) {
+    return adv.mode != ADV_MGR_BEACON || adv.has_peer;
+}
+
+static bool adv_extended(void) {
+    return IS_ENABLED(CONFIG_RING_ADV_EXT) && adv.mode != ADV_MGR_DIRECTED_HIGH;
+}
+
+// 停止后按当前模式重设参数与载荷并重新开始
+static int adv_apply(uint16_t interval_min, uint16_t interval_max) {
+    struct bt_le_adv_param param =
+        BT_LE_ADV_PARAM_INIT(BT_LE_ADV_OPT_CONN, interval_min, interval_max, NULL);
+    bool directed = adv_directed();
+    uint32_t period_us;
+    int err;
+
+    bt_le_ext_adv_stop(adv.set);
+    atomic_clear(&adv_live);
+    energy_stats_adv(ENERGY_ADV_LINK, 0, 0);
+
+    if (directed) {
+        param.peer = &adv.peer;
+        if (adv.mode != ADV_MGR_DIRECTED_HIGH)
+            param.options |= BT_LE_ADV_OPT_DIR_MODE_LOW_DUTY;
+    }
+    if (adv_extended()) {
+        param.options |= BT_LE_ADV_OPT_EXT_ADV;
+        if (IS_ENABLED(CONFIG_RING_ADV_CODED))
+            param.options |= BT_LE_ADV_OPT_CODED;
+    }
+    if (directed && adv.has_data) {
+        err = bt_le_ext_adv_set_data(adv.set, NULL, 0, NULL, 0);
+        if (err) return err;
+        adv.has_data = false;
+    }
+    err = bt_le_ext_adv_update_param(adv.set, &param);
+    if (err) return err;
+    if (!directed && !adv.has_data) {
+        err = bt_le_ext_adv_set_data(adv.set, ad, ARRAY_SIZE(ad), NULL, 0);
+        if (err) return err;
+        adv.has_data = true;
+    }
+    err = bt_le_ext_adv_start(adv.set, BT_LE_EXT_ADV_START_DEFAULT);
+    if (err) return err;
+
+    atomic_set(&adv_live, 1);
+    adv.interval_min = interval_min;
+    adv.interval_max = interval_max;
+    adv.event_us = adv_event_airtime_us(directed ? ADV_DIRECT_PAYLOAD : adv.ad_len, adv_extended(),
+                                        adv_extended() && IS_ENABLED(CONFIG_RING_ADV_CODED));
+    if (adv.mode == ADV_MGR_DIRECTED_HIGH)
+        period_us = ADV_HIGH_DUTY_PERIOD_US;
+    else
+        period_us = (interval_min + interval_max) / 2 * 625U + ADV_DELAY_AVG_US;
+    energy_stats_adv(ENERGY_ADV_LINK, period_us, adv.event_us);
+    LOG_DBG("Advertising %s, %u-%u", mode_names[adv.mode], interval_min, interval_max);
+    return 0;
+}
+
+// 当前功耗模式和退避次数下的慢速间隔
+static struct adv_profile adv_beacon_profile(void) {
+    return adv_profile_backoff(adv_profile_get(get_current_power_mode()), adv.backoff);
+}
+
+static int adv_apply_beacon(void) {
+    struct adv_profile p = adv_beacon_profile();
+    if (adv.fast)
+        return adv_apply(ADV_BURST_INT_MIN, ADV_BURST_INT_MAX);
+    return adv_apply(p.interval_min, p.interval_max);
+}
+
+// 快速阶段结束、功耗模式或退避次数变化时切到当前的慢速间隔
+static void adv_step_work_handler(struct k_work *work) {
+    struct adv_profile p = adv_beacon_profile();
+    int err;
+
+    if (adv.mode != ADV_MGR_BEACON || !atomic_get(&adv_live))
+        return;
+    adv.fast = false;
+    if (p.interval_min == adv.interval_min && p.interval_max == adv.interval_max)
+        return;
+    err = adv_apply(p.interval_min, p.interval_max);
+    if (err) LOG_WRN("Advertising step down failed: %d", err);
+}
+
+int adv_mgr_start(enum adv_mgr_mode mode, const bt_addr_le_t *peer, bool burst) {
+    int err;
+
+    k_work_cancel_delayable(&adv_step_work);
+    adv.mode = mode;
+    adv.has_peer = peer != NULL;
+    if (peer)
+        bt_addr_le_copy(&adv.peer, peer);
+    adv.fast = burst && mode == ADV_MGR_BEACON;
+
+    switch (mode) {
+    case ADV_MGR_DIRECTED_HIGH:
+        err = adv_apply(0, 0);
+        break;
+    case ADV_MGR_DIRECTED_LOW:
+        err = adv_apply(BT_GAP_ADV_FAST_INT_MIN_2, BT_GAP_ADV_FAST_INT_MAX_2);
+        break;
+    case ADV_MGR_BEACON:
+        err = adv_apply_beacon();
+        break;
+    default:
+        adv_mgr_stop();
+        return 0;
+    }
+    if (err) {
+        LOG_WRN("Advertising start failed: %d", err);
+        adv.mode = ADV_MGR_OFF;
+        return err;
+    }
+    if (adv.fast)
+        k_work_schedule(&adv_step_work, K_MSEC(ADV_BURST_MS));
+    return 0;
+}
+
+void adv_mgr_stop(void) {
+    k_work_cancel_delayable(&adv_step_work);
+    if (adv.mode != ADV_MGR_OFF)
+        bt_le_ext_adv_stop(adv.set);
+    atomic_clear(&adv_live);
+    energy_stats_adv(ENERGY_ADV_LINK, 0, 0);
+    adv.mode = ADV_MGR_OFF;
+}
+
+void adv_mgr_backoff(uint32_t attempt) {
+    if (attempt == adv.backoff)
+        return;
+    adv.backoff = attempt;
+    // 快速阶段结束时会按新的次数降速
+    if (adv.mode == ADV_MGR_BEACON && !adv.fast && atomic_get(&adv_live))
+        k_work_reschedule(&adv_step_work, K_NO_WAIT);
+}
+
+void adv_mgr_burst(void) {
+    if (adv.mode != ADV_MGR_BEACON || !atomic_get(&adv_live) || adv.fast)
+        return;
+    adv.fast = true;
+    if (adv_apply_beacon()) {
+        adv.fast = false;
+        return;
+    }
+    k_work_schedule(&adv_step_work, K_MSEC(ADV_BURST_MS));
+}
+
+// 建立连接或高占空比定向超时后控制器已停止该广播集
+static void adv_connected(struct bt_le_ext_adv *set, struct bt_le_ext_adv_connected_info *info) {
+    atomic_clear(&adv_live);
+    energy_stats_adv(ENERGY_ADV_LINK, 0, 0);
+}
+
+static void adv_sent(struct bt_le_ext_adv *set, struct bt_le_ext_adv_sent_info *info) {
+    atomic_clear(&adv_live);
+    energy_stats_adv(ENERGY_ADV_LINK, 0, 0);
+}
+
+static const struct bt_le_ext_adv_cb adv_cb = {
+    .connected = adv_connected,
+    .sent = adv_sent,
+};
+
+static void adv_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    if (adv.mode == ADV_MGR_BEACON && !adv.fast)
+        k_work_reschedule(&adv_step_work, K_NO_WAIT);
+}
+
+static struct power_mode_listener adv_power_listener = {
+    .mode_changed = adv_mode_changed,
+};
+
+int adv_mgr_init(void) {
+    struct bt_le_adv_param param = BT_LE_ADV_PARAM_INIT(BT_LE_ADV_OPT_CONN,
+        BT_GAP_ADV_SLOW_INT_MIN, BT_GAP_ADV_SLOW_INT_MAX, NULL);
+    int err;
+
+    for (size_t i = 0; i < ARRAY_SIZE(ad); i++)
+        adv.ad_len += 2 + ad[i].data_len;
+    k_work_init_delayable(&adv_step_work, adv_step_work_handler);
+    err = bt_le_ext_adv_create(&param, &adv_cb, &adv.set);
+    if (err) {
+        LOG_ERR("Advertising set create failed: %d", err);
+        return err;
+    }
+    power_mode_listener_register(&adv_power_listener);
+    LOG_INF("Advertising payload %u bytes%s", adv.ad_len,
+            IS_ENABLED(CONFIG_RING_ADV_EXT) ? ", extended PDUs" : "");
+    return 0;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_adv(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "Mode %s%s, %s, backoff %u", mode_names[adv.mode], adv.fast ? " (fast)" : "",
+                atomic_get(&adv_live) ? "on air" : "stopped", adv.backoff);
+    shell_print(sh, "Interval %u-%u ms, payload %u B, %u us per event%s",
+                adv.interval_min * 625U / 1000, adv.interval_max * 625U / 1000, adv.ad_len,
+                adv.event_us, adv_extended() ? (IS_ENABLED(CONFIG_RING_ADV_CODED) ?
+                ", extended on Coded PHY" : ", extended") : "");
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ring), adv, NULL, "Advertising mode and interval", cmd_adv, 1, 0);
+#endif
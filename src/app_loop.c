@@ -0,0 +1,54 @@
+// app_loop.c -- 应用事件循环
+// 基线中 HR 转发线程和状态监视线程各占一个 1 KB 栈，现在与 LED 图案、链路统计共用一个栈和
+// 一个线程，任务之间不再需要信号量唤醒和额外的上下文切换
+#include "app_loop.h"
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(ring_loop, CONFIG_RING_LOG_LEVEL);
+
+// 节省量只与基线比较：基线的 hrs_notify_thread 和 status_monitor_thread 各 1024 B 栈
+#define APP_LOOP_BASELINE_STACKS  (1024 + 1024)
+#define APP_LOOP_BASELINE_THREADS 2
+// 现在只有事件循环一个执行上下文；RSSI 读取在系统工作队列上（link_stats.c），不另占栈
+#define APP_LOOP_CURRENT_STACKS   CONFIG_RING_APP_LOOP_STACK_SIZE
+#define APP_LOOP_CURRENT_THREADS  1
+
+K_THREAD_STACK_DEFINE(app_loop_stack, CONFIG_RING_APP_LOOP_STACK_SIZE);
+static struct k_work_q app_loop_wq;
+
+struct k_work_q *app_loop_queue(void) {
+    return &app_loop_wq;
+}
+
+void app_loop_get_stats(struct app_loop_stats *stats) {
+    size_t unused = 0;
+
+    stats->stack_size = K_THREAD_STACK_SIZEOF(app_loop_stack);
+    stats->stack_used = 0;
+#if defined(CONFIG_INIT_STACKS) && defined(CONFIG_THREAD_STACK_INFO)
+    static bool warned;
+
+    if (!k_thread_stack_space_get(k_work_queue_thread_get(&app_loop_wq), &unused))
+        stats->stack_used = stats->stack_size - unused;
+    // 栈按高水位留出四分之一余量，超出时提示调大 CONFIG_RING_APP_LOOP_STACK_SIZE
+    if (!warned && stats->stack_used > stats->stack_size * 3 / 4) {
+        warned = true;
+        LOG_WRN("App loop stack peak %u/%u B, raise CONFIG_RING_APP_LOOP_STACK_SIZE",
+                (unsigned)stats->stack_used, (unsigned)stats->stack_size);
+    }
+#endif
+    stats->reclaimed = (int)(APP_LOOP_BASELINE_STACKS + APP_LOOP_BASELINE_THREADS * sizeof(struct k_thread)) -
+                       (int)(APP_LOOP_CURRENT_STACKS + APP_LOOP_CURRENT_THREADS * sizeof(struct k_thread));
+}
+
+int app_loop_init(void) {
+    struct k_work_queue_config cfg = { .name = "ring_app" };
+    struct app_loop_stats stats;
+
+    k_work_queue_init(&app_loop_wq);
+    k_work_queue_start(&app_loop_wq, app_loop_stack, K_THREAD_STACK_SIZEOF(app_loop_stack),
+                       CONFIG_RING_APP_LOOP_PRIORITY, &cfg);
+    app_loop_get_stats(&stats);
+    LOG_INF("App loop: %u B stack, %d B RAM reclaimed", (unsigned)stats.stack_size, stats.reclaimed);
+    return 0;
+}
@@ -0,0 +1,161 @@
+// battery.c -- 电池电量计
+// 采样周期随功耗模式变化，电量通过 Battery Service 发布，
+// 低电量判定（含迟滞）交给功耗管理 on_battery_level_changed()
+// native_sim 上由 ADC 模拟器代替 SAADC，启动时电压为 CONFIG_RING_BATTERY_EMUL_MV
+#include "battery.h"
+#include "nrf54l15_power_mgr.h"
+#include <zephyr/bluetooth/services/bas.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+
+LOG_MODULE_REGISTER(ring_battery, CONFIG_RING_LOG_LEVEL);
+
+#define BATTERY_INTERVAL_ACTIVE      60000
+#define BATTERY_INTERVAL_IDLE        120000
+#define BATTERY_INTERVAL_SLEEP       300000
+#define BATTERY_INTERVAL_DEEP_SLEEP  600000
+
+static const struct adc_dt_spec battery_adc = ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0);
+
+static struct k_work_delayable battery_work;
+static uint16_t battery_mv;
+static uint32_t battery_last_sample;
+static int16_t battery_published = -1;
+
+static uint32_t get_battery_interval(power_mode_t mode) {
+    switch (mode) {
+    case POWER_MODE_IDLE:        return BATTERY_INTERVAL_IDLE;
+    case POWER_MODE_SLEEP:       return BATTERY_INTERVAL_SLEEP;
+    case POWER_MODE_DEEP_SLEEP:  return BATTERY_INTERVAL_DEEP_SLEEP;
+    default:                     return BATTERY_INTERVAL_ACTIVE;
+    }
+}
+
+// 硬件过采样 2^N 次取平均，单次转换返回
+static int battery_read_mv(uint16_t *mv) {
+    int16_t raw = 0;
+    struct adc_sequence seq = {
+        .buffer = &raw,
+        .buffer_size = sizeof(raw),
+    };
+    int err = adc_sequence_init_dt(&battery_adc, &seq);
+    if (err) return err;
+    seq.oversampling = CONFIG_RING_BATTERY_OVERSAMPLING;
+    err = adc_read_dt(&battery_adc, &seq);
+    if (err) return err;
+    int32_t val = raw;
+    err = adc_raw_to_millivolts_dt(&battery_adc, &val);
+    if (err) return err;
+    *mv = (val > 0) ? (uint16_t)(val * CONFIG_RING_BATTERY_DIVIDER_X100 / 100) : 0;
+    return 0;
+}
+
+int battery_sample_now(void) {
+    uint16_t mv;
+    int err = battery_read_mv(&mv);
+    if (err) {
+        LOG_WRN("Battery ADC read failed: %d", err);
+        return err;
+    }
+    battery_mv = mv;
+    battery_last_sample = k_uptime_get_32();
+    uint8_t level = battery_soc_from_mv(mv);
+    if (level != battery_published) {
+        LOG_INF("Battery: %u mV, %u%%", mv, level);
+        battery_published = level;
+        bt_bas_set_battery_level(level);
+        on_battery_level_changed(level);
+    }
+    return 0;
+}
+
+uint16_t battery_get_mv(void) {
+    return battery_mv;
+}
+
+int battery_emul_set_mv(uint16_t mv) {
+#if defined(CONFIG_ADC_EMUL)
+    // 模拟器给出 ADC 引脚上的电压，按分压比换算
+    return adc_emul_const_value_set(battery_adc.dev, battery_adc.channel_id,
+                                    (uint32_t)mv * 100 / CONFIG_RING_BATTERY_DIVIDER_X100);
+#else
+    return -ENOTSUP;
+#endif
+}
+
+static void battery_work_handler(struct k_work *work) {
+    battery_sample_now();
+    k_work_schedule(&battery_work, K_MSEC(get_battery_interval(get_current_power_mode())));
+}
+
+// 按新模式的周期重排，从上一次采样时刻起算
+static void battery_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    uint32_t interval = get_battery_interval(new_mode);
+    uint32_t elapsed = k_uptime_get_32() - battery_last_sample;
+    k_work_reschedule(&battery_work, K_MSEC(elapsed >= interval ? 0 : interval - elapsed));
+}
+
+static struct power_mode_listener battery_mode_listener = {
+    .mode_changed = battery_mode_changed,
+};
+
+int battery_init(void) {
+    if (!adc_is_ready_dt(&battery_adc)) {
+        LOG_ERR("Battery ADC not ready");
+        return -ENODEV;
+    }
+    int err = adc_channel_setup_dt(&battery_adc);
+    if (err) {
+        LOG_ERR("Battery ADC setup failed: %d", err);
+        return err;
+    }
+#if defined(CONFIG_ADC_EMUL)
+    // 模拟器默认输出 0 mV，会被当作电池耗尽而直接进入深睡
+    err = battery_emul_set_mv(CONFIG_RING_BATTERY_EMUL_MV);
+    if (err) {
+        LOG_ERR("Battery emulator setup failed: %d", err);
+        return err;
+    }
+#endif
+    k_work_init_delayable(&battery_work, battery_work_handler);
+    power_mode_listener_register(&battery_mode_listener);
+    k_work_schedule(&battery_work, K_NO_WAIT);
+    return 0;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_battery_show(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "Battery %u mV, %u%%, sampled %u ms ago", battery_mv,
+                battery_soc_from_mv(battery_mv), k_uptime_get_32() - battery_last_sample);
+    return 0;
+}
+
+// 只在 ADC 模拟器上可用：设置电压后立即采样，走与硬件相同的 BAS/低电量路径
+static int cmd_battery_mv(const struct shell *sh, size_t argc, char **argv) {
+    int err = 0;
+    unsigned long mv = shell_strtoul(argv[1], 10, &err);
+
+    if (err || mv > UINT16_MAX) {
+        shell_error(sh, "Invalid voltage: %s", argv[1]);
+        return -EINVAL;
+    }
+    err = battery_emul_set_mv((uint16_t)mv);
+    if (err) {
+        shell_error(sh, "No ADC emulator: %d", err);
+        return err;
+    }
+    err = battery_sample_now();
+    if (err)
+        return err;
+    return cmd_battery_show(sh, 1, argv);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(battery_cmds,
+    SHELL_CMD_ARG(mv, NULL, "<mV> set the emulated battery voltage (native_sim)", cmd_battery_mv, 2, 0),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), battery, &battery_cmds, "Show the battery voltage and level", cmd_battery_show, 1, 0);
+#endif
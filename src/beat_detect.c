@@ -0,0 +1,131 @@
+// beat_detect.c -- PPG 心搏检测实现
+// 时间以 1/1024 s 为单位（与 HRS 的 RR 间期相同），每个样本累加 1024 / rate_hz，
+// 余数单独累计，因此不会漂移；uint32 回绕后差值仍然正确，检测不依赖样本计数
+#include "beat_detect.h"
+#include <string.h>
+
+#define MS_TO_1024(ms) ((uint32_t)(ms) * 1024 / 1000)
+
+void beat_detect_init(struct beat_detect *bd, uint16_t rate_hz) {
+    uint32_t w = (uint32_t)rate_hz * 128 / 1000;
+
+    memset(bd, 0, sizeof(*bd));
+    bd->rate_hz = rate_hz ? rate_hz : 1;
+    bd->w = w < 2 ? 2 : w > BEAT_SSF_MAX ? BEAT_SSF_MAX : w;
+    bd->learn = (uint32_t)bd->rate_hz * BEAT_LEARN_MS / 1000;
+}
+
+// 前进一个样本周期
+static void time_step(struct beat_detect *bd) {
+    bd->t += 1024 / bd->rate_hz;
+    bd->t_rem += 1024 % bd->rate_hz;
+    if (bd->t_rem >= bd->rate_hz) {
+        bd->t_rem -= bd->rate_hz;
+        bd->t++;
+    }
+}
+
+// 上一次心搏到 onset 的间期有效时写入 *rr 并返回 true
+static bool beat_register(struct beat_detect *bd, uint32_t onset, uint16_t *rr) {
+    uint32_t interval = onset - bd->last_beat;
+    bool valid = bd->have_beat && interval >= BEAT_RR_MIN && interval <= BEAT_RR_MAX;
+
+    bd->have_beat = true;
+    bd->last_beat = onset;
+    bd->beats++;
+    if (!valid)
+        return false;
+    bd->rr_hist[bd->rr_count++ % BEAT_HR_AVG] = (uint16_t)interval;
+    uint8_t k = bd->rr_count < BEAT_HR_AVG ? bd->rr_count : BEAT_HR_AVG;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < k; i++)
+        sum += bd->rr_hist[i];
+    bd->hr = (uint16_t)((60u * 1024 * k + sum / 2) / sum);
+    if (bd->rr_count >= 2 * BEAT_HR_AVG)
+        bd->rr_count -= BEAT_HR_AVG;
+    *rr = (uint16_t)interval;
+    return true;
+}
+
+// 处理一个样本，产生有效 RR 时返回 true
+static bool beat_sample(struct beat_detect *bd, int32_t x, uint16_t *rr) {
+    // 上一个样本的时刻，越过阈值的插值以它为起点
+    uint32_t t_prev = bd->t;
+    uint16_t rem_prev = bd->t_rem;
+    uint32_t t;
+    int32_t prev = bd->lp;
+    int32_t du;
+
+    if (bd->started) {
+        time_step(bd);
+    } else {
+        bd->started = true;
+        prev = bd->lp = x;
+    }
+    t = bd->t;
+    bd->n++;
+    bd->lp += (x - bd->lp) / 2;
+    du = bd->lp - prev;
+    du = du > 0 ? du : 0;
+    bd->ssf_prev = bd->ssf;
+    bd->ssf += du - bd->d[bd->d_pos];
+    bd->d[bd->d_pos] = du;
+    if (++bd->d_pos == bd->w)
+        bd->d_pos = 0;
+
+    if (bd->learn) {
+        bd->learn--;
+        if (bd->ssf > bd->level)
+            bd->level = bd->ssf;
+        bd->threshold = bd->level * 3 / 5;
+        bd->last_beat = t;
+        return false;
+    }
+
+    // 长时间没有心搏：幅度可能变小了，逐渐降低阈值
+    if (t - bd->last_beat > MS_TO_1024(BEAT_LOST_MS) / 2) {
+        bd->level -= bd->level >> 6;
+        bd->threshold = bd->level * 3 / 5;
+        if (t - bd->last_beat > MS_TO_1024(BEAT_LOST_MS)) {
+            bd->hr = 0;
+            bd->rr_count = 0;
+        }
+    }
+
+    if (!bd->in_pulse) {
+        if (bd->ssf <= bd->threshold || bd->ssf_prev > bd->threshold || bd->threshold <= 0)
+            return false;
+        if (bd->have_beat && t - bd->last_beat < MS_TO_1024(BEAT_REFRACTORY_MS))
+            return false;
+        // 越过阈值的时刻在上一个样本和本样本之间线性插值，frac 为 1/1024 个样本周期
+        uint32_t frac = (uint32_t)((int64_t)(bd->threshold - bd->ssf_prev) * 1024 /
+                                   (bd->ssf - bd->ssf_prev));
+        bd->onset = t_prev + (rem_prev + frac) / bd->rate_hz;
+        bd->in_pulse = true;
+        bd->peak = bd->ssf;
+        return false;
+    }
+    if (bd->ssf > bd->peak) {
+        bd->peak = bd->ssf;
+        return false;
+    }
+    if (bd->ssf >= bd->peak / 2)
+        return false;
+    // 脉搏的 SSF 峰已过，确认心搏并更新幅度
+    bd->in_pulse = false;
+    bd->level = (3 * bd->level + bd->peak) / 4;
+    bd->threshold = bd->level * 3 / 5;
+    return beat_register(bd, bd->onset, rr);
+}
+
+uint8_t beat_detect_run(struct beat_detect *bd, const int32_t *x, uint16_t count, uint16_t *rr,
+                        uint8_t rr_max) {
+    uint8_t n = 0;
+    uint16_t v;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (beat_sample(bd, x[i], &v) && n < rr_max)
+            rr[n++] = v;
+    }
+    return n;
+}
@@ -0,0 +1,454 @@
+// bulk.c -- L2CAP CoC 批量传输
+// 一个通道对象轮流充当客户端或服务端，同一时间只有一次传输。
+// 服务端的发送在系统工作队列中进行：每次尽量填满发送缓冲，sent 回调再次提交工作项；
+// 客户端在蓝牙 RX 上下文中处理收到的 SDU，只记日志和计数
+#include "bulk.h"
+#include "conn_params.h"
+#include "energy_stats.h"
+#include "history.h"
+#include "history_codec.h"
+#include "ring_analytics.h"
+#include "ring_status.h"
+#include "ring_types.h"
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_bulk, CONFIG_RING_LOG_LEVEL);
+
+#define BULK_MTU CONFIG_RING_BULK_MTU
+
+#if defined(CONFIG_RING_HISTORY)
+BUILD_ASSERT(BULK_MTU >= 1 + HISTORY_HEADER_SIZE + CONFIG_RING_HISTORY_BLOCK_SIZE,
+             "Bulk MTU must hold a whole history block");
+#endif
+
+NET_BUF_POOL_FIXED_DEFINE(bulk_tx_pool, CONFIG_RING_BULK_TX_BUFS, BT_L2CAP_SDU_BUF_SIZE(BULK_MTU),
+                          CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+// SDU 在 recv 返回后即释放，一个重组缓冲就够
+NET_BUF_POOL_FIXED_DEFINE(bulk_rx_pool, 1, BT_L2CAP_SDU_BUF_SIZE(BULK_MTU), 8, NULL);
+
+enum bulk_phase {
+    PHASE_HISTORY,
+    PHASE_DIAG,
+    PHASE_TEST,
+    PHASE_END,
+    PHASE_DONE,
+};
+
+static struct k_work stream_work;
+static struct k_work_delayable auto_pull_work;
+static struct bulk_stats stats;
+// 定义在回调之后，客户端和服务端建立通道时都要用到
+static const struct bt_l2cap_chan_ops bulk_ops;
+
+static struct {
+    struct bt_l2cap_le_chan le;
+    bool busy;
+    bool client;
+    bool ended;                 // 客户端已收到 END
+    bool synced;                // 服务端已写出历史缓存
+    struct bulk_request req;
+    enum bulk_phase phase;
+    uint16_t cursor;
+    uint32_t test_left;
+    int64_t start;
+    uint32_t bytes;
+    uint32_t sdus;
+    uint16_t items;
+} ch;
+
+// ---- 链路准备 ----
+
+static void link_boost(struct bt_conn *conn, bool on) {
+    int err;
+
+    conn_params_bulk(conn, on);
+    if (on) {
+        energy_stats_hci_cmd();
+        err = bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX);
+        if (err && err != -EALREADY) LOG_DBG("Data length update failed: %d", err);
+    }
+    // 2M 只在传输期间使用，结束后回到覆盖更远的 1M
+    energy_stats_hci_cmd();
+    err = bt_conn_le_phy_update(conn, on ? BT_CONN_LE_PHY_PARAM_2M : BT_CONN_LE_PHY_PARAM_1M);
+    if (err && err != -EALREADY) LOG_DBG("PHY update failed: %d", err);
+}
+
+// ---- 服务端 ----
+
+static bool stream_fill(struct net_buf *buf) {
+    size_t room = MIN(net_buf_tailroom(buf), ch.le.tx.mtu);
+    struct ring_energy_record rec;
+    struct bulk_end end;
+    int len;
+
+    for (;;) {
+        switch (ch.phase) {
+        case PHASE_HISTORY:
+            if (!(ch.req.what & BULK_REQ_HISTORY) || ch.cursor >= history_block_count()) {
+                ch.phase = PHASE_DIAG;
+                continue;
+            }
+            net_buf_add_u8(buf, BULK_ITEM_HISTORY);
+            len = history_block_read(ch.cursor++, net_buf_tail(buf), room - 1);
+            if (len <= 0) {
+                net_buf_remove_u8(buf);
+                continue;
+            }
+            net_buf_add(buf, len);
+            return true;
+        case PHASE_DIAG:
+            ch.phase = PHASE_TEST;
+            if (!(ch.req.what & BULK_REQ_DIAG) || room < 1 + sizeof(rec))
+                continue;
+            energy_stats_record_fill(&rec);
+            net_buf_add_u8(buf, BULK_ITEM_ENERGY);
+            net_buf_add_mem(buf, &rec, sizeof(rec));
+            return true;
+        case PHASE_TEST:
+            if (!ch.test_left) {
+                ch.phase = PHASE_END;
+                continue;
+            }
+            len = MIN(room - 1, ch.test_left);
+            net_buf_add_u8(buf, BULK_ITEM_TEST);
+            memset(net_buf_add(buf, len), (uint8_t)ch.sdus, len);
+            ch.test_left -= len;
+            return true;
+        case PHASE_END:
+            end.items = sys_cpu_to_le16(ch.items);
+            end.bytes = sys_cpu_to_le32(ch.bytes);
+            net_buf_add_u8(buf, BULK_ITEM_END);
+            net_buf_add_mem(buf, &end, sizeof(end));
+            ch.phase = PHASE_DONE;
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+static void stream_work_handler(struct k_work *work) {
+    // 先把缓存中的记录写出，发出的历史包含到请求为止的数据
+    if (ch.busy && !ch.synced) {
+        history_sync();
+        ch.synced = true;
+    }
+    while (ch.busy && !ch.client && ch.phase != PHASE_DONE) {
+        struct net_buf *buf = net_buf_alloc(&bulk_tx_pool, K_NO_WAIT);
+        int err;
+
+        // 缓冲用尽：对方信用不足或控制器还没发完，sent 回调后继续
+        if (!buf)
+            return;
+        net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+        if (!stream_fill(buf)) {
+            net_buf_unref(buf);
+            return;
+        }
+        if (ch.phase != PHASE_DONE) {
+            ch.items++;
+            ch.bytes += buf->len;
+        }
+        ch.sdus++;
+        err = bt_l2cap_chan_send(&ch.le.chan, buf);
+        if (err < 0) {
+            LOG_WRN("Bulk send failed: %d", err);
+            net_buf_unref(buf);
+            bt_l2cap_chan_disconnect(&ch.le.chan);
+            return;
+        }
+    }
+}
+
+static void server_request(struct net_buf *buf) {
+    if (ch.phase != PHASE_DONE || buf->len < sizeof(ch.req)) {
+        LOG_WRN("Bulk request ignored, %u B", buf->len);
+        return;
+    }
+    memcpy(&ch.req, buf->data, sizeof(ch.req));
+    ch.phase = PHASE_HISTORY;
+    ch.cursor = 0;
+    ch.items = 0;
+    ch.bytes = 0;
+    ch.sdus = 0;
+    ch.test_left = (ch.req.what & BULK_REQ_TEST) ?
+                   sys_le16_to_cpu(ch.req.test_kib) * 1024U : 0;
+    ch.start = k_uptime_get();
+    LOG_INF("Bulk request 0x%02x", ch.req.what);
+    k_work_submit(&stream_work);
+}
+
+// ---- 客户端 ----
+
+static void client_end(const struct net_buf *buf) {
+    struct bt_conn *conn = ch.le.chan.conn;
+    struct bt_conn_info info;
+    struct bulk_end end = { 0 };
+
+    ch.ended = true;
+    if (buf->len >= sizeof(end))
+        memcpy(&end, buf->data, sizeof(end));
+    stats.transfers++;
+    stats.bytes = ch.bytes;
+    stats.items = ch.items;
+    stats.ms = MAX(k_uptime_get() - ch.start, 1);
+    stats.mtu = ch.le.rx.mtu;
+    stats.mps = ch.le.rx.mps;
+    stats.ll_octets = 27;
+    stats.phy_2m = false;
+    if (!bt_conn_get_info(conn, &info)) {
+        stats.ll_octets = info.le.data_len->rx_max_len;
+        stats.phy_2m = info.le.phy->rx_phy == BT_GAP_LE_PHY_2M;
+    }
+    stats.airtime_us = bulk_airtime_us(ch.bytes, ch.sdus, stats.mps, stats.ll_octets,
+                                       stats.phy_2m);
+    if (sys_le32_to_cpu(end.bytes) != ch.bytes)
+        LOG_WRN("Bulk size mismatch: sent %u, received %u", sys_le32_to_cpu(end.bytes), ch.bytes);
+    LOG_INF("Bulk %u items, %u B in %u ms, %u B/s, radio ~%u ms (%s, LL %u B)", ch.items,
+            ch.bytes, stats.ms, (uint32_t)((uint64_t)ch.bytes * 1000 / stats.ms),
+            stats.airtime_us / 1000, stats.phy_2m ? "2M" : "1M", stats.ll_octets);
+    bt_l2cap_chan_disconnect(&ch.le.chan);
+}
+
+static void client_item(struct net_buf *buf) {
+    uint8_t type;
+
+    if (!buf->len)
+        return;
+    type = net_buf_pull_u8(buf);
+    if (type == BULK_ITEM_END) {
+        client_end(buf);
+        return;
+    }
+    ch.items++;
+    ch.bytes += 1 + buf->len;
+    ch.sdus++;
+    switch (type) {
+    case BULK_ITEM_HISTORY:
+        LOG_HEXDUMP_INF(buf->data, buf->len, "history");
+        break;
+    case BULK_ITEM_ENERGY:
+        LOG_HEXDUMP_INF(buf->data, buf->len, "energy");
+        break;
+    default:
+        break;
+    }
+}
+
+static int client_send_request(void) {
+    struct net_buf *buf = net_buf_alloc(&bulk_tx_pool, K_NO_WAIT);
+    int err;
+
+    if (!buf)
+        return -ENOMEM;
+    net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+    net_buf_add_mem(buf, &ch.req, sizeof(ch.req));
+    err = bt_l2cap_chan_send(&ch.le.chan, buf);
+    if (err < 0) {
+        net_buf_unref(buf);
+        return err;
+    }
+    return 0;
+}
+
+int bulk_pull(struct bt_conn *conn, uint8_t what, uint16_t test_kib) {
+    int err;
+
+    if (!conn)
+        return -ENOTCONN;
+    if (ch.busy)
+        return -EBUSY;
+    memset(&ch, 0, sizeof(ch));
+    ch.busy = true;
+    ch.client = true;
+    ch.phase = PHASE_DONE;
+    ch.req.what = what;
+    ch.req.test_kib = sys_cpu_to_le16(test_kib);
+    ch.le.chan.ops = &bulk_ops;
+    ch.le.rx.mtu = BULK_MTU;
+    ch.le.chan.required_sec_level = BT_SECURITY_L2;
+    // 计时包含链路准备：PHY 与数据长度更新和通道建立并行进行
+    ch.start = k_uptime_get();
+    link_boost(conn, true);
+    err = bt_l2cap_chan_connect(conn, &ch.le.chan, CONFIG_RING_BULK_PSM);
+    if (err) {
+        LOG_WRN("Bulk channel connect failed: %d", err);
+        link_boost(conn, false);
+        ch.busy = false;
+    }
+    return err;
+}
+
+// ---- 通道回调 ----
+
+static struct net_buf *bulk_alloc_buf(struct bt_l2cap_chan *chan) {
+    return net_buf_alloc(&bulk_rx_pool, K_NO_WAIT);
+}
+
+static int bulk_recv(struct bt_l2cap_chan *chan, struct net_buf *buf) {
+    if (ch.client)
+        client_item(buf);
+    else
+        server_request(buf);
+    return 0;
+}
+
+static void bulk_sent(struct bt_l2cap_chan *chan) {
+    if (!ch.client)
+        k_work_submit(&stream_work);
+}
+
+static void bulk_connected(struct bt_l2cap_chan *chan) {
+    LOG_DBG("Bulk channel up, tx MTU %u MPS %u, rx MTU %u MPS %u", ch.le.tx.mtu, ch.le.tx.mps,
+            ch.le.rx.mtu, ch.le.rx.mps);
+    if (!ch.client)
+        return;
+    int err = client_send_request();
+    if (err) {
+        LOG_WRN("Bulk request failed: %d", err);
+        bt_l2cap_chan_disconnect(chan);
+    }
+}
+
+static void bulk_disconnected(struct bt_l2cap_chan *chan) {
+    if (ch.client) {
+        if (!ch.ended) {
+            stats.failures++;
+            LOG_WRN("Bulk channel closed after %u B", ch.bytes);
+        }
+        if (chan->conn)
+            link_boost(chan->conn, false);
+    } else if (ch.phase == PHASE_DONE && ch.req.what) {
+        stats.served++;
+        LOG_INF("Bulk served %u items, %u B in %u ms", ch.items, ch.bytes,
+                (uint32_t)(k_uptime_get() - ch.start));
+    }
+    ch.busy = false;
+}
+
+static const struct bt_l2cap_chan_ops bulk_ops = {
+    .alloc_buf = bulk_alloc_buf,
+    .recv = bulk_recv,
+    .sent = bulk_sent,
+    .connected = bulk_connected,
+    .disconnected = bulk_disconnected,
+};
+
+static int bulk_accept(struct bt_conn *conn, struct bt_l2cap_server *server,
+                       struct bt_l2cap_chan **chan) {
+    if (ch.busy)
+        return -ENOMEM;
+    memset(&ch, 0, sizeof(ch));
+    ch.busy = true;
+    ch.phase = PHASE_DONE;
+    ch.le.chan.ops = &bulk_ops;
+    ch.le.rx.mtu = BULK_MTU;
+    *chan = &ch.le.chan;
+    return 0;
+}
+
+static struct bt_l2cap_server bulk_server = {
+    .psm = CONFIG_RING_BULK_PSM,
+    .sec_level = BT_SECURITY_L2,
+    .accept = bulk_accept,
+};
+
+// ---- 自动拉取（BabbleSim 测速） ----
+
+static void auto_pull_work_handler(struct k_work *work) {
+    int err = bulk_pull(central_ring.conn, BULK_REQ_HISTORY | BULK_REQ_DIAG | BULK_REQ_TEST,
+                        CONFIG_RING_BULK_AUTO_PULL_KIB);
+    if (err) LOG_WRN("Bulk auto pull failed: %d", err);
+}
+
+static void security_changed(struct bt_conn *conn, bt_security_t level, enum bt_security_err err) {
+    struct bt_conn_info info;
+
+    if (!CONFIG_RING_BULK_AUTO_PULL_KIB || err || level < BT_SECURITY_L2 ||
+        bt_conn_get_info(conn, &info) || info.role != BT_CONN_ROLE_CENTRAL)
+        return;
+    // 等 ring_client 的订阅等建链请求先完成
+    k_work_schedule(&auto_pull_work, K_SECONDS(1));
+}
+
+BT_CONN_CB_DEFINE(bulk_conn_callbacks) = {
+    .security_changed = security_changed,
+};
+
+int bulk_init(void) {
+    int err;
+
+    ch.le.chan.ops = &bulk_ops;
+    k_work_init(&stream_work, stream_work_handler);
+    k_work_init_delayable(&auto_pull_work, auto_pull_work_handler);
+    err = bt_l2cap_server_register(&bulk_server);
+    if (err) {
+        LOG_ERR("Bulk server register failed: %d", err);
+        return err;
+    }
+    LOG_INF("Bulk channel on PSM 0x%02x, MTU %u", CONFIG_RING_BULK_PSM, BULK_MTU);
+    return 0;
+}
+
+void bulk_get_stats(struct bulk_stats *out) {
+    *out = stats;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_bulk(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "%u pulls, %u failed, %u served%s", stats.transfers, stats.failures,
+                stats.served, ch.busy ? ", transfer running" : "");
+    if (!stats.transfers)
+        return 0;
+    shell_print(sh, "Last: %u items, %u B in %u ms, %u B/s", stats.items, stats.bytes, stats.ms,
+                (uint32_t)((uint64_t)stats.bytes * 1000 / stats.ms));
+    shell_print(sh, "MTU %u, MPS %u, LL %u B on %s, radio ~%u ms (%u%% of the transfer)",
+                stats.mtu, stats.mps, stats.ll_octets, stats.phy_2m ? "2M" : "1M",
+                stats.airtime_us / 1000, stats.airtime_us / 10 / stats.ms);
+    return 0;
+}
+
+// ring bulk pull [history] [diag] [test <kib>]，不带参数时拉取历史和诊断记录
+static int cmd_bulk_pull(const struct shell *sh, size_t argc, char **argv) {
+    struct bt_conn *conn = central_ring.conn ? central_ring.conn : peripheral_ring.conn;
+    uint8_t what = argc > 1 ? 0 : BULK_REQ_HISTORY | BULK_REQ_DIAG;
+    uint16_t kib = 0;
+    int err;
+
+    for (size_t i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "history")) {
+            what |= BULK_REQ_HISTORY;
+        } else if (!strcmp(argv[i], "diag")) {
+            what |= BULK_REQ_DIAG;
+        } else if (!strcmp(argv[i], "test") && i + 1 < argc) {
+            what |= BULK_REQ_TEST;
+            kib = strtoul(argv[++i], NULL, 10);
+        } else {
+            shell_error(sh, "Unknown item %s", argv[i]);
+            return -EINVAL;
+        }
+    }
+    err = bulk_pull(conn, what, kib);
+    if (err) {
+        shell_error(sh, "Pull failed: %d", err);
+        return err;
+    }
+    shell_print(sh, "Pulling, see the log");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(bulk_cmds,
+    SHELL_CMD_ARG(pull, NULL, "[history] [diag] [test <kib>]", cmd_bulk_pull, 1, 4),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), bulk, &bulk_cmds, "L2CAP bulk transfer", cmd_bulk, 1, 0);
+#endif
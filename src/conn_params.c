@@ -0,0 +1,203 @@
+// conn_params.c -- 每条链路的连接参数协商
+// 功耗模式变化时只对参数不符的链路发起更新；通过 le_param_updated 确认生效，
+// 请求失败、被拒绝或等不到结果时指数退避重试，超过次数后等待下一次模式变化
+#include "conn_params.h"
+#include "nrf54l15_power_mgr.h"
+#include "energy_stats.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(ring_conn_params, CONFIG_RING_LOG_LEVEL);
+
+#define CONN_PARAM_RETRY_BASE_MS     1000
+#define CONN_PARAM_RETRY_MAX         5
+// 被拒绝的 L2CAP 请求或失败的 LL 过程不会产生 le_param_updated；
+// 覆盖 DEEP_SLEEP 间隔下 LL 过程到达生效时刻所需的若干个连接事件
+#define CONN_PARAM_RESPONSE_TIMEOUT_MS 10000
+
+// 连接间隔单位 1.25 ms，超时单位 10 ms
+static const struct bt_le_conn_param mode_params[] = {
+    [POWER_MODE_ACTIVE]     = BT_LE_CONN_PARAM_INIT(6, 12, 0, 400),
+    [POWER_MODE_IDLE]       = BT_LE_CONN_PARAM_INIT(40, 60, 1, 600),
+    [POWER_MODE_SLEEP]      = BT_LE_CONN_PARAM_INIT(80, 120, 4, 800),
+    [POWER_MODE_DEEP_SLEEP] = BT_LE_CONN_PARAM_INIT(240, 320, 10, 1200),
+};
+
+struct link_params {
+    struct bt_conn *conn;
+    power_mode_t target;
+    bool bulk;                  // 批量传输期间固定用 ACTIVE 参数
+    bool pending;               // 已发起请求，等待 le_param_updated；retry_work 此时为响应超时
+    uint8_t retries;
+    uint16_t interval;          // 当前生效参数
+    uint16_t latency;
+    uint16_t timeout;
+    struct k_work_delayable retry_work;
+};
+
+static struct link_params links[CONFIG_BT_MAX_CONN];
+static struct conn_params_stats stats;
+
+const struct bt_le_conn_param *conn_params_for_mode(power_mode_t mode) {
+    if ((unsigned)mode >= ARRAY_SIZE(mode_params))
+        mode = POWER_MODE_ACTIVE;
+    return &mode_params[mode];
+}
+
+static bool params_match(const struct link_params *link, const struct bt_le_conn_param *p) {
+    return link->interval >= p->interval_min && link->interval <= p->interval_max &&
+           link->latency == p->latency && link->timeout == p->timeout;
+}
+
+static struct link_params *link_get(struct bt_conn *conn) {
+    struct link_params *link = &links[bt_conn_index(conn)];
+    return (link->conn == conn) ? link : NULL;
+}
+
+static void link_retry_later(struct link_params *link) {
+    if (link->retries < CONN_PARAM_RETRY_MAX) {
+        k_work_reschedule(&link->retry_work, K_MSEC(CONN_PARAM_RETRY_BASE_MS << link->retries));
+        link->retries++;
+    }
+}
+
+static void link_request(struct link_params *link) {
+    const struct bt_le_conn_param *p = conn_params_for_mode(link->target);
+
+    if (params_match(link, p)) {
+        link->pending = false;
+        link->retries = 0;
+        return;
+    }
+    energy_stats_hci_cmd();
+    int err = bt_conn_le_param_update(link->conn, p);
+    if (err == -EALREADY) {
+        link->pending = false;
+        link->retries = 0;
+        return;
+    }
+    if (err) {
+        LOG_WRN("Conn param request failed: %d", err);
+        link_retry_later(link);
+        return;
+    }
+    stats.requests++;
+    link->pending = true;
+    k_work_reschedule(&link->retry_work, K_MSEC(CONN_PARAM_RESPONSE_TIMEOUT_MS));
+    LOG_DBG("Requesting conn params: interval %d-%d, latency %d",
+            p->interval_min, p->interval_max, p->latency);
+}
+
+static void retry_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct link_params *link = CONTAINER_OF(dwork, struct link_params, retry_work);
+    if (!link->conn)
+        return;
+    if (link->pending) {
+        // 响应超时：按失败处理，退避后重新请求
+        link->pending = false;
+        stats.timeouts++;
+        LOG_WRN("Conn param update timed out");
+        link_retry_later(link);
+        return;
+    }
+    link_request(link);
+}
+
+static void link_set_target(struct link_params *link, power_mode_t mode) {
+    link->target = link->bulk ? POWER_MODE_ACTIVE : mode;
+    link->retries = 0;
+    k_work_cancel_delayable(&link->retry_work);
+    link_request(link);
+}
+
+bool conn_params_link_settled(struct bt_conn *conn) {
+    struct link_params *link = link_get(conn);
+    return link && !link->pending && params_match(link, conn_params_for_mode(link->target));
+}
+
+void conn_params_bulk(struct bt_conn *conn, bool on) {
+    struct link_params *link = link_get(conn);
+    if (!link || link->bulk == on) return;
+    link->bulk = on;
+    link_set_target(link, get_current_power_mode());
+}
+
+void conn_params_get_stats(struct conn_params_stats *out) {
+    *out = stats;
+}
+
+static void connected(struct bt_conn *conn, uint8_t err) {
+    struct bt_conn_info info;
+    if (err || bt_conn_get_info(conn, &info) || info.type != BT_CONN_TYPE_LE) return;
+    struct link_params *link = &links[bt_conn_index(conn)];
+    link->conn = conn;
+    link->pending = false;
+    link->interval = info.le.interval;
+    link->latency = info.le.latency;
+    link->timeout = info.le.timeout;
+    // 中心端已按当前模式建连，通常无需更新；作为外设时才可能需要一次更新
+    link_set_target(link, get_current_power_mode());
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    struct link_params *link = link_get(conn);
+    if (!link) return;
+    k_work_cancel_delayable(&link->retry_work);
+    link->conn = NULL;
+    link->pending = false;
+    link->bulk = false;
+}
+
+static bool le_param_req(struct bt_conn *conn, struct bt_le_conn_param *param) {
+    stats.peer_requests++;
+    // 接受对端在本应用参数范围内的请求
+    return param->interval_min >= mode_params[POWER_MODE_ACTIVE].interval_min &&
+           param->interval_max <= mode_params[POWER_MODE_DEEP_SLEEP].interval_max;
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+                             uint16_t latency, uint16_t timeout) {
+    struct link_params *link = link_get(conn);
+    if (!link) return;
+    link->interval = interval;
+    link->latency = latency;
+    link->timeout = timeout;
+    LOG_DBG("Conn params updated: interval %d, latency %d, timeout %d", interval, latency, timeout);
+    if (!link->pending) return;
+    link->pending = false;
+    k_work_cancel_delayable(&link->retry_work);
+    if (params_match(link, conn_params_for_mode(link->target))) {
+        stats.applied++;
+        link->retries = 0;
+        return;
+    }
+    // 对端拒绝或改成了其他参数：退避后重试
+    stats.rejected++;
+    link_retry_later(link);
+}
+
+BT_CONN_CB_DEFINE(conn_params_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .le_param_req = le_param_req,
+    .le_param_updated = le_param_updated,
+};
+
+static void conn_params_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    for (size_t i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn)
+            link_set_target(&links[i], new_mode);
+    }
+}
+
+static struct power_mode_listener conn_params_mode_listener = {
+    .mode_changed = conn_params_mode_changed,
+};
+
+int conn_params_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(links); i++)
+        k_work_init_delayable(&links[i].retry_work, retry_work_handler);
+    power_mode_listener_register(&conn_params_mode_listener);
+    return 0;
+}
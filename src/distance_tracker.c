@@ -0,0 +1,72 @@
+// distance_tracker.c -- 带迟滞和最短驻留时间的距离区域状态机
+#include "distance_tracker.h"
+#include <string.h>
+
+// 区域内可留给单侧迟滞的余量：宽度减 1 的一半
+static int zone_margin(int upper, int lower) {
+    return upper > lower ? (upper - lower - 1) / 2 : 0;
+}
+
+void distance_tracker_config_set(struct distance_tracker_config *cfg,
+                                 const int8_t threshold[DISTANCE_BOUNDARY_COUNT],
+                                 uint8_t hysteresis_db) {
+    memcpy(cfg->threshold, threshold, sizeof(cfg->threshold));
+    for (int i = 0; i < DISTANCE_BOUNDARY_COUNT; i++) {
+        int h = hysteresis_db;
+        // 最近和最远区域只有一侧有边界，只受内侧区域宽度限制
+        if (i > 0 && zone_margin(threshold[i - 1], threshold[i]) < h)
+            h = zone_margin(threshold[i - 1], threshold[i]);
+        if (i + 1 < DISTANCE_BOUNDARY_COUNT && zone_margin(threshold[i], threshold[i + 1]) < h)
+            h = zone_margin(threshold[i], threshold[i + 1]);
+        cfg->hysteresis[i] = (uint8_t)h;
+    }
+}
+
+void distance_tracker_init(struct distance_tracker *tracker) {
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->zone = DISTANCE_UNKNOWN;
+    tracker->candidate = DISTANCE_UNKNOWN;
+}
+
+// 以当前区域为参照移动各边界：靠近方向的边界上移、远离方向的边界下移
+static distance_level_t classify(const struct distance_tracker_config *cfg,
+                                 distance_level_t zone, int8_t rssi) {
+    for (int i = 0; i < DISTANCE_BOUNDARY_COUNT; i++) {
+        int threshold = cfg->threshold[i];
+        if (zone != DISTANCE_UNKNOWN) {
+            if (i + 1 < (int)zone)
+                threshold += cfg->hysteresis[i];
+            else
+                threshold -= cfg->hysteresis[i];
+        }
+        if (rssi >= threshold)
+            return (distance_level_t)(DISTANCE_VERY_CLOSE + i);
+    }
+    return DISTANCE_VERY_FAR;
+}
+
+bool distance_tracker_update(struct distance_tracker *tracker,
+                             const struct distance_tracker_config *cfg,
+                             int8_t rssi, uint32_t now_ms) {
+    distance_level_t target = classify(cfg, tracker->zone, rssi);
+
+    // 首个读数直接确认
+    if (tracker->zone == DISTANCE_UNKNOWN) {
+        tracker->zone = target;
+        tracker->candidate = target;
+        tracker->candidate_since = now_ms;
+        return true;
+    }
+    if (target == tracker->zone) {
+        tracker->candidate = target;
+        return false;
+    }
+    if (target != tracker->candidate) {
+        tracker->candidate = target;
+        tracker->candidate_since = now_ms;
+    }
+    if (now_ms - tracker->candidate_since < cfg->dwell_ms)
+        return false;
+    tracker->zone = target;
+    return true;
+}
@@ -0,0 +1,371 @@
+// energy_stats.c -- 能耗统计与电荷估算
+// 次数类统计在事件发生处累加；时长类统计（功耗模式/连接事件/LED/扫描/广播）在状态变化和读取时结算。
+// 电荷 = Σ 时长 × 电流 + Σ 次数 × 单次电荷，µA·ms 即 nC
+#include "energy_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_backend_std.h>
+#include <zephyr/logging/log_output.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_energy, CONFIG_RING_LOG_LEVEL);
+
+#define ENERGY_LED_MAX 4
+
+// 各模式基础电流 (µA)
+static const uint16_t mode_current_ua[ENERGY_MODE_COUNT] = {
+    [POWER_MODE_ACTIVE]     = CONFIG_RING_ENERGY_ACTIVE_UA,
+    [POWER_MODE_IDLE]       = CONFIG_RING_ENERGY_IDLE_UA,
+    [POWER_MODE_SLEEP]      = CONFIG_RING_ENERGY_SLEEP_UA,
+    [POWER_MODE_DEEP_SLEEP] = CONFIG_RING_ENERGY_DEEP_SLEEP_UA,
+};
+
+struct energy_adv_state {
+    uint32_t period_us;    // 0 为未广播
+    uint32_t event_us;     // 单次广播事件空口时间
+    uint32_t rem_us;
+    uint32_t events;
+    uint64_t airtime_us;
+};
+
+struct energy_link_state {
+    bool active;
+    uint8_t link;          // enum energy_link
+    uint32_t period_us;    // 平均连接事件间隔（外设计入从机延迟）
+    int64_t since_ms;
+    uint32_t rem_us;       // 不足一个间隔的余量
+};
+
+static struct {
+    struct k_spinlock lock;
+    int64_t window_start;
+    power_mode_t mode;
+    int64_t mode_since;
+    uint64_t mode_ms[ENERGY_MODE_COUNT];
+    struct energy_link_state links[CONFIG_BT_MAX_CONN];
+    uint32_t conn_events[ENERGY_LINK_COUNT];
+    uint32_t hci_cmds;
+    uint8_t led_mask;
+    int64_t led_since[ENERGY_LED_MAX];
+    uint64_t led_on_ms;
+    uint16_t scan_interval;
+    uint16_t scan_window;  // 0 为未扫描
+    int64_t scan_since;
+    uint64_t scan_ms;
+    uint64_t scan_rx_us;
+    struct energy_adv_state adv[ENERGY_ADV_COUNT];
+    int64_t adv_since;
+} energy;
+
+// 日志线程中累加，单独用原子量
+static atomic_t uart_bytes;
+
+static void link_accrue(struct energy_link_state *l, int64_t now) {
+    if (l->active && l->period_us) {
+        uint64_t us = (uint64_t)(now - l->since_ms) * 1000 + l->rem_us;
+        energy.conn_events[l->link] += (uint32_t)(us / l->period_us);
+        l->rem_us = (uint32_t)(us % l->period_us);
+    }
+    l->since_ms = now;
+}
+
+// 结算所有进行中的时长，调用方持锁
+static void energy_accrue(int64_t now) {
+    energy.mode_ms[energy.mode] += now - energy.mode_since;
+    energy.mode_since = now;
+    for (size_t i = 0; i < ARRAY_SIZE(energy.links); i++)
+        link_accrue(&energy.links[i], now);
+    for (uint8_t i = 0; i < ENERGY_LED_MAX; i++) {
+        if (energy.led_mask & BIT(i)) {
+            energy.led_on_ms += now - energy.led_since[i];
+            energy.led_since[i] = now;
+        }
+    }
+    if (energy.scan_window) {
+        uint64_t ms = now - energy.scan_since;
+        energy.scan_ms += ms;
+        energy.scan_rx_us += ms * 1000 * energy.scan_window / energy.scan_interval;
+    }
+    energy.scan_since = now;
+    for (int i = 0; i < ENERGY_ADV_COUNT; i++) {
+        struct energy_adv_state *a = &energy.adv[i];
+        if (a->period_us) {
+            uint64_t us = (uint64_t)(now - energy.adv_since) * 1000 + a->rem_us;
+            uint32_t events = (uint32_t)(us / a->period_us);
+            a->events += events;
+            a->airtime_us += (uint64_t)events * a->event_us;
+            a->rem_us = (uint32_t)(us % a->period_us);
+        }
+    }
+    energy.adv_since = now;
+}
+
+void energy_stats_reset(void) {
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    int64_t now = k_uptime_get();
+    energy_accrue(now);
+    energy.window_start = now;
+    memset(energy.mode_ms, 0, sizeof(energy.mode_ms));
+    memset(energy.conn_events, 0, sizeof(energy.conn_events));
+    energy.hci_cmds = 0;
+    energy.led_on_ms = 0;
+    energy.scan_ms = 0;
+    energy.scan_rx_us = 0;
+    for (int i = 0; i < ENERGY_ADV_COUNT; i++) {
+        energy.adv[i].events = 0;
+        energy.adv[i].airtime_us = 0;
+    }
+    atomic_clear(&uart_bytes);
+    k_spin_unlock(&energy.lock, key);
+}
+
+void energy_stats_hci_cmd(void) {
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    energy.hci_cmds++;
+    k_spin_unlock(&energy.lock, key);
+}
+
+void energy_stats_led(uint8_t led, bool on) {
+    if (led >= ENERGY_LED_MAX) return;
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    bool was_on = energy.led_mask & BIT(led);
+    if (on != was_on) {
+        int64_t now = k_uptime_get();
+        if (on) {
+            energy.led_mask |= BIT(led);
+            energy.led_since[led] = now;
+        } else {
+            energy.led_mask &= ~BIT(led);
+            energy.led_on_ms += now - energy.led_since[led];
+        }
+    }
+    k_spin_unlock(&energy.lock, key);
+}
+
+void energy_stats_scan(uint16_t interval, uint16_t window) {
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    energy_accrue(k_uptime_get());
+    energy.scan_interval = interval;
+    energy.scan_window = (interval && window) ? MIN(window, interval) : 0;
+    k_spin_unlock(&energy.lock, key);
+}
+
+void energy_stats_adv(enum energy_adv set, uint32_t period_us, uint32_t airtime_us) {
+    if (set >= ENERGY_ADV_COUNT) return;
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    energy_accrue(k_uptime_get());
+    energy.adv[set].period_us = period_us;
+    energy.adv[set].event_us = airtime_us;
+    energy.adv[set].rem_us = 0;
+    k_spin_unlock(&energy.lock, key);
+}
+
+void energy_stats_get(struct energy_report *report) {
+    memset(report, 0, sizeof(*report));
+
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    int64_t now = k_uptime_get();
+    energy_accrue(now);
+    report->window_ms = (uint32_t)(now - energy.window_start);
+    for (int m = 0; m < ENERGY_MODE_COUNT; m++)
+        report->mode_ms[m] = (uint32_t)energy.mode_ms[m];
+    memcpy(report->conn_events, energy.conn_events, sizeof(report->conn_events));
+    report->hci_cmds = energy.hci_cmds;
+    report->led_on_ms = (uint32_t)energy.led_on_ms;
+    report->scan_ms = (uint32_t)energy.scan_ms;
+    report->scan_rx_ms = (uint32_t)(energy.scan_rx_us / 1000);
+    uint64_t adv_airtime_us = 0;
+    for (int i = 0; i < ENERGY_ADV_COUNT; i++) {
+        report->adv_events += energy.adv[i].events;
+        adv_airtime_us += energy.adv[i].airtime_us;
+    }
+    report->per_adv_airtime_ms = (uint32_t)(energy.adv[ENERGY_ADV_PERIODIC].airtime_us / 1000);
+    k_spin_unlock(&energy.lock, key);
+    report->uart_bytes = atomic_get(&uart_bytes);
+
+    for (int m = 0; m < ENERGY_MODE_COUNT; m++)
+        report->charge_nc[ENERGY_CAT_BASE] += (uint64_t)report->mode_ms[m] * mode_current_ua[m];
+    report->charge_nc[ENERGY_CAT_RADIO] = ((uint64_t)report->conn_events[ENERGY_LINK_CENTRAL] +
+        report->conn_events[ENERGY_LINK_PERIPHERAL]) * CONFIG_RING_ENERGY_CONN_EVENT_NC;
+    report->charge_nc[ENERGY_CAT_HCI] = (uint64_t)report->hci_cmds * CONFIG_RING_ENERGY_HCI_CMD_NC;
+    report->charge_nc[ENERGY_CAT_LED] = (uint64_t)report->led_on_ms * CONFIG_RING_ENERGY_LED_UA;
+    report->charge_nc[ENERGY_CAT_UART] = (uint64_t)report->uart_bytes * CONFIG_RING_ENERGY_UART_BYTE_NC;
+    report->charge_nc[ENERGY_CAT_SCAN] = (uint64_t)report->scan_rx_ms * CONFIG_RING_ENERGY_SCAN_UA;
+    report->adv_airtime_ms = (uint32_t)(adv_airtime_us / 1000);
+    report->charge_nc[ENERGY_CAT_ADV] = adv_airtime_us * CONFIG_RING_ENERGY_ADV_TX_UA / 1000;
+    for (int c = 0; c < ENERGY_CAT_COUNT; c++)
+        report->total_nc += report->charge_nc[c];
+}
+
+void energy_stats_record_fill(struct ring_energy_record *rec) {
+    struct energy_report report;
+
+    energy_stats_get(&report);
+    memset(rec, 0, sizeof(*rec));
+    rec->version = RING_ENERGY_VERSION;
+    rec->uptime_s = k_uptime_get_32() / 1000;
+    for (int m = 0; m < ENERGY_MODE_COUNT; m++)
+        rec->mode_s[m] = report.mode_ms[m] / 1000;
+    rec->conn_events[0] = report.conn_events[ENERGY_LINK_CENTRAL];
+    rec->conn_events[1] = report.conn_events[ENERGY_LINK_PERIPHERAL];
+    rec->hci_cmds = report.hci_cmds;
+    rec->led_on_ms = report.led_on_ms;
+    rec->uart_bytes = report.uart_bytes;
+    rec->scan_ms = report.scan_ms;
+    rec->scan_rx_ms = report.scan_rx_ms;
+    rec->adv_events = report.adv_events;
+    rec->adv_airtime_ms = report.adv_airtime_ms;
+    for (int c = 0; c < ENERGY_CAT_COUNT; c++)
+        rec->charge_uc[c] = (uint32_t)(report.charge_nc[c] / 1000);
+}
+
+// ---- 功耗模式 ----
+
+static void energy_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    energy_accrue(k_uptime_get());
+    energy.mode = new_mode;
+    k_spin_unlock(&energy.lock, key);
+}
+
+static struct power_mode_listener energy_mode_listener = {
+    .mode_changed = energy_mode_changed,
+};
+
+// ---- 连接事件：按当前连接参数积分 ----
+
+static void link_set_params(struct bt_conn *conn, uint16_t interval, uint16_t latency, bool fresh) {
+    struct bt_conn_info info;
+    if (bt_conn_get_info(conn, &info) || info.type != BT_CONN_TYPE_LE) return;
+
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    struct energy_link_state *l = &energy.links[bt_conn_index(conn)];
+    int64_t now = k_uptime_get();
+    if (fresh) {
+        l->active = false;
+        l->rem_us = 0;
+    }
+    link_accrue(l, now);
+    l->active = true;
+    l->link = (info.role == BT_CONN_ROLE_CENTRAL) ? ENERGY_LINK_CENTRAL : ENERGY_LINK_PERIPHERAL;
+    // 外设按从机延迟跳过空事件；中心每个间隔都要发包
+    l->period_us = (uint32_t)interval * 1250U *
+                   ((l->link == ENERGY_LINK_PERIPHERAL) ? (latency + 1U) : 1U);
+    k_spin_unlock(&energy.lock, key);
+}
+
+static void connected(struct bt_conn *conn, uint8_t err) {
+    struct bt_conn_info info;
+    if (err || bt_conn_get_info(conn, &info) || info.type != BT_CONN_TYPE_LE) return;
+    link_set_params(conn, info.le.interval, info.le.latency, true);
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    k_spinlock_key_t key = k_spin_lock(&energy.lock);
+    struct energy_link_state *l = &energy.links[bt_conn_index(conn)];
+    link_accrue(l, k_uptime_get());
+    l->active = false;
+    k_spin_unlock(&energy.lock, key);
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+                             uint16_t latency, uint16_t timeout) {
+    link_set_params(conn, interval, latency, false);
+}
+
+BT_CONN_CB_DEFINE(energy_conn_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .le_param_updated = le_param_updated,
+};
+
+// ---- UART 字节数：与 UART 后端相同格式输出到计数函数 ----
+
+#if defined(CONFIG_LOG_BACKEND_UART)
+static int uart_count_out(uint8_t *data, size_t length, void *ctx) {
+    atomic_add(&uart_bytes, length);
+    return length;
+}
+
+static uint8_t uart_count_buf[16];
+LOG_OUTPUT_DEFINE(uart_count_output, uart_count_out, uart_count_buf, sizeof(uart_count_buf));
+
+static void uart_count_process(const struct log_backend *const backend, union log_msg_generic *msg) {
+    uint32_t format = IS_ENABLED(CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY) ?
+                      LOG_OUTPUT_DICT : LOG_OUTPUT_TEXT;
+    log_format_func_t out = log_format_func_t_get(format);
+    out(&uart_count_output, &msg->log, log_backend_std_get_flags());
+}
+
+static void uart_count_panic(const struct log_backend *const backend) {
+}
+
+static const struct log_backend_api uart_count_api = {
+    .process = uart_count_process,
+    .panic = uart_count_panic,
+};
+
+LOG_BACKEND_DEFINE(energy_uart_count, uart_count_api, true);
+#endif
+
+int energy_stats_init(void) {
+    int64_t now = k_uptime_get();
+    energy.window_start = now;
+    energy.mode = get_current_power_mode();
+    energy.mode_since = now;
+    power_mode_listener_register(&energy_mode_listener);
+    return 0;
+}
+
+#if defined(CONFIG_SHELL)
+static const char * const mode_names[ENERGY_MODE_COUNT] = {
+    "active", "idle", "sleep", "deep sleep"
+};
+static const char * const category_names[ENERGY_CAT_COUNT] = {
+    "base", "radio", "hci", "led", "uart", "scan", "adv"
+};
+
+// nC 以 µAh 显示，保留三位小数（1 µAh = 3600000 nC）
+static void print_uah(const struct shell *sh, const char *name, uint64_t nc) {
+    uint64_t nah = nc / 3600;
+    shell_print(sh, "  %-10s %llu.%03llu uAh", name, nah / 1000, nah % 1000);
+}
+
+static int cmd_energy(const struct shell *sh, size_t argc, char **argv) {
+    struct energy_report r;
+
+    energy_stats_get(&r);
+    shell_print(sh, "Window %u s, average %u uA", r.window_ms / 1000, energy_report_avg_ua(&r));
+    for (int m = 0; m < ENERGY_MODE_COUNT; m++)
+        shell_print(sh, "  %-10s %u s", mode_names[m], r.mode_ms[m] / 1000);
+    shell_print(sh, "  conn events central %u, peripheral %u",
+                r.conn_events[ENERGY_LINK_CENTRAL], r.conn_events[ENERGY_LINK_PERIPHERAL]);
+    shell_print(sh, "  hci %u, led %u ms, uart %u B", r.hci_cmds, r.led_on_ms, r.uart_bytes);
+    uint32_t duty = energy_report_scan_duty(&r);
+    shell_print(sh, "  scan %u ms, rx %u ms, duty %u.%u%%", r.scan_ms, r.scan_rx_ms,
+                duty / 10, duty % 10);
+    shell_print(sh, "  adv events %u, airtime %u ms (periodic %u ms)", r.adv_events,
+                r.adv_airtime_ms, r.per_adv_airtime_ms);
+    for (int c = 0; c < ENERGY_CAT_COUNT; c++)
+        print_uah(sh, category_names[c], r.charge_nc[c]);
+    print_uah(sh, "total", r.total_nc);
+    return 0;
+}
+
+static int cmd_energy_reset(const struct shell *sh, size_t argc, char **argv) {
+    energy_stats_reset();
+    shell_print(sh, "Energy window restarted");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(energy_cmds,
+    SHELL_CMD(reset, NULL, "Restart the measurement window", cmd_energy_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), energy, &energy_cmds, "Energy accounting", cmd_energy, 1, 0);
+#endif
@@ -0,0 +1,118 @@
+// gatt_cache.c -- GATT 发现结果缓存
+// 条目在启动时由 settings_load() 载入内存表，连接时同步查找，不访问闪存
+#include "gatt_cache.h"
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_gatt_cache, CONFIG_RING_LOG_LEVEL);
+
+#define GATT_CACHE_SUBTREE "ring/gatt"
+// 键：地址类型 + 6 字节地址，十六进制
+#define GATT_CACHE_ADDR_HEX_LEN (2 * sizeof(bt_addr_le_t))
+
+static struct {
+    bool valid;
+    bt_addr_le_t addr;
+    struct gatt_cache_entry entry;
+} cache[CONFIG_BT_MAX_PAIRED];
+
+static void cache_key(const bt_addr_le_t *addr, char *key, size_t len) {
+    char hex[GATT_CACHE_ADDR_HEX_LEN + 1];
+    bin2hex((const uint8_t *)addr, sizeof(*addr), hex, sizeof(hex));
+    snprintf(key, len, GATT_CACHE_SUBTREE "/%s", hex);
+}
+
+static int cache_index(const bt_addr_le_t *addr) {
+    for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+        if (cache[i].valid && bt_addr_le_eq(&cache[i].addr, addr))
+            return i;
+    }
+    return -ENOENT;
+}
+
+int gatt_cache_find(const bt_addr_le_t *addr, struct gatt_cache_entry *entry) {
+    int i = cache_index(addr);
+    if (i < 0)
+        return i;
+    *entry = cache[i].entry;
+    return 0;
+}
+
+int gatt_cache_store(const bt_addr_le_t *addr, const struct gatt_cache_entry *entry) {
+    char key[sizeof(GATT_CACHE_SUBTREE) + GATT_CACHE_ADDR_HEX_LEN + 1];
+    int i = cache_index(addr);
+
+    for (int j = 0; i < 0 && j < ARRAY_SIZE(cache); j++) {
+        if (!cache[j].valid)
+            i = j;
+    }
+    for (int j = 0; i < 0 && j < ARRAY_SIZE(cache); j++) {
+        if (!bt_addr_le_is_bonded(BT_ID_DEFAULT, &cache[j].addr)) {
+            gatt_cache_delete(&cache[j].addr);
+            i = j;
+        }
+    }
+    if (i < 0)
+        return -ENOMEM;
+    cache[i].valid = true;
+    bt_addr_le_copy(&cache[i].addr, addr);
+    cache[i].entry = *entry;
+    cache_key(addr, key, sizeof(key));
+    return settings_save_one(key, entry, sizeof(*entry));
+}
+
+void gatt_cache_delete(const bt_addr_le_t *addr) {
+    char key[sizeof(GATT_CACHE_SUBTREE) + GATT_CACHE_ADDR_HEX_LEN + 1];
+
+    for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+        if (!cache[i].valid || (addr && !bt_addr_le_eq(&cache[i].addr, addr)))
+            continue;
+        cache_key(&cache[i].addr, key, sizeof(key));
+        settings_delete(key);
+        cache[i].valid = false;
+    }
+}
+
+int gatt_cache_count(void) {
+    int n = 0;
+    for (int i = 0; i < ARRAY_SIZE(cache); i++)
+        n += cache[i].valid;
+    return n;
+}
+
+static int gatt_cache_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    bt_addr_le_t addr;
+    int i;
+
+    if (!name || strlen(name) != GATT_CACHE_ADDR_HEX_LEN ||
+        hex2bin(name, GATT_CACHE_ADDR_HEX_LEN, (uint8_t *)&addr, sizeof(addr)) != sizeof(addr))
+        return -EINVAL;
+    if (len != sizeof(struct gatt_cache_entry)) {
+        // 布局变化后旧条目作废，下次连接重新发现
+        LOG_WRN("Dropping GATT cache entry with old layout");
+        return 0;
+    }
+    i = cache_index(&addr);
+    for (int j = 0; i < 0 && j < ARRAY_SIZE(cache); j++) {
+        if (!cache[j].valid)
+            i = j;
+    }
+    if (i < 0)
+        return -ENOMEM;
+    ssize_t rc = read_cb(cb_arg, &cache[i].entry, sizeof(cache[i].entry));
+    if (rc < 0)
+        return rc;
+    bt_addr_le_copy(&cache[i].addr, &addr);
+    cache[i].valid = true;
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ring_gatt_cache, GATT_CACHE_SUBTREE, NULL,
+                               gatt_cache_settings_set, NULL, NULL);
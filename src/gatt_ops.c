@@ -0,0 +1,168 @@
+// gatt_ops.c -- GATT 操作编排器
+// 队列由自旋锁保护；发起操作只在应用事件循环上进行，完成回调来自蓝牙 RX 线程
+#include "gatt_ops.h"
+#include "app_loop.h"
+#include <zephyr/logging/log.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_gatt_ops, CONFIG_RING_LOG_LEVEL);
+
+#define RETRY_BASE_MS 20
+#define RETRY_MAX     5
+
+static const struct gatt_op *queue_pop(struct gatt_ops *ops) {
+    const struct gatt_op *op = ops->queue[ops->head];
+    ops->head = (ops->head + 1) % GATT_OPS_QUEUE_LEN;
+    ops->count--;
+    return op;
+}
+
+static void queue_push_front(struct gatt_ops *ops, const struct gatt_op *op) {
+    ops->head = (ops->head + GATT_OPS_QUEUE_LEN - 1) % GATT_OPS_QUEUE_LEN;
+    ops->queue[ops->head] = op;
+    ops->count++;
+}
+
+static void pump_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct gatt_ops *ops = CONTAINER_OF(dwork, struct gatt_ops, pump);
+    const struct gatt_op *op;
+    struct bt_conn *conn;
+    k_spinlock_key_t key;
+    int err;
+
+    for (;;) {
+        key = k_spin_lock(&ops->lock);
+        if (!ops->conn || ops->in_flight) {
+            k_spin_unlock(&ops->lock, key);
+            return;
+        }
+        if (!ops->count) {
+            k_spin_unlock(&ops->lock, key);
+            if (ops->idle) ops->idle();
+            return;
+        }
+        op = ops->queue[ops->head];
+        if ((op->flags & GATT_OP_F_ENCRYPTED) && !ops->encrypted) {
+            k_spin_unlock(&ops->lock, key);
+            return;
+        }
+        queue_pop(ops);
+        ops->in_flight = op;
+        conn = ops->conn;
+        k_spin_unlock(&ops->lock, key);
+
+        // 完成回调可能在 start() 返回前到达，之后不再触碰 in_flight
+        err = op->start(conn);
+        if (err == 0) {
+            key = k_spin_lock(&ops->lock);
+            ops->stats.att_ops++;
+            k_spin_unlock(&ops->lock, key);
+            return;
+        }
+
+        key = k_spin_lock(&ops->lock);
+        ops->in_flight = NULL;
+        if ((err == -ENOMEM || err == -EBUSY) && ops->attempts < RETRY_MAX) {
+            uint32_t delay = RETRY_BASE_MS << ops->attempts;
+            ops->attempts++;
+            ops->stats.retries++;
+            queue_push_front(ops, op);
+            k_spin_unlock(&ops->lock, key);
+            LOG_DBG("%s busy (%d), retry in %u ms", op->name, err, delay);
+            app_loop_reschedule(&ops->pump, K_MSEC(delay));
+            return;
+        }
+        ops->attempts = 0;
+        if (err < 0)
+            ops->stats.failures++;
+        k_spin_unlock(&ops->lock, key);
+        if (err < 0) {
+            LOG_WRN("%s failed: %d", op->name, err);
+            if (ops->failed) ops->failed(op, err);
+        }
+    }
+}
+
+void gatt_ops_init(struct gatt_ops *ops, void (*failed)(const struct gatt_op *op, int err),
+                   void (*idle)(void)) {
+    memset(ops, 0, sizeof(*ops));
+    ops->failed = failed;
+    ops->idle = idle;
+    k_work_init_delayable(&ops->pump, pump_work_handler);
+}
+
+void gatt_ops_attach(struct gatt_ops *ops, struct bt_conn *conn) {
+    k_spinlock_key_t key = k_spin_lock(&ops->lock);
+    ops->conn = conn;
+    ops->head = 0;
+    ops->count = 0;
+    ops->in_flight = NULL;
+    ops->attempts = 0;
+    ops->encrypted = false;
+    memset(&ops->stats, 0, sizeof(ops->stats));
+    k_spin_unlock(&ops->lock, key);
+}
+
+void gatt_ops_detach(struct gatt_ops *ops) {
+    k_spinlock_key_t key = k_spin_lock(&ops->lock);
+    ops->conn = NULL;
+    ops->count = 0;
+    ops->in_flight = NULL;
+    k_spin_unlock(&ops->lock, key);
+    k_work_cancel_delayable(&ops->pump);
+}
+
+int gatt_ops_submit(struct gatt_ops *ops, const struct gatt_op *op) {
+    k_spinlock_key_t key = k_spin_lock(&ops->lock);
+    int err = 0;
+
+    if (!ops->conn) {
+        err = -ENOTCONN;
+        goto out;
+    }
+    for (int i = 0; i < ops->count; i++) {
+        if (ops->queue[(ops->head + i) % GATT_OPS_QUEUE_LEN] == op)
+            goto out;
+    }
+    if (ops->count == GATT_OPS_QUEUE_LEN) {
+        err = -ENOMEM;
+        goto out;
+    }
+    ops->queue[(ops->head + ops->count) % GATT_OPS_QUEUE_LEN] = op;
+    ops->count++;
+out:
+    k_spin_unlock(&ops->lock, key);
+    if (!err)
+        app_loop_schedule(&ops->pump, K_NO_WAIT);
+    return err;
+}
+
+void gatt_ops_complete(struct gatt_ops *ops, struct bt_conn *conn, int err) {
+    k_spinlock_key_t key = k_spin_lock(&ops->lock);
+    const struct gatt_op *op = ops->in_flight;
+
+    if (conn != ops->conn || !op) {
+        k_spin_unlock(&ops->lock, key);
+        return;
+    }
+    ops->in_flight = NULL;
+    ops->attempts = 0;
+    if (err)
+        ops->stats.failures++;
+    k_spin_unlock(&ops->lock, key);
+
+    if (err) {
+        LOG_WRN("%s failed: %d", op->name, err);
+        if (ops->failed) ops->failed(op, err);
+    }
+    app_loop_schedule(&ops->pump, K_NO_WAIT);
+}
+
+void gatt_ops_set_encrypted(struct gatt_ops *ops) {
+    k_spinlock_key_t key = k_spin_lock(&ops->lock);
+    ops->encrypted = true;
+    k_spin_unlock(&ops->lock, key);
+    app_loop_schedule(&ops->pump, K_NO_WAIT);
+}
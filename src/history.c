@@ -0,0 +1,380 @@
+// history.c -- 历史记录的采集、降采样与分块写入
+// 采集钩子可能在蓝牙 RX、按钮和事件循环上下文中调用，只在自旋锁内编码到 RAM 块；
+// 写闪存只在事件循环的 flush 工作项中进行。两个块缓冲轮换：一个接收新记录，
+// 另一个等待写出，两者都满时丢弃新记录并计数。
+// 启动时 settings_load() 只读各槽的块头，找出最新序号，之后从下一个槽继续写
+#include "history.h"
+#include "app_loop.h"
+#include "history_codec.h"
+#include "link_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include "ring_analytics.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/storage/flash_map.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_history, CONFIG_RING_LOG_LEVEL);
+
+#define HISTORY_SUBTREE   "ring/hist"
+#define HISTORY_BOOT_KEY  "boot"
+#define HISTORY_KEY_LEN   (sizeof(HISTORY_SUBTREE) + 4)
+// settings 后端每个条目的额外开销（ZMS 的 ATE 为 16 B，NVS 为 8 B），用于估算擦除次数
+#define HISTORY_ENTRY_OVERHEAD 16
+
+#if FIXED_PARTITION_EXISTS(storage_partition)
+#define HISTORY_PARTITION_SIZE FIXED_PARTITION_SIZE(storage_partition)
+#else
+#define HISTORY_PARTITION_SIZE 0
+#endif
+
+struct history_block {
+    struct history_encoder enc;
+    uint8_t data[HISTORY_HEADER_SIZE + CONFIG_RING_HISTORY_BLOCK_SIZE];
+};
+
+static struct k_work_delayable flush_work;
+
+static struct {
+    struct k_spinlock lock;
+    struct history_block blocks[2];
+    uint8_t active;
+    bool pending;          // 另一个块已封存，等待写出
+    // 心率按当前模式的周期取平均
+    uint32_t hr_start_s;
+    uint32_t hr_last_s;
+    uint32_t hr_sum;
+    uint16_t hr_count;
+    uint32_t hrv_last_s;
+    uint8_t zone;
+    uint8_t touch;         // 按下状态，bit0 本端，bit1 对方
+    struct history_stats stats;
+    uint16_t next_slot;
+    bool ready;
+} hist;
+
+static uint32_t history_now_s(void) {
+    return k_uptime_get_32() / 1000;
+}
+
+static struct history_encoder *active_enc(void) {
+    return &hist.blocks[hist.active].enc;
+}
+
+static void block_open(uint32_t now_s) {
+    struct history_block *b = &hist.blocks[hist.active];
+    history_encoder_init(&b->enc, &b->data[HISTORY_HEADER_SIZE], CONFIG_RING_HISTORY_BLOCK_SIZE,
+                         now_s);
+}
+
+// 封存当前块，切到另一个缓冲；调用方持锁，返回 false 表示另一个块还没写出
+static bool block_seal(uint32_t now_s) {
+    if (hist.pending)
+        return false;
+    hist.pending = true;
+    hist.active ^= 1;
+    block_open(now_s);
+    return true;
+}
+
+// 调用方持锁。当前块满时封存并立即写出；encode 为对应记录的编码函数
+#define HISTORY_PUT(now_s, encode, ...)                                         \
+    do {                                                                        \
+        if (!encode(active_enc(), now_s, __VA_ARGS__)) {                        \
+            if (!block_seal(now_s) || !encode(active_enc(), now_s, __VA_ARGS__)) { \
+                hist.stats.dropped++;                                           \
+                break;                                                          \
+            }                                                                   \
+            app_loop_reschedule(&flush_work, K_NO_WAIT);                        \
+        }                                                                       \
+        hist.stats.records++;                                                   \
+        if (active_enc()->count == 1)                                           \
+            app_loop_schedule(&flush_work, K_SECONDS(                           \
+                history_profile_get(get_current_power_mode())->flush_s));       \
+    } while (0)
+
+void history_hr(const struct hr_sample *sample) {
+    const struct history_profile *p = history_profile_get(get_current_power_mode());
+    uint32_t now_s = sample->timestamp / 1000;
+    uint16_t rr[HR_SAMPLE_RR_MAX];
+    uint8_t rr_count = MIN(sample->rr_count, HR_SAMPLE_RR_MAX);
+    k_spinlock_key_t key;
+
+    if (!hist.ready || !sample->hr)
+        return;
+    // 样本是 packed 结构，先拷出 RR
+    for (uint8_t i = 0; i < rr_count; i++)
+        rr[i] = sample->rr[i];
+
+    key = k_spin_lock(&hist.lock);
+    if (hist.hr_count && now_s - hist.hr_start_s >= p->hr_period_s) {
+        uint16_t avg = (hist.hr_sum + hist.hr_count / 2) / hist.hr_count;
+        HISTORY_PUT(hist.hr_last_s, history_encode_hr, avg);
+        hist.hr_count = 0;
+    }
+    if (!hist.hr_count) {
+        hist.hr_start_s = now_s;
+        hist.hr_sum = 0;
+    }
+    hist.hr_sum += sample->hr;
+    hist.hr_count++;
+    hist.hr_last_s = now_s;
+    if (p->rr && rr_count)
+        HISTORY_PUT(now_s, history_encode_rr, rr, rr_count);
+    k_spin_unlock(&hist.lock, key);
+}
+
+void history_hrv(const struct hrv *h) {
+    const struct history_profile *p = history_profile_get(get_current_power_mode());
+    uint32_t now_s = history_now_s();
+    k_spinlock_key_t key;
+
+    if (!hist.ready || !p->hrv_s || h->count < HRV_MIN_BEATS)
+        return;
+    key = k_spin_lock(&hist.lock);
+    if (!hist.hrv_last_s || now_s - hist.hrv_last_s >= p->hrv_s) {
+        hist.hrv_last_s = now_s;
+        HISTORY_PUT(now_s, history_encode_hrv, h->rmssd_ms, h->sdnn_ms, h->stress);
+    }
+    k_spin_unlock(&hist.lock, key);
+}
+
+// 对方的触摸可能同时经 LBS 按钮通知和 LED 写入到达，只记录状态变化
+void history_touch(bool pressed, bool remote) {
+    uint8_t flags = (pressed ? HISTORY_TOUCH_PRESSED : 0) | (remote ? HISTORY_TOUCH_REMOTE : 0);
+    uint8_t bit = BIT(remote);
+    k_spinlock_key_t key;
+
+    if (!hist.ready)
+        return;
+    key = k_spin_lock(&hist.lock);
+    if (!!(hist.touch & bit) != pressed) {
+        hist.touch ^= bit;
+        HISTORY_PUT(history_now_s(), history_encode_touch, flags);
+    }
+    k_spin_unlock(&hist.lock, key);
+}
+
+// 两条链路连的是同一个对方，只记录区间的变化
+static void history_zone_changed(struct ring_connection *ring, distance_level_t old_zone,
+                                 distance_level_t new_zone) {
+    k_spinlock_key_t key;
+
+    if (!hist.ready)
+        return;
+    key = k_spin_lock(&hist.lock);
+    if (new_zone != hist.zone) {
+        hist.zone = new_zone;
+        HISTORY_PUT(history_now_s(), history_encode_zone, new_zone);
+    }
+    k_spin_unlock(&hist.lock, key);
+}
+
+static struct distance_listener history_distance_listener = {
+    .zone_changed = history_zone_changed,
+};
+
+static void history_key(uint16_t slot, char *key, size_t len) {
+    snprintf(key, len, HISTORY_SUBTREE "/%u", slot);
+}
+
+// 只在事件循环中运行，写出时不持锁：封存的块在 pending 清零前不会被复用
+static void flush_work_handler(struct k_work *work) {
+    struct history_block_header hdr = {
+        .version = HISTORY_FORMAT_VERSION,
+        .boot = hist.stats.boot,
+    };
+    struct history_block *b;
+    char key[HISTORY_KEY_LEN];
+    k_spinlock_key_t key_lock;
+    int err;
+
+    key_lock = k_spin_lock(&hist.lock);
+    if (!hist.pending && active_enc()->count)
+        block_seal(history_now_s());
+    if (!hist.pending) {
+        k_spin_unlock(&hist.lock, key_lock);
+        return;
+    }
+    b = &hist.blocks[hist.active ^ 1];
+    k_spin_unlock(&hist.lock, key_lock);
+
+    hdr.seq = hist.stats.seq + 1;
+    hdr.start_s = b->enc.start_s;
+    hdr.count = b->enc.count;
+    hdr.len = b->enc.len;
+    history_header_write(b->data, &hdr);
+    history_key(hist.next_slot, key, sizeof(key));
+    err = settings_save_one(key, b->data, HISTORY_HEADER_SIZE + hdr.len);
+
+    key_lock = k_spin_lock(&hist.lock);
+    if (err) {
+        hist.stats.write_errors++;
+    } else {
+        hist.stats.seq = hdr.seq;
+        hist.stats.flushes++;
+        hist.stats.bytes += HISTORY_HEADER_SIZE + hdr.len;
+        hist.next_slot = (hist.next_slot + 1) % CONFIG_RING_HISTORY_BLOCKS;
+    }
+    hist.pending = false;
+    // 写出期间当前块已有记录时为它重新计时
+    if (active_enc()->count)
+        app_loop_schedule(&flush_work, K_SECONDS(
+            history_profile_get(get_current_power_mode())->flush_s));
+    k_spin_unlock(&hist.lock, key_lock);
+
+    if (err) LOG_WRN("History block %u write failed: %d", hdr.seq, err);
+    else LOG_DBG("History block %u: %u records, %u B", hdr.seq, hdr.count, hdr.len);
+}
+
+static int history_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                                void *cb_arg) {
+    uint8_t buf[HISTORY_HEADER_SIZE];
+    struct history_block_header hdr;
+    const char *next;
+    char *end;
+    unsigned long slot;
+    ssize_t rc;
+
+    if (!name)
+        return -EINVAL;
+    if (settings_name_steq(name, HISTORY_BOOT_KEY, &next) && !next) {
+        if (len != sizeof(hist.stats.boot))
+            return -EINVAL;
+        rc = read_cb(cb_arg, &hist.stats.boot, sizeof(hist.stats.boot));
+        return rc < 0 ? rc : 0;
+    }
+    slot = strtoul(name, &end, 10);
+    if (*end || slot >= CONFIG_RING_HISTORY_BLOCKS || len < HISTORY_HEADER_SIZE)
+        return 0;   // 槽数减少后多出的块留到下次覆盖
+    // 只读块头
+    rc = read_cb(cb_arg, buf, sizeof(buf));
+    if (rc < (ssize_t)sizeof(buf))
+        return rc < 0 ? rc : 0;
+    if (!history_header_read(buf, &hdr))
+        return 0;
+    if (hdr.seq > hist.stats.seq) {
+        hist.stats.seq = hdr.seq;
+        hist.next_slot = (slot + 1) % CONFIG_RING_HISTORY_BLOCKS;
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ring_history, HISTORY_SUBTREE, NULL, history_settings_set, NULL,
+                               NULL);
+
+int history_init(void) {
+    int err;
+
+    k_work_init_delayable(&flush_work, flush_work_handler);
+    block_open(history_now_s());
+    hist.zone = DISTANCE_UNKNOWN;
+    hist.stats.boot++;
+    err = settings_save_one(HISTORY_SUBTREE "/" HISTORY_BOOT_KEY, &hist.stats.boot,
+                            sizeof(hist.stats.boot));
+    if (err) {
+        LOG_ERR("History boot counter save failed: %d", err);
+        return err;
+    }
+    link_stats_distance_listener_register(&history_distance_listener);
+    hist.ready = true;
+    LOG_INF("History boot %u, next block %u in slot %u of %u", hist.stats.boot,
+            hist.stats.seq + 1, hist.next_slot, CONFIG_RING_HISTORY_BLOCKS);
+    return 0;
+}
+
+void history_get_stats(struct history_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&hist.lock);
+    *stats = hist.stats;
+    k_spin_unlock(&hist.lock, key);
+}
+
+struct history_read_ctx {
+    void *buf;
+    size_t len;
+    int rc;
+};
+
+static int history_read_cb(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                           void *param) {
+    struct history_read_ctx *ctx = param;
+
+    if (key)
+        return 0;
+    ctx->rc = read_cb(cb_arg, ctx->buf, MIN(len, ctx->len));
+    return 0;
+}
+
+void history_sync(void) {
+    struct k_work_sync sync;
+    k_work_flush_delayable(&flush_work, &sync);
+}
+
+uint16_t history_block_count(void) {
+    return MIN(hist.stats.seq, CONFIG_RING_HISTORY_BLOCKS);
+}
+
+int history_block_read(uint16_t i, void *buf, size_t len) {
+    struct history_read_ctx ctx = { .buf = buf, .len = len, .rc = -ENOENT };
+    uint16_t n = history_block_count();
+    char key[HISTORY_KEY_LEN];
+    int err;
+
+    if (i >= n)
+        return -ENOENT;
+    history_key((hist.next_slot + CONFIG_RING_HISTORY_BLOCKS - n + i) % CONFIG_RING_HISTORY_BLOCKS,
+                key, sizeof(key));
+    err = settings_load_subtree_direct(key, history_read_cb, &ctx);
+    return err ? err : ctx.rc;
+}
+
+#if defined(CONFIG_SHELL)
+// 按序号从旧到新输出已写出的块，主机端用 scripts/decode_status.py 解码
+static int cmd_history_dump(const struct shell *sh, size_t argc, char **argv) {
+    static uint8_t buf[HISTORY_HEADER_SIZE + CONFIG_RING_HISTORY_BLOCK_SIZE];
+    uint16_t n;
+
+    // 等待中的块先写出，保证输出包含到当前为止的记录
+    history_sync();
+    n = history_block_count();
+    for (uint16_t i = 0; i < n; i++) {
+        int len = history_block_read(i, buf, sizeof(buf));
+        if (len > 0)
+            LOG_HEXDUMP_INF(buf, len, "history");
+    }
+    shell_print(sh, "%u blocks dumped to the log", n);
+    return 0;
+}
+
+static int cmd_history(const struct shell *sh, size_t argc, char **argv) {
+    struct history_stats s;
+    uint32_t up_s = MAX(history_now_s(), 1);
+    uint64_t per_day;
+
+    history_get_stats(&s);
+    shell_print(sh, "Boot %u, %u records, %u dropped, block %u (slot %u of %u)", s.boot,
+                s.records, s.dropped, s.seq, hist.next_slot, CONFIG_RING_HISTORY_BLOCKS);
+    shell_print(sh, "%u blocks written, %u B, %u write errors, %u B/h", s.flushes, s.bytes,
+                s.write_errors, (uint32_t)((uint64_t)s.bytes * 3600 / up_s));
+    // 后端循环使用整个分区，每个扇区每天的擦除次数约为写入量 / 分区大小
+    per_day = ((uint64_t)s.bytes + (uint64_t)s.flushes * HISTORY_ENTRY_OVERHEAD) * 86400 / up_s;
+    if (HISTORY_PARTITION_SIZE)
+        shell_print(sh, "Projected %u.%02u erase cycles/day on a %u KiB partition",
+                    (uint32_t)(per_day / HISTORY_PARTITION_SIZE),
+                    (uint32_t)(per_day * 100 / HISTORY_PARTITION_SIZE % 100),
+                    HISTORY_PARTITION_SIZE / 1024);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(history_cmds,
+    SHELL_CMD(dump, NULL, "Dump stored blocks to the log", cmd_history_dump),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), history, &history_cmds, "HR and proximity history", cmd_history, 1, 0);
+#endif
@@ -0,0 +1,139 @@
+// history_codec.c -- 历史记录差分编码实现，不依赖蓝牙协议栈和内核
+#include "history_codec.h"
+#include <string.h>
+
+#define VARINT_MAX 5
+
+static uint8_t varint_put(uint8_t *out, uint32_t v) {
+    uint8_t n = 0;
+    do {
+        uint8_t b = v & 0x7f;
+        v >>= 7;
+        out[n++] = b | (v ? 0x80 : 0);
+    } while (v);
+    return n;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+void history_encoder_init(struct history_encoder *enc, uint8_t *buf, uint16_t size, uint32_t start_s) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buf = buf;
+    enc->size = size;
+    enc->start_s = start_s;
+    enc->last_s = start_s;
+}
+
+// 先编码到临时缓冲，放得下才提交，失败时编码器状态不变
+static uint8_t record_head(struct history_encoder *enc, uint8_t *tmp, uint8_t type, uint8_t arg,
+                           uint32_t t_s) {
+    uint32_t dt = t_s > enc->last_s ? t_s - enc->last_s : 0;
+    tmp[0] = (uint8_t)((type & 0x0f) | (arg << 4));
+    return 1 + varint_put(&tmp[1], dt);
+}
+
+static bool record_commit(struct history_encoder *enc, const uint8_t *tmp, uint16_t n, uint32_t t_s) {
+    if (enc->len + n > enc->size)
+        return false;
+    memcpy(&enc->buf[enc->len], tmp, n);
+    enc->len += n;
+    enc->count++;
+    if (t_s > enc->last_s)
+        enc->last_s = t_s;
+    return true;
+}
+
+bool history_encode_hr(struct history_encoder *enc, uint32_t t_s, uint16_t hr) {
+    uint8_t tmp[1 + 2 * VARINT_MAX];
+    uint8_t n = record_head(enc, tmp, HISTORY_HR, 0, t_s);
+
+    n += varint_put(&tmp[n], zigzag((int32_t)hr - enc->last_hr));
+    if (!record_commit(enc, tmp, n, t_s))
+        return false;
+    enc->last_hr = hr;
+    return true;
+}
+
+bool history_encode_rr(struct history_encoder *enc, uint32_t t_s, const uint16_t *rr, uint8_t count) {
+    uint8_t tmp[1 + VARINT_MAX + HISTORY_RR_MAX * 3];
+    uint16_t last = enc->last_rr;
+    uint8_t n;
+
+    if (!count)
+        return true;
+    if (count > HISTORY_RR_MAX)
+        count = HISTORY_RR_MAX;
+    n = record_head(enc, tmp, HISTORY_RR, count, t_s);
+    for (uint8_t i = 0; i < count; i++) {
+        n += varint_put(&tmp[n], zigzag((int32_t)rr[i] - last));
+        last = rr[i];
+    }
+    if (!record_commit(enc, tmp, n, t_s))
+        return false;
+    enc->last_rr = last;
+    return true;
+}
+
+bool history_encode_zone(struct history_encoder *enc, uint32_t t_s, uint8_t zone) {
+    uint8_t tmp[1 + VARINT_MAX];
+    uint8_t n = record_head(enc, tmp, HISTORY_ZONE, zone & 0x0f, t_s);
+    return record_commit(enc, tmp, n, t_s);
+}
+
+bool history_encode_touch(struct history_encoder *enc, uint32_t t_s, uint8_t flags) {
+    uint8_t tmp[1 + VARINT_MAX];
+    uint8_t n = record_head(enc, tmp, HISTORY_TOUCH, flags & 0x0f, t_s);
+    return record_commit(enc, tmp, n, t_s);
+}
+
+bool history_encode_hrv(struct history_encoder *enc, uint32_t t_s, uint16_t rmssd_ms,
+                        uint16_t sdnn_ms, uint16_t stress) {
+    uint8_t tmp[1 + 4 * VARINT_MAX];
+    uint8_t n = record_head(enc, tmp, HISTORY_HRV, 0, t_s);
+
+    n += varint_put(&tmp[n], rmssd_ms);
+    n += varint_put(&tmp[n], sdnn_ms);
+    n += varint_put(&tmp[n], stress);
+    return record_commit(enc, tmp, n, t_s);
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(&p[2], (uint16_t)(v >> 16));
+}
+
+static uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return get_le16(p) | ((uint32_t)get_le16(&p[2]) << 16);
+}
+
+void history_header_write(uint8_t out[HISTORY_HEADER_SIZE], const struct history_block_header *hdr) {
+    out[0] = hdr->version;
+    out[1] = hdr->flags;
+    put_le16(&out[2], hdr->boot);
+    put_le32(&out[4], hdr->seq);
+    put_le32(&out[8], hdr->start_s);
+    put_le16(&out[12], hdr->count);
+    put_le16(&out[14], hdr->len);
+}
+
+bool history_header_read(const uint8_t in[HISTORY_HEADER_SIZE], struct history_block_header *hdr) {
+    hdr->version = in[0];
+    hdr->flags = in[1];
+    hdr->boot = get_le16(&in[2]);
+    hdr->seq = get_le32(&in[4]);
+    hdr->start_s = get_le32(&in[8]);
+    hdr->count = get_le16(&in[12]);
+    hdr->len = get_le16(&in[14]);
+    return hdr->version >= 1 && hdr->version <= HISTORY_FORMAT_VERSION;
+}
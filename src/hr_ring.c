@@ -0,0 +1,33 @@
+// hr_ring.c -- 单生产者/单消费者无锁心率样本环形缓冲区
+#include "hr_ring.h"
+
+#define HR_RING_MASK (HR_RING_SIZE - 1)
+
+bool hr_ring_push(struct hr_ring *ring, const struct hr_sample *sample) {
+    uint32_t head = (uint32_t)atomic_get(&ring->head);
+    uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+
+    if (head - tail >= HR_RING_SIZE) {
+        atomic_inc(&ring->dropped);
+        return false;
+    }
+    ring->buf[head & HR_RING_MASK] = *sample;
+    // 写入数据后再发布 head，atomic_set 带完整内存屏障
+    atomic_set(&ring->head, (atomic_val_t)(head + 1));
+    return true;
+}
+
+bool hr_ring_pop(struct hr_ring *ring, struct hr_sample *sample) {
+    uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+    uint32_t head = (uint32_t)atomic_get(&ring->head);
+
+    if (head == tail)
+        return false;
+    *sample = ring->buf[tail & HR_RING_MASK];
+    atomic_set(&ring->tail, (atomic_val_t)(tail + 1));
+    return true;
+}
+
+uint32_t hr_ring_count(const struct hr_ring *ring) {
+    return (uint32_t)atomic_get((atomic_t *)&ring->head) - (uint32_t)atomic_get((atomic_t *)&ring->tail);
+}
@@ -0,0 +1,157 @@
+// hr_sync.c -- 心率同步流式分析实现
+// 相关系数 r = (c·Σxy − Σx·Σy) / √((c·Σx² − (Σx)²)(c·Σy² − (Σy)²))，分子分母都是精确整数，
+// 只在最后一次除法中转为 Q15。心率不超过 250，窗口 32 时各和都在 int32 范围内
+#include "hr_sync.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HIST_MASK (HR_SYNC_HISTORY - 1)
+// 窗口方差低于 1 bpm² 视为平稳，只按平均心率差判断
+#define VAR_FLOOR 1
+
+_Static_assert((int64_t)HR_SYNC_WINDOW * HR_SYNC_WINDOW * 250 * 250 < INT32_MAX,
+               "HR sync sums overflow int32");
+
+void hr_sync_init(struct hr_sync *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0, bit = 1ULL << 62;
+
+    while (bit > v)
+        bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+hr_level_t hr_level_update(hr_level_t level, uint16_t hr) {
+    if (!hr)
+        return level;
+    switch (level) {
+    case HR_LEVEL_HIGH:
+        return hr < HR_HIGH_THRESHOLD - HR_LEVEL_HYSTERESIS ? HR_LEVEL_NORMAL : level;
+    case HR_LEVEL_LOW:
+        return hr > HR_LOW_THRESHOLD + HR_LEVEL_HYSTERESIS ? HR_LEVEL_NORMAL : level;
+    default:
+        if (hr > HR_HIGH_THRESHOLD)
+            return HR_LEVEL_HIGH;
+        if (hr < HR_LOW_THRESHOLD)
+            return HR_LEVEL_LOW;
+        return HR_LEVEL_NORMAL;
+    }
+}
+
+// 样本 i 进入 (sign = 1) 或离开 (sign = -1) 窗口
+static void window_step(struct hr_sync *s, uint32_t i, int32_t sign) {
+    int32_t x = s->hr[i & HIST_MASK];
+
+    s->sum += sign * x;
+    s->sum_sq += sign * x * x;
+    for (int k = 0; k < HR_SYNC_LAGS; k++) {
+        int32_t y = s->partner[(i + k - HR_SYNC_MAX_LAG) & HIST_MASK];
+        s->p_sum[k] += sign * y;
+        s->p_sum_sq[k] += sign * y * y;
+        s->cross[k] += sign * x * y;
+    }
+}
+
+// 窗口统计量 → 最佳滞后相关系数、平均差与一致度
+static void window_score(struct hr_sync *s, const struct ring_tunables *t) {
+    int64_t c = s->count;
+    int64_t var = c * s->sum_sq - (int64_t)s->sum * s->sum;
+    int32_t best = INT32_MIN;
+    int8_t best_lag = 0;
+    int32_t level, trend, diff_x16, scale_x16;
+
+    for (int k = 0; k < HR_SYNC_LAGS; k++) {
+        int64_t p_var = c * s->p_sum_sq[k] - (int64_t)s->p_sum[k] * s->p_sum[k];
+        int64_t num = c * s->cross[k] - (int64_t)s->sum * s->p_sum[k];
+        int32_t r;
+
+        if (var < c * c * VAR_FLOOR || p_var < c * c * VAR_FLOOR) {
+            best = INT32_MIN;
+            break;
+        }
+        r = (int32_t)(num * HR_SYNC_Q15_ONE / isqrt64((uint64_t)var * (uint64_t)p_var));
+        // 同样相关时取滞后绝对值小的
+        if (r > best || (r == best && abs(k - HR_SYNC_MAX_LAG) < abs(best_lag))) {
+            best = r;
+            best_lag = (int8_t)(k - HR_SYNC_MAX_LAG);
+        }
+    }
+
+    diff_x16 = (int32_t)(labs((long)s->sum - s->p_sum[HR_SYNC_MAX_LAG]) * 16 / c);
+    s->mean_diff_x16 = (uint16_t)(diff_x16 > UINT16_MAX ? UINT16_MAX : diff_x16);
+    // 平均差为 0 时满分，达到 2 倍同步阈值时为 0
+    scale_x16 = 2 * 16 * (t->hr_sync_threshold ? t->hr_sync_threshold : 1);
+    level = diff_x16 >= scale_x16 ? 0 : HR_SYNC_Q15_ONE - diff_x16 * HR_SYNC_Q15_ONE / scale_x16;
+    if (best == INT32_MIN) {
+        // 平稳序列没有可比较的起伏，一致度只看平均差
+        s->corr = 0;
+        s->lag = 0;
+        trend = HR_SYNC_Q15_ONE;
+    } else {
+        if (best >= HR_SYNC_Q15_ONE)
+            best = HR_SYNC_Q15_ONE - 1;
+        s->corr = (int16_t)best;
+        s->lag = best_lag;
+        trend = best > 0 ? best : 0;
+    }
+    // 起伏不相关时一致度减半，完全相关时等于平均差得分
+    s->coherence = (uint16_t)(((int64_t)level * (HR_SYNC_Q15_ONE + trend)) >> 16);
+}
+
+static void window_clear(struct hr_sync *s) {
+    bool synced = s->synced;
+
+    hr_sync_init(s);
+    s->synced = synced;
+}
+
+uint8_t hr_sync_update(struct hr_sync *s, const struct ring_tunables *t, uint16_t own_hr,
+                       uint16_t partner_hr) {
+    uint8_t ev = 0;
+
+    if (!partner_hr || !own_hr) {
+        if (s->n)
+            window_clear(s);
+        if (s->synced) {
+            s->synced = false;
+            ev |= HR_SYNC_EV_SYNC_OFF;
+        }
+        return ev;
+    }
+
+    s->hr[s->n & HIST_MASK] = own_hr;
+    s->partner[s->n & HIST_MASK] = partner_hr;
+    s->n++;
+    // 进入窗口的样本需要其后 MAX_LAG 个对方样本，因此落后最新样本 MAX_LAG 个
+    if (s->n < 2 * HR_SYNC_MAX_LAG + 1)
+        return ev;
+    window_step(s, s->n - 1 - HR_SYNC_MAX_LAG, 1);
+    if (s->count == HR_SYNC_WINDOW)
+        window_step(s, s->n - 1 - HR_SYNC_MAX_LAG - HR_SYNC_WINDOW, -1);
+    else
+        s->count++;
+    if (s->count < HR_SYNC_MIN_SAMPLES)
+        return ev;
+
+    window_score(s, t);
+    if (!s->synced && s->coherence >= HR_SYNC_ENTER_Q15) {
+        s->synced = true;
+        ev |= HR_SYNC_EV_SYNC_ON;
+    } else if (s->synced && s->coherence < HR_SYNC_EXIT_Q15) {
+        s->synced = false;
+        ev |= HR_SYNC_EV_SYNC_OFF;
+    }
+    return ev;
+}
@@ -0,0 +1,126 @@
+// hrv.c -- 心率变异性流式计算实现
+// SDNN 用样本方差 (nΣx² − (Σx)²) / (n(n−1))，RMSSD 用窗口内相邻差平方的均值，
+// 分子都是精确整数；压力指数 SI = AMo / (2·Mo·MxDMn)，其中 AMo 为众数桶占比 (%)，
+// Mo 为众数桶中心 (s)，MxDMn 取直方图非空桶的跨度 (s)，分辨率为一个桶宽
+#include "hrv.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert((uint64_t)HRV_WINDOW * HRV_RR_MAX_MS * HRV_RR_MAX_MS <= UINT32_MAX,
+               "HRV sums overflow uint32");
+
+void hrv_init(struct hrv *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void hrv_break(struct hrv *h) {
+    h->chained = false;
+}
+
+static uint16_t isqrt32(uint32_t v) {
+    uint32_t r = 0, bit = 1u << 30;
+
+    while (bit > v)
+        bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)r;
+}
+
+static uint8_t bin_of(uint16_t ms) {
+    return (ms - HRV_RR_MIN_MS) / HRV_BIN_MS;
+}
+
+// 最旧的一拍离开窗口
+static void window_drop(struct hrv *h, uint16_t i) {
+    uint16_t ms = h->rr[i];
+    int32_t d = h->diff[i];
+
+    h->sum -= ms;
+    h->sum_sq -= (uint32_t)ms * ms;
+    h->hist[bin_of(ms)]--;
+    if (d != HRV_NO_DIFF) {
+        h->diff_sq -= (uint32_t)(d * d);
+        h->diff_count--;
+    }
+}
+
+static void metrics_update(struct hrv *h) {
+    uint32_t n = h->count;
+    uint16_t mode = 0, lo = HRV_BINS, hi = 0;
+    uint64_t var;
+
+    if (n < HRV_MIN_BEATS) {
+        h->rmssd_ms = h->sdnn_ms = h->stress = 0;
+        return;
+    }
+    h->rmssd_ms = h->diff_count ?
+        isqrt32((h->diff_sq + h->diff_count / 2) / h->diff_count) : 0;
+    var = ((uint64_t)n * h->sum_sq - (uint64_t)h->sum * h->sum) / ((uint64_t)n * (n - 1));
+    h->sdnn_ms = isqrt32((uint32_t)var);
+
+    for (uint16_t b = 0; b < HRV_BINS; b++) {
+        if (!h->hist[b])
+            continue;
+        if (lo == HRV_BINS)
+            lo = b;
+        hi = b;
+        if (h->hist[b] > h->hist[mode])
+            mode = b;
+    }
+    uint32_t mo_ms = HRV_RR_MIN_MS + mode * HRV_BIN_MS + HRV_BIN_MS / 2;
+    uint32_t span_ms = (hi - lo + 1) * HRV_BIN_MS;
+    // AMo% / (2 · Mo/1000 · MxDMn/1000) = hist[mode] · 5e7 / (n · Mo · MxDMn)
+    uint64_t si = (uint64_t)h->hist[mode] * 50000000u / ((uint64_t)n * mo_ms * span_ms);
+    h->stress = si > UINT16_MAX ? UINT16_MAX : (uint16_t)si;
+}
+
+bool hrv_add_rr(struct hrv *h, uint16_t rr) {
+    uint16_t ms = ((uint32_t)rr * 1000 + 512) >> 10;
+    int32_t d;
+
+    if (ms < HRV_RR_MIN_MS || ms > HRV_RR_MAX_MS) {
+        h->rejected++;
+        h->chained = false;
+        return false;
+    }
+    if (h->ref && abs((int32_t)ms - h->ref) * 5 > h->ref) {
+        // 连续偏离说明节律确实变了，以当前拍为新基准，但不与上一拍求差
+        h->chained = false;
+        if (++h->rejected_run < HRV_RESYNC) {
+            h->rejected++;
+            return false;
+        }
+    }
+
+    if (h->count == HRV_WINDOW)
+        window_drop(h, h->head);
+    else
+        h->count++;
+    d = h->chained ? (int32_t)ms - h->ref : HRV_NO_DIFF;
+    h->rr[h->head] = ms;
+    h->diff[h->head] = (int16_t)d;
+    h->sum += ms;
+    h->sum_sq += (uint32_t)ms * ms;
+    h->hist[bin_of(ms)]++;
+    if (d != HRV_NO_DIFF) {
+        h->diff_sq += (uint32_t)(d * d);
+        h->diff_count++;
+    }
+    if (++h->head == HRV_WINDOW)
+        h->head = 0;
+
+    h->ref = ms;
+    h->chained = true;
+    h->rejected_run = 0;
+    h->beats++;
+    metrics_update(h);
+    return true;
+}
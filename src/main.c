@@ -6,49 +6,58 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/hci_vs.h>
-#include <bluetooth/gatt_dm.h>
-#include <bluetooth/scan.h>
 #include <zephyr/bluetooth/services/bas.h>
 #include <zephyr/bluetooth/services/hrs.h>
-#include <bluetooth/services/hrs_client.h>
 #include <bluetooth/services/lbs.h>
 #include <dk_buttons_and_leds.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/kernel.h>
-#include <zephyr/sys/printk.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
 #include <stdlib.h>
 #include <zephyr/sys/byteorder.h>
 
 #include "ring_types.h"
 #include "nrf54l15_power_mgr.h"
+#include "link_stats.h"
+#include "hr_ring.h"
+#include "ring_status.h"
+#include "battery.h"
+#include "conn_params.h"
+#include "energy_stats.h"
+#include "ring_tune.h"
+#include "app_loop.h"
+#include "ring_client.h"
+#include "presence.h"
+#include "reconnect.h"
+#include "history.h"
+#include "bulk.h"
+#include "hr_sync.h"
+#include "hrv.h"
+#include "ppg.h"
+
+LOG_MODULE_REGISTER(ring_main, CONFIG_RING_LOG_LEVEL);
 
 /////////////////////////////////////////////////////////////////
 // ==== 1. 类型定义、全局配置块（ring_types & config） =========
 /////////////////////////////////////////////////////////////////
 
-#define STACKSIZE 1024
-#define PRIORITY 7
-
 #define RUN_STATUS_LED             DK_LED1
 #define CENTRAL_CON_STATUS_LED     DK_LED2
 #define PERIPHERAL_CONN_STATUS_LED DK_LED3
 #define USER_LED                   DK_LED4
 #define RUN_LED_BLINK_INTERVAL 1000
-#define RSSI_UPDATE_INTERVAL 3000
+#define STATUS_INTERVAL_ACTIVE 10000
+#define STATUS_INTERVAL_SLEEP  30000
 #define LED_FLASH_INTERVAL 150
 #define LED_FLASH_COUNT 3
-#define HRS_QUEUE_SIZE 16
 #define USER_BUTTON    DK_BTN1_MSK
 
-#define RSSI_VERY_CLOSE_THRESHOLD  (-35)
-#define RSSI_CLOSE_THRESHOLD       (-55)
-#define RSSI_MEDIUM_THRESHOLD      (-70)
-#define RSSI_FAR_THRESHOLD         (-85)
-#define RSSI_HISTORY_SIZE 5
-#define HR_SYNC_THRESHOLD 15
-#define HR_HIGH_THRESHOLD 110
-#define HR_LOW_THRESHOLD 50
 #define DEBOUNCE_MS 70
+// 基线的 HR 队列：k_msgq 存 16 条完整的 bt_hrs_client_measurement，每条 16 B（NCS 默认 4 个
+// RR 间期）。HRS 客户端已由 ring_client 取代，结构体不再可见，只保留数值用于启动日志中的对比
+#define HR_BASELINE_QUEUE_LEN  16
+#define HR_BASELINE_MEAS_SIZE  16
 
 typedef enum {
 	LED_STATE_OFF,
@@ -60,14 +69,6 @@ typedef enum {
 struct ring_connection central_ring = {0};
 struct ring_connection peripheral_ring = {0};
 static atomic_t app_button_state = ATOMIC_INIT(0);
-static atomic_t system_ready = ATOMIC_INIT(0);
-
-static const char * const sensor_location_str[] = {
-	"Other", "Chest", "Wrist", "Finger", "Hand", "Ear lobe", "Foot"
-};
-static const char * const distance_str[] = {
-	"Unknown", "Very Close", "Close", "Medium", "Far", "Very Far"
-};
 
 /////////////////////////////////////////////////////////////////
 // ==== 2. LED 管理模块（所有实现提前，依赖安全） ================
@@ -84,6 +85,12 @@ static struct {
 	atomic_t flash_active;
 } led_manager = {0};
 
+// 所有 LED 经此设置，便于能耗统计点亮时长
+static void ring_led_set(uint8_t led, bool on) {
+	dk_set_led(led, on);
+	energy_stats_led(led, on);
+}
+
 static void led_set_state_locked(led_state_t new_state, bool user_controlled) {
 	k_mutex_lock(&led_manager.mutex, K_FOREVER);
 	k_work_cancel_delayable(&led_manager.flash_work);
@@ -93,15 +100,15 @@ static void led_set_state_locked(led_state_t new_state, bool user_controlled) {
 	led_manager.state = new_state;
 	led_manager.user_controlled = user_controlled;
 	switch (new_state) {
-		case LED_STATE_OFF:      dk_set_led(USER_LED, false); break;
-		case LED_STATE_ON:       dk_set_led(USER_LED, true);  break;
+		case LED_STATE_OFF:      ring_led_set(USER_LED, false); break;
+		case LED_STATE_ON:       ring_led_set(USER_LED, true);  break;
 		case LED_STATE_FLASHING:
 			led_manager.flash_remaining = LED_FLASH_COUNT;
 			atomic_set(&led_manager.flash_active, 1);
-			k_work_schedule(&led_manager.flash_work, K_NO_WAIT);
+			app_loop_schedule(&led_manager.flash_work, K_NO_WAIT);
 			break;
 		case LED_STATE_BREATHING:
-			k_work_schedule(&led_manager.breathing_work, K_NO_WAIT);
+			app_loop_schedule(&led_manager.breathing_work, K_NO_WAIT);
 			break;
 	}
 	k_mutex_unlock(&led_manager.mutex);
@@ -111,12 +118,12 @@ static void led_flash_work_handler(struct k_work *work) {
 	k_mutex_lock(&led_manager.mutex, K_FOREVER);
 	if (led_manager.flash_remaining > 0) {
 		bool led_on = (led_manager.flash_remaining % 2) == 1;
-		dk_set_led(USER_LED, led_on);
+		ring_led_set(USER_LED, led_on);
 		led_manager.flash_remaining--;
-		k_work_schedule(&led_manager.flash_work, K_MSEC(LED_FLASH_INTERVAL));
+		app_loop_schedule(&led_manager.flash_work, K_MSEC(LED_FLASH_INTERVAL));
 	} else {
 		atomic_set(&led_manager.flash_active, 0);
-		dk_set_led(USER_LED, led_manager.user_controlled);
+		ring_led_set(USER_LED, led_manager.user_controlled);
 	}
 	k_mutex_unlock(&led_manager.mutex);
 }
@@ -127,95 +134,25 @@ static void led_breathing_work_handler(struct k_work *work) {
 	brightness += direction * 25;
 	if (brightness >= 100) { brightness = 100; direction = -1; }
 	else if (brightness <= 0) { brightness = 0; direction = 1; }
-	dk_set_led(USER_LED, brightness > 50);
-	k_work_schedule(&led_manager.breathing_work, K_MSEC(50));
+	ring_led_set(USER_LED, brightness > 50);
+	app_loop_schedule(&led_manager.breathing_work, K_MSEC(50));
 }
 
 /////////////////////////////////////////////////////////////////
-// ==== 3. 全局 LBS 客户端上下文和相关回调 ======================
+// ==== 3. 对方戒指按钮（LBS 客户端见 ring_client.c） ===========
 /////////////////////////////////////////////////////////////////
 
-static struct {
-	uint16_t button_value_handle;
-	uint16_t button_ccc_handle;
-	uint16_t led_value_handle;
-	struct bt_gatt_subscribe_params sub_params;
-	struct bt_gatt_write_params write_params;
-	atomic_t subscribed;
-	atomic_t write_pending;
-	uint8_t write_buf[1];
-	uint32_t last_button_time;
-} lbs_client_ctx;
-
-static void lbs_write_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_write_params *params) {
-	atomic_set(&lbs_client_ctx.write_pending, 0);
-	if (err) printk("LBS LED write failed: %u\n", err);
-	else printk("LBS LED write OK\n");
-	if (params) params->handle = 0U;
-}
-
-static uint8_t lbs_button_notify_cb(struct bt_conn *conn,
-				    struct bt_gatt_subscribe_params *params,
-				    const void *data, uint16_t length)
-{
-	uint32_t now = k_uptime_get_32();
-	if (!data) { atomic_set(&lbs_client_ctx.subscribed,0); printk("Button sub removed\n"); return BT_GATT_ITER_STOP; }
-	if (length<1) return BT_GATT_ITER_CONTINUE;
-	if (now-lbs_client_ctx.last_button_time < DEBOUNCE_MS) return BT_GATT_ITER_CONTINUE;
-	lbs_client_ctx.last_button_time = now;
-	uint8_t button_pressed = ((const uint8_t *)data)[0];
-	printk("👆 Partner button %s\n", button_pressed?"PRESSED":"RELEASED");
-	if (button_pressed) {
+static void partner_button_changed(bool pressed) {
+	LOG_INF("👆 Partner button %s", pressed?"PRESSED":"RELEASED");
+	history_touch(pressed, true);
+	if (pressed) {
 		on_user_activity();
-		// dk_set_led(CENTRAL_CON_STATUS_LED, true); k_sleep(K_MSEC(100));
-		// dk_set_led(CENTRAL_CON_STATUS_LED, central_ring.conn?true:false);
-		led_set_state_locked(LED_STATE_ON, button_pressed);
-		printk("💕 Remote touch via button\n");
+		led_set_state_locked(LED_STATE_ON, pressed);
+		LOG_INF("💕 Remote touch via button");
 	}else{
-		led_set_state_locked(LED_STATE_OFF, button_pressed);
+		led_set_state_locked(LED_STATE_OFF, pressed);
 	}
-	return BT_GATT_ITER_CONTINUE;
-}
-
-static void discovery_completed_lbs_cb(struct bt_gatt_dm *dm, void *context) {
-	int err;
-	const struct bt_gatt_dm_attr *chrc, *val, *desc;
-	if (!dm) { printk("LBS discovery NULL\n"); return; }
-	printk("LBS discovered\n"); bt_gatt_dm_data_print(dm);
-	chrc = bt_gatt_dm_char_by_uuid(dm, BT_UUID_LBS_LED);
-	if (chrc) {
-		val = bt_gatt_dm_attr_next(dm, chrc);
-		lbs_client_ctx.led_value_handle = val ? val->handle : (chrc->handle + 1);
-		printk("LED char handle: 0x%04x\n", lbs_client_ctx.led_value_handle);
-	} else printk("LED char not found\n");
-	chrc = bt_gatt_dm_char_by_uuid(dm, BT_UUID_LBS_BUTTON);
-	if (chrc) {
-		val = bt_gatt_dm_attr_next(dm, chrc);
-		lbs_client_ctx.button_value_handle = val ? val->handle : (chrc->handle + 1);
-		printk("Button char handle: 0x%04x\n", lbs_client_ctx.button_value_handle);
-		desc = bt_gatt_dm_desc_by_uuid(dm, chrc, BT_UUID_GATT_CCC);
-		if (desc) {
-			lbs_client_ctx.button_ccc_handle = desc->handle;
-			memset(&lbs_client_ctx.sub_params,0,sizeof(lbs_client_ctx.sub_params));
-			lbs_client_ctx.sub_params.notify = lbs_button_notify_cb;
-			lbs_client_ctx.sub_params.value = BT_GATT_CCC_NOTIFY;
-			lbs_client_ctx.sub_params.ccc_handle = desc->handle;
-			lbs_client_ctx.sub_params.value_handle = lbs_client_ctx.button_value_handle;
-			atomic_set_bit(lbs_client_ctx.sub_params.flags, BT_GATT_SUBSCRIBE_FLAG_VOLATILE);
-			err = bt_gatt_subscribe(central_ring.conn, &lbs_client_ctx.sub_params);
-			if (!err) { atomic_set(&lbs_client_ctx.subscribed,1); central_ring.lbs_ready=true; printk("Subscribed to button\n"); }
-			else printk("Button subscribe failed: %d\n", err);
-		} else printk("Button CCC not found\n");
-	} else printk("Button char not found\n");
-	bt_gatt_dm_data_release(dm);
 }
-static void discovery_not_found_lbs_cb(struct bt_conn *conn, void *context) { printk("LBS not found\n"); }
-static void discovery_error_found_lbs_cb(struct bt_conn *conn, int err, void *context) { printk("LBS discovery error: %d\n", err); }
-static const struct bt_gatt_dm_cb discovery_cb_lbs = {
-	.completed        = discovery_completed_lbs_cb,
-	.service_not_found= discovery_not_found_lbs_cb,
-	.error_found      = discovery_error_found_lbs_cb,
-};
 
 /////////////////////////////////////////////////////////////////
 // ==== 4. 按钮管理模块 ========================================
@@ -229,277 +166,105 @@ static void button_changed(uint32_t button_state, uint32_t has_changed) {
 		if (now - last_button_time < DEBOUNCE_MS) return;
 		last_button_time = now;
 		bool pressed = button_state & USER_BUTTON;
-		printk("Button %s\n", pressed ? "PRESSED" : "RELEASED");
+		LOG_INF("Button %s", pressed ? "PRESSED" : "RELEASED");
 		atomic_set(&app_button_state, pressed);
 
 		int err = bt_lbs_send_button_state(pressed);
-		if (err) printk("Failed to send button state: %d\n", err);
+		if (err) LOG_INF("Failed to send button state: %d", err);
+		presence_set_button(pressed);
+		history_touch(pressed, false);
 
 		if (pressed)
 			led_set_state_locked(LED_STATE_ON, pressed);
 		else
 			led_set_state_locked(LED_STATE_OFF, pressed);
 
-		if (central_ring.conn && central_ring.lbs_ready &&
-		    lbs_client_ctx.led_value_handle &&
-		    !atomic_get(&lbs_client_ctx.write_pending)) {
-			lbs_client_ctx.write_buf[0] = pressed ? 1 : 0;
-			lbs_client_ctx.write_params.handle = lbs_client_ctx.led_value_handle;
-			lbs_client_ctx.write_params.offset = 0;
-			lbs_client_ctx.write_params.data = lbs_client_ctx.write_buf;
-			lbs_client_ctx.write_params.length = 1;
-			lbs_client_ctx.write_params.func = lbs_write_cb;
-			atomic_set(&lbs_client_ctx.write_pending, 1);
-			err = bt_gatt_write(central_ring.conn, &lbs_client_ctx.write_params);
-			if (err) {
-				atomic_set(&lbs_client_ctx.write_pending, 0);
-				printk("Failed to write LED state: %d\n", err);
-			} else {
-				printk("Sending touch to partner\n");
-			}
-		}
+		err = ring_client_led_write(pressed);
+		if (!err)
+			LOG_INF("Sending touch to partner");
+		else if (err != -EAGAIN)
+			LOG_INF("Failed to write LED state: %d", err);
 	}
 }
 static int init_button(void) {
 	int err = dk_buttons_init(button_changed);
 	if (err)
-		printk("Button init failed: %d\n", err);
+		LOG_ERR("Button init failed: %d", err);
 	return err;
 }
 
 /////////////////////////////////////////////////////////////////
 // ==== 5. RSSI与距离估算工具 & 公共工具模块 ====================
 /////////////////////////////////////////////////////////////////
-// 基于官方 hci_pwr_ctrl 示例的真实硬件 RSSI 读取
-
-// RSSI 滤波器初始化
-static void rssi_filter_init(struct rssi_filter *filter) {
-    memset(filter, 0, sizeof(*filter));
-}
-
-// 添加 RSSI 值到滤波器
-static void rssi_filter_add(struct rssi_filter *filter, int8_t rssi) {
-    filter->history[filter->index] = rssi;
-    filter->index = (filter->index + 1) % RSSI_HISTORY_SIZE;
-    if (!filter->full && filter->index == 0) {
-        filter->full = true;
-    }
-}
-
-// 获取滤波后的平均 RSSI
-static int8_t rssi_filter_get_average(struct rssi_filter *filter) {
-    if (!filter->full && filter->index == 0) {
-        return -70; // 默认值
-    }
-    
-    int32_t sum = 0;
-    uint8_t count = filter->full ? RSSI_HISTORY_SIZE : filter->index;
-    
-    for (uint8_t i = 0; i < count; i++) {
-        sum += filter->history[i];
-    }
-    
-    return (int8_t)(sum / count);
-}
-
-// 基于 RSSI 估算距离等级
-static distance_level_t estimate_distance(int8_t rssi) {
-    if (rssi >= RSSI_VERY_CLOSE_THRESHOLD) {
-        return DISTANCE_VERY_CLOSE;
-    } else if (rssi >= RSSI_CLOSE_THRESHOLD) {
-        return DISTANCE_CLOSE;
-    } else if (rssi >= RSSI_MEDIUM_THRESHOLD) {
-        return DISTANCE_MEDIUM;
-    } else if (rssi >= RSSI_FAR_THRESHOLD) {
-        return DISTANCE_FAR;
-    } else {
-        return DISTANCE_VERY_FAR;
-    }
-}
-
-// 真实硬件 RSSI 读取函数（基于官方 hci_pwr_ctrl 实现，修复编译问题）
-static void read_conn_rssi(uint16_t handle, int8_t *rssi)
-{
-    struct net_buf *buf, *rsp = NULL;
-    struct bt_hci_cp_read_rssi *cp;
-    struct bt_hci_rp_read_rssi *rp;
-    int err;
-
-    *rssi = -127; // 默认错误值
-
-    // 尝试使用弃用但仍可用的 API
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-    buf = bt_hci_cmd_create(BT_HCI_OP_READ_RSSI, sizeof(*cp));
-    #pragma GCC diagnostic pop
-    
-    if (!buf) {
-        printk("Unable to allocate RSSI command buffer\n");
-        return;
-    }
-
-    cp = net_buf_add(buf, sizeof(*cp));
-    // 直接赋值，nRF54L15 是小端系统
-    cp->handle = handle;
-
-    err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_RSSI, buf, &rsp);
-    if (err) {
-        uint8_t reason = rsp ?
-            ((struct bt_hci_rp_read_rssi *)rsp->data)->status : 0;
-        printk("Read RSSI err: %d reason 0x%02x\n", err, reason);
-        if (rsp) {
-            net_buf_unref(rsp);
-        }
-        return;
-    }
-
-    if (rsp && rsp->len >= sizeof(*rp)) {
-        rp = (void *)rsp->data;
-        if (rp->status == 0) {
-            *rssi = rp->rssi;
-        } else {
-            printk("RSSI read status error: 0x%02x\n", rp->status);
-        }
-        net_buf_unref(rsp);
-    }
-}
-
-// 获取真实连接 RSSI - 使用官方方法
-static int8_t get_real_rssi(struct bt_conn *conn) {
-    if (!conn) {
-        return -127; // 无效连接
-    }
-    
-    // 检查连接状态
-    struct bt_conn_info info;
-    int err = bt_conn_get_info(conn, &info);
-    if (err || info.state != BT_CONN_STATE_CONNECTED) {
-        return -127; // 连接无效或未连接
-    }
-    
-    // 获取连接句柄
-    uint16_t conn_handle;
-    err = bt_hci_get_conn_handle(conn, &conn_handle);
-    if (err) {
-        printk("Failed to get connection handle: %d\n", err);
-        return -127;
-    }
-    
-    // 读取真实的硬件 RSSI
-    int8_t rssi = -127;
-    read_conn_rssi(conn_handle, &rssi);
-    
-    // 如果读取失败，使用备用估算
-    if (rssi == -127 || rssi == 0xFF) {
-        // 基于连接参数的备用估算
-        uint16_t interval = info.le.interval;
-        
-        if (interval <= 15) {
-            rssi = -35;
-        } else if (interval <= 30) {
-            rssi = -45;
-        } else if (interval <= 60) {
-            rssi = -60;
-        } else if (interval <= 120) {
-            rssi = -75;
-        } else {
-            rssi = -85;
-        }
-        
-        // 添加少量随机变化
-        static uint32_t counter = 0;
-        counter++;
-        int8_t variation = (counter % 6) - 3;
-        rssi += variation;
-        
-        printk("Using estimated RSSI: %d (interval: %d)\n", rssi, interval);
-    } else {
-        printk("Hardware RSSI: %d dBm\n", rssi);
-    }
-    
-    return rssi;
-}
+// RSSI 读取与距离更新见 link_stats.c（系统工作队列上读取，结果在事件循环中发布）
+// RSSI 滤波见 rssi_filter.c，距离估算见 ring_analytics.c
 
 /////////////////////////////////////////////////////////////////
-// ==== 6. HRS 客户端 ==========================================
+// ==== 6. 对方心率接收（HRS 客户端见 ring_client.c） ===========
 /////////////////////////////////////////////////////////////////
 
-static struct bt_hrs_client hrs_c;
-K_MSGQ_DEFINE(hrs_queue, sizeof(struct bt_hrs_client_measurement), HRS_QUEUE_SIZE, 4);
-
-static void analyze_heart_rate(uint16_t hr_value, uint16_t partner_hr) {
-	if (hr_value > HR_HIGH_THRESHOLD) {
-		printk("⚠️ High HR: %d\n", hr_value);
-		led_set_state_locked(LED_STATE_BREATHING, false);
-	} else if (hr_value < HR_LOW_THRESHOLD) {
-		printk("💤 Low HR: %d\n", hr_value);
-	} else {
-		printk("💓 Normal HR: %d\n", hr_value);
+// RX 回调只负责入队，分析和转发全部在应用事件循环的 hr_relay_work 中完成
+static struct hr_ring hr_ring;
+static struct k_work hr_relay_work;
+static struct {
+	atomic_t rx_errors;
+	uint32_t rx_count;          // 以下字段仅由 RX 回调写
+	uint32_t rx_cycles_total;
+	uint32_t rx_cycles_max;
+} hr_rx_stats;
+
+// 同步与心率告警只在状态变化时驱动 LED
+static struct hr_sync hr_sync;
+// 心率告警只看对方的心率：戒指提醒佩戴者对方心率异常
+static hr_level_t partner_hr_level = HR_LEVEL_NORMAL;
+
+static void handle_heart_rate(uint16_t own_hr, uint16_t partner_hr) {
+	hr_level_t level = hr_level_update(partner_hr_level, partner_hr);
+	uint8_t ev = hr_sync_update(&hr_sync, ring_tune_get(), own_hr, partner_hr);
+	if (level != partner_hr_level) {
+		partner_hr_level = level;
+		if (level == HR_LEVEL_HIGH) {
+			LOG_INF("⚠️ High partner HR: %d", partner_hr);
+			led_set_state_locked(LED_STATE_BREATHING, false);
+		} else if (level == HR_LEVEL_LOW) {
+			LOG_INF("💤 Low partner HR: %d", partner_hr);
+		} else {
+			LOG_INF("💓 Partner HR back to normal: %d", partner_hr);
+			if (led_manager.state == LED_STATE_BREATHING && !led_manager.user_controlled)
+				led_set_state_locked(LED_STATE_OFF, false);
+		}
 	}
-	if (partner_hr > 0 && abs((int)hr_value-(int)partner_hr)<HR_SYNC_THRESHOLD) {
-		printk("💕 Synchronized! (diff: %d)\n", abs(hr_value-partner_hr));
+	if (ev & HR_SYNC_EV_SYNC_ON) {
+		LOG_INF("💕 Synchronized! (coherence %u%%, lag %d)",
+			hr_sync.coherence * 100 >> 15, hr_sync.lag);
 		led_set_state_locked(LED_STATE_FLASHING, false);
 	}
+	if (ev & HR_SYNC_EV_SYNC_OFF)
+		LOG_INF("Sync lost (coherence %u%%)", hr_sync.coherence * 100 >> 15);
 }
-static void hrs_sensor_location_read_cb(struct bt_hrs_client *hrs_c,
-					enum bt_hrs_client_sensor_location location, int err)
-{
-	if (!err && location < ARRAY_SIZE(sensor_location_str))
-		printk("HRS location: %s\n", sensor_location_str[location]);
-	else
-		printk("HRS location read failed: %d\n", err);
-}
-static void hrs_measurement_notify_cb(struct bt_hrs_client *hrs_c,
-				      const struct bt_hrs_client_measurement *meas, int err)
-{
-	if (err) { printk("HRS notify err: %d\n", err); return; }
-	if (!meas || meas->hr_value==0) { printk("Invalid HR\n"); return; }
-	printk("Partner HR: %d bpm\n", meas->hr_value);
-	central_ring.last_hr_value = meas->hr_value;
-	analyze_heart_rate(meas->hr_value, peripheral_ring.last_hr_value);
-	if (k_msgq_put(&hrs_queue, meas, K_NO_WAIT))
-		printk("HR queue full, drop\n");
-}
-static void discovery_completed_cb(struct bt_gatt_dm *dm, void *context)
+static void partner_hr_received(const struct hr_sample *sample)
 {
-	int err;
-	if (!dm) { printk("HRS discovery NULL\n"); return; }
-	printk("HRS discovered\n");
-	bt_gatt_dm_data_print(dm);
-	err = bt_hrs_client_handles_assign(dm, &hrs_c);
-	if (err) { printk("HRS handles assign fail: %d\n", err); bt_gatt_dm_data_release(dm); return; }
-	err = bt_hrs_client_sensor_location_read(&hrs_c, hrs_sensor_location_read_cb);
-	if (err) printk("HRS location read: %d\n", err);
-	err = bt_hrs_client_measurement_subscribe(&hrs_c, hrs_measurement_notify_cb);
-	if (!err) { central_ring.hrs_ready = true; printk("Subscribed HR\n"); }
-	else printk("HRS measurement subscribe failed: %d\n", err);
-	bt_gatt_dm_data_release(dm);
-	// 下一步发现LBS
-	printk("Starting LBS discovery...\n");
-	err = bt_gatt_dm_start(central_ring.conn, BT_UUID_LBS, &discovery_cb_lbs, NULL);
-	if (err) printk("LBS discovery start failed: %d\n", err);
-}
-static void discovery_not_found_cb(struct bt_conn *conn, void *context) { printk("HRS not found\n"); }
-static void discovery_error_found_cb(struct bt_conn *conn, int err, void *context) { printk("HRS discovery error: %d\n", err); }
-static const struct bt_gatt_dm_cb discovery_cb = {
-	.completed        = discovery_completed_cb,
-	.service_not_found= discovery_not_found_cb,
-	.error_found      = discovery_error_found_cb
+	uint32_t start = k_cycle_get_32();
+	if (!sample) { atomic_inc(&hr_rx_stats.rx_errors); return; }
+	if (hr_ring_push(&hr_ring, sample))
+		app_loop_submit(&hr_relay_work);
+	uint32_t cycles = k_cycle_get_32() - start;
+	hr_rx_stats.rx_count++;
+	hr_rx_stats.rx_cycles_total += cycles;
+	if (cycles > hr_rx_stats.rx_cycles_max) hr_rx_stats.rx_cycles_max = cycles;
+}
+static const struct ring_client_cb ring_client_callbacks = {
+	.hr_received = partner_hr_received,
+	.button_changed = partner_button_changed,
 };
-static void gatt_discover(struct bt_conn *conn) {
-	if (!conn) { printk("Cannot start GATT: NULL\n"); return; }
-	printk("Starting GATT discovery...\n");
-	int err = bt_gatt_dm_start(conn, BT_UUID_HRS, &discovery_cb, NULL);
-	if (err) printk("GATT start failed: %d\n", err);
-}
-
 /////////////////////////////////////////////////////////////////
 // ==== 7. LBS 服务端 ==========================================
 /////////////////////////////////////////////////////////////////
 
 static void app_led_cb(bool led_state) {
+	history_touch(led_state, true);
 	if (led_state) {
-		printk("💕 Remote touch via LED\n");
+		LOG_INF("💕 Remote touch via LED");
 		led_set_state_locked(LED_STATE_ON, led_state);
 	} else {
 		led_set_state_locked(LED_STATE_OFF, led_state);
@@ -509,71 +274,37 @@ static bool app_button_cb(void) { return atomic_get(&app_button_state); }
 static struct bt_lbs_cb lbs_callbacks = { .led_cb=app_led_cb, .button_cb=app_button_cb };
 
 /////////////////////////////////////////////////////////////////
-// ==== 8. 扫描与连接管理 ======================================
+// ==== 8. 连接管理（广播、扫描与重连见 reconnect.c） ============
 /////////////////////////////////////////////////////////////////
-static struct bt_data ad[] = {
-	BT_DATA_BYTES(BT_DATA_GAP_APPEARANCE,
-		(CONFIG_BT_DEVICE_APPEARANCE >> 0) & 0xff,
-		(CONFIG_BT_DEVICE_APPEARANCE >> 8) & 0xff),
-	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
-	BT_DATA_BYTES(BT_DATA_UUID16_ALL, BT_UUID_16_ENCODE(BT_UUID_HRS_VAL)),
-};
-static struct bt_data sd[] = {
-	BT_DATA_BYTES(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME),
-	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_LBS_VAL),
-};
-static struct k_work adv_work;
-// static struct k_work_delayable rssi_work;
-static struct k_work_delayable reconnect_work;
-
-static int scan_start(void) {
-	if (!atomic_get(&system_ready)) { printk("System not ready for scan\n"); return -ENODEV; }
-	int err = bt_scan_start(BT_SCAN_TYPE_SCAN_PASSIVE);
-	if (!err) printk("Scanning started...\n");
-	else printk("Scan start failed: %d\n", err);
-	return err;
-}
-static void adv_work_handler(struct k_work *work) {
-	if (!atomic_get(&system_ready)) { printk("System not ready for adv\n"); return; }
-	int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_2, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
-	if (!err) printk("Advertising started...\n");
-	else { printk("Advertising start failed: %d\n", err); k_work_schedule(&reconnect_work, K_SECONDS(5)); }
-}
-static void advertising_start(void) { k_work_submit(&adv_work); }
-static void reconnect_work_handler(struct k_work *work) {
-    static bool last_role_was_central = false;
-    printk("Restart adv & scan...\n");
-    if (!last_role_was_central) {
-        // 先试做central（scan），一会儿再试做peripheral（adv），防止死锁
-        scan_start();
-        k_work_schedule(&reconnect_work, K_MSEC(1500)); // 1.5s后自动切
-        last_role_was_central = true;
-    } else {
-        advertising_start();
-        k_work_schedule(&reconnect_work, K_MSEC(1500));
-        last_role_was_central = false;
-    }
-}
+static struct k_work_delayable status_work;
+static struct k_work_delayable run_led_work;
+
 static void connected(struct bt_conn *conn, uint8_t conn_err)
 {
-	on_connection_established(conn);
     struct bt_conn_info info;
     char addr[BT_ADDR_LE_STR_LEN];
     bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
+    if (conn_err == BT_HCI_ERR_ADV_TIMEOUT) {
+        // 高占空比定向广播到时，由 reconnect 进入下一阶段
+        LOG_DBG("Directed advertising timed out");
+        return;
+    }
     if (conn_err) {
-        printk("Conn failed: %s, err: 0x%02x\n", addr, conn_err);
+        LOG_WRN("Conn failed: %s, err: 0x%02x", addr, conn_err);
         if (conn==central_ring.conn) {
             bt_conn_unref(central_ring.conn); memset(&central_ring,0,sizeof(central_ring));
-            rssi_filter_init(&central_ring.rssi_filter);
-            k_work_schedule(&reconnect_work, K_SECONDS(2));
+            link_stats_reset(&central_ring);
+            reconnect_start();
         }
         return;
     }
     if (bt_conn_get_info(conn, &info)) {
-        printk("Conn info err\n"); return;
+        LOG_WRN("Conn info err"); return;
     }
+	on_connection_established(conn);
 
     // ===== 检查是否和同一个设备双连接，若是则断开新连接 =====
+    // reconnect 按身份地址选举角色后正常不会出现，这里只作为兜底
     const bt_addr_le_t *new_addr = bt_conn_get_dst(conn);
     const bt_addr_le_t *other_addr = NULL;
     if (info.role == BT_CONN_ROLE_CENTRAL && peripheral_ring.conn) {
@@ -581,7 +312,7 @@ static void connected(struct bt_conn *conn, uint8_t conn_err)
         // 如果已经作为peripheral连了同一个设备，则断掉现在新建立的central连接
         if (!bt_addr_le_cmp(new_addr, other_addr)) {
             // 同设备双连，断掉本次连接（你也可以选择断掉另一条conn）
-            printk("Duplicate conn (CENTRAL/PERIPHERAL to same peer)! Disconnecting new conn (%s)\n", addr);
+            LOG_WRN("Duplicate conn (CENTRAL/PERIPHERAL to same peer)! Disconnecting new conn (%s)", addr);
             bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
             return;
         }
@@ -590,7 +321,7 @@ static void connected(struct bt_conn *conn, uint8_t conn_err)
         other_addr = bt_conn_get_dst(central_ring.conn);
         // 如果已经作为central连了同一个设备，则断掉现在新建立的peripheral连接
         if (!bt_addr_le_cmp(new_addr, other_addr)) {
-            printk("Duplicate conn (PERIPHERAL/CENTRAL to same peer)! Disconnecting new conn (%s)\n", addr);
+            LOG_WRN("Duplicate conn (PERIPHERAL/CENTRAL to same peer)! Disconnecting new conn (%s)", addr);
             bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
             return;
         }
@@ -599,31 +330,26 @@ static void connected(struct bt_conn *conn, uint8_t conn_err)
     // ===== 一旦有一条连接即关闭另一角色的广播/扫描，防止再被连/再去连 =====
     if (info.role == BT_CONN_ROLE_CENTRAL) {
         // 现在我作为central连接上别人，关闭自身“可被连”状态
-        bt_le_adv_stop(); // 关闭advertising，不接受对方再连我（做peripheral）
-        bt_scan_stop();   //（理论上作为central只需停adv即可，这里防止混乱，也停scan）
-        printk("As CENTRAL\n");
-        dk_set_led_on(CENTRAL_CON_STATUS_LED);
-        central_ring.conn = bt_conn_ref(conn);
-        central_ring.current_rssi = -50;
-        central_ring.distance = estimate_distance(-50);
+        reconnect_stop();
+        LOG_INF("As CENTRAL");
+        ring_led_set(CENTRAL_CON_STATUS_LED, true);
+        // 经扫描建连时 scan_connecting 已持有引用，接受列表自动建连时在此获取
+        if (central_ring.conn != conn)
+            central_ring.conn = bt_conn_ref(conn);
         central_ring.connection_time = k_uptime_get_32();
-        rssi_filter_init(&central_ring.rssi_filter);
-        printk("Initial dist: %s\n", distance_str[central_ring.distance]);
+        link_stats_reset(&central_ring);
         int err = bt_conn_set_security(conn, BT_SECURITY_L2);
-        if (err) printk("Set security fail: %d\n", err);
-        gatt_discover(conn);
+        if (err) LOG_WRN("Set security fail: %d", err);
+        ring_client_start(conn);
         // k_work_schedule(&rssi_work, K_MSEC(RSSI_UPDATE_INTERVAL));
     } else if (info.role == BT_CONN_ROLE_PERIPHERAL) {
         // 我作为peripheral被对方连上，关闭“主动去连别人的”能力
-        bt_scan_stop(); // 关闭scan，不主动去连对方（做central）
-        bt_le_adv_stop();// 可选，加保险
-        printk("As PERIPHERAL\n");
-        dk_set_led_on(PERIPHERAL_CONN_STATUS_LED);
+        reconnect_stop();
+        LOG_INF("As PERIPHERAL");
+        ring_led_set(PERIPHERAL_CONN_STATUS_LED, true);
         peripheral_ring.conn = bt_conn_ref(conn);
-        peripheral_ring.current_rssi = -45;
-        peripheral_ring.distance = estimate_distance(-45);
         peripheral_ring.connection_time = k_uptime_get_32();
-        rssi_filter_init(&peripheral_ring.rssi_filter);
+        link_stats_reset(&peripheral_ring);
         // k_work_schedule(&rssi_work, K_MSEC(RSSI_UPDATE_INTERVAL));
     }
 }
@@ -632,40 +358,34 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 	on_connection_lost();
     char addr[BT_ADDR_LE_STR_LEN]; 
     bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
-    printk("Disconnected: %s, reason: 0x%02x\n", addr, reason);
+    LOG_INF("Disconnected: %s, reason: 0x%02x", addr, reason);
     if (conn == central_ring.conn) {
-        printk("Central conn lost\n");
-        dk_set_led_off(CENTRAL_CON_STATUS_LED);
-        if (atomic_get(&lbs_client_ctx.subscribed)) atomic_set(&lbs_client_ctx.subscribed, 0);
-        atomic_set(&lbs_client_ctx.write_pending, 0);
+        LOG_INF("Central conn lost");
+        ring_led_set(CENTRAL_CON_STATUS_LED, false);
         bt_conn_unref(central_ring.conn); memset(&central_ring,0,sizeof(central_ring));
-        rssi_filter_init(&central_ring.rssi_filter);
+        link_stats_reset(&central_ring);
         led_set_state_locked(LED_STATE_OFF, false);
-        // 重新恢复adv和scan
-        k_work_schedule(&reconnect_work, K_SECONDS(1));
+        // 重新寻找对方，意外断线时先快速重连
+        reconnect_link_lost(reason);
     } else if (conn == peripheral_ring.conn) {
-        printk("Peripheral conn lost\n"); 
-        dk_set_led_off(PERIPHERAL_CONN_STATUS_LED);
+        LOG_INF("Peripheral conn lost"); 
+        ring_led_set(PERIPHERAL_CONN_STATUS_LED, false);
         bt_conn_unref(peripheral_ring.conn); memset(&peripheral_ring,0,sizeof(peripheral_ring));
-        rssi_filter_init(&peripheral_ring.rssi_filter);
-        // 重新恢复adv和scan
-        k_work_schedule(&reconnect_work, K_SECONDS(1));
+        link_stats_reset(&peripheral_ring);
+        // 重新寻找对方，意外断线时先快速重连
+        reconnect_link_lost(reason);
     }
-    if (!central_ring.conn && !peripheral_ring.conn)
-        memset(&lbs_client_ctx,0,sizeof(lbs_client_ctx));
 }
 static void security_changed(struct bt_conn *conn, bt_security_t level, enum bt_security_err err)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
-	if (err) printk("Security failed: %s, level:%u, err:%d\n", addr, level, err);
-	else {
-		printk("Security changed: %s, level:%u\n", addr, level);
-		if (conn==central_ring.conn && level>=BT_SECURITY_L2)
-			gatt_discover(conn);
-	}
+	if (err) LOG_WRN("Security failed: %s, level:%u, err:%d", addr, level, err);
+	else LOG_INF("Security changed: %s, level:%u", addr, level);
+}
+static void recycled_cb(void) {
+	if (!central_ring.conn && !peripheral_ring.conn) { LOG_DBG("Conn recycled"); reconnect_start(); }
 }
-static void recycled_cb(void) { printk("Conn recycled, restart adv\n"); advertising_start(); }
 BT_CONN_CB_DEFINE(conn_callbacks) = {
 	.connected = connected,
 	.disconnected = disconnected,
@@ -676,20 +396,20 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 static void auth_cancel(struct bt_conn *conn) {
 	char addr[BT_ADDR_LE_STR_LEN];
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
-	printk("Pairing cancelled: %s\n", addr);
+	LOG_WRN("Pairing cancelled: %s", addr);
 }
 static void pairing_complete(struct bt_conn *conn, bool bonded) {
 	char addr[BT_ADDR_LE_STR_LEN];
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
-	printk("Pairing completed: %s, bonded: %s\n", addr, bonded?"yes":"no");
+	LOG_INF("Pairing completed: %s, bonded: %s", addr, bonded?"yes":"no");
 }
 static void pairing_failed(struct bt_conn *conn, enum bt_security_err reason) {
 	char addr[BT_ADDR_LE_STR_LEN];
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
-	printk("Pairing failed: %s, reason: %d\n", addr, reason);
+	LOG_WRN("Pairing failed: %s, reason: %d", addr, reason);
 }
 static void pairing_confirm(struct bt_conn *conn) {
-	printk("Pairing confirm requested\n");
+	LOG_INF("Pairing confirm requested");
 	bt_conn_auth_pairing_confirm(conn);
 }
 static struct bt_conn_auth_cb auth_callbacks = {
@@ -700,129 +420,195 @@ static struct bt_conn_auth_info_cb conn_auth_info_callbacks = {
 	.pairing_complete = pairing_complete,
 	.pairing_failed   = pairing_failed,
 };
-static void scan_filter_match(struct bt_scan_device_info *device_info,
-			     struct bt_scan_filter_match *filter_match, bool connectable)
-{
-	char addr[BT_ADDR_LE_STR_LEN];
-	if (!device_info || !device_info->recv_info) return;
-	bt_addr_le_to_str(device_info->recv_info->addr, addr, sizeof(addr));
-	printk("Device found: %s, connectable: %s, RSSI: %d\n", addr, connectable?"yes":"no", device_info->recv_info->rssi);
-}
-static void scan_connecting_error(struct bt_scan_device_info *device_info) {
-	printk("Conn attempt failed\n"); k_work_schedule(&reconnect_work, K_SECONDS(2));
-}
-static void scan_connecting(struct bt_scan_device_info *device_info, struct bt_conn *conn) {
-	if (conn) { central_ring.conn = bt_conn_ref(conn); printk("Conn initiated\n"); }
-}
-BT_SCAN_CB_INIT(scan_cb, scan_filter_match, NULL, scan_connecting_error, scan_connecting);
-static int scan_init(void) {
-	struct bt_scan_init_param param = { .scan_param=NULL, .conn_param=BT_LE_CONN_PARAM_DEFAULT, .connect_if_match=1 };
-	bt_scan_init(&param); bt_scan_cb_register(&scan_cb);
-	int err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, BT_UUID_HRS);
-	if (err) { printk("Scan filter add failed: %d\n", err); return err; }
-	bt_scan_filter_enable(BT_SCAN_UUID_FILTER, false);
-	return 0;
-}
-void rssi_update_internal(void)
-{
-    bool updated = false;
-    if (central_ring.conn) {
-        struct bt_conn_info info;
-        if (!bt_conn_get_info(central_ring.conn, &info) && info.state == BT_CONN_STATE_CONNECTED) {
-            int8_t new_rssi = get_real_rssi(central_ring.conn);
-            rssi_filter_add(&central_ring.rssi_filter, new_rssi);
-            int8_t filtered_rssi = rssi_filter_get_average(&central_ring.rssi_filter);
-            distance_level_t new_distance = estimate_distance(filtered_rssi);
-            if (new_distance != central_ring.distance || abs(filtered_rssi-central_ring.current_rssi)>3) {
-                printk("Central Ring - RSSI %d, %s->%s\n", filtered_rssi, distance_str[central_ring.distance], distance_str[new_distance]);
-                central_ring.current_rssi = filtered_rssi;
-                central_ring.distance = new_distance;
-            }
-            updated = true;
-        }
-    }
-    if (peripheral_ring.conn) {
-        struct bt_conn_info info;
-        if (!bt_conn_get_info(peripheral_ring.conn, &info) && info.state == BT_CONN_STATE_CONNECTED) {
-            int8_t new_rssi = get_real_rssi(peripheral_ring.conn)+5;
-            rssi_filter_add(&peripheral_ring.rssi_filter, new_rssi);
-            int8_t filtered_rssi = rssi_filter_get_average(&peripheral_ring.rssi_filter);
-            distance_level_t new_distance = estimate_distance(filtered_rssi);
-            if (new_distance != peripheral_ring.distance || abs(filtered_rssi-peripheral_ring.current_rssi)>3) {
-                printk("Peripheral Ring - RSSI %d, %s->%s\n", filtered_rssi, distance_str[peripheral_ring.distance], distance_str[new_distance]);
-                peripheral_ring.current_rssi = filtered_rssi;
-                peripheral_ring.distance = new_distance;
-            }
-            updated = true;
-        }
-    }
-}
-
 /////////////////////////////////////////////////////////////////
 // ==== 9. 多线程功能块 ========================================
 /////////////////////////////////////////////////////////////////
 
-static void hrs_notify_thread(void) {
-	struct bt_hrs_client_measurement meas;
-	while (1) {
-		int ret = k_msgq_get(&hrs_queue, &meas, K_FOREVER);
-		if (ret) { printk("HR queue get fail: %d\n", ret); continue; }
-		if (meas.hr_value==0 || meas.hr_value>250) { printk("Invalid HR: %d\n", meas.hr_value); continue; }
-		ret = bt_hrs_notify(meas.hr_value);
-		if (ret) printk("HR notify fail: %d\n", ret);
-		else printk("Relayed HR: %d bpm\n", meas.hr_value);
-		if (peripheral_ring.conn && peripheral_ring.last_hr_value>0) {
-			int diff = abs((int)meas.hr_value - (int)peripheral_ring.last_hr_value);
-			if (diff < HR_SYNC_THRESHOLD) {
-				printk("💓 Synchronized! (diff: %d)\n", diff);
-				led_set_state_locked(LED_STATE_BREATHING, false);
-			} else if (diff > 50) {
-				printk("⚡ High HR diff: %d bpm\n", diff);
-			}
-		}
+// 对方 RR 间期的 HRV，在事件循环中逐拍更新；通知间隔超过 HRV_GAP_MS 视为中断
+#define HRV_GAP_MS 5000
+static struct hrv hrv;
+static struct {
+	uint32_t last_ms;
+	uint32_t cycles_max;   // 单个样本的 HRV 处理耗时峰值
+} hrv_stats;
+
+static void hrv_process_sample(const struct hr_sample *sample) {
+	uint32_t start = k_cycle_get_32();
+	uint8_t rr_count = MIN(sample->rr_count, HR_SAMPLE_RR_MAX);
+	if (hrv_stats.last_ms && sample->timestamp - hrv_stats.last_ms > HRV_GAP_MS)
+		hrv_break(&hrv);
+	hrv_stats.last_ms = sample->timestamp;
+	for (uint8_t i = 0; i < rr_count; i++)
+		hrv_add_rr(&hrv, sample->rr[i]);
+	history_hrv(&hrv);
+	hrv_stats.cycles_max = MAX(hrv_stats.cycles_max, k_cycle_get_32() - start);
+}
+
+// 本端 PPG 的心率（ppg.c，事件循环中）：本机 HRS 通知、在场广播，
+// 同时作为同步分析中与对方配对的本端序列
+static bool own_hr_source;   // 本端传感器已启动
+
+static void own_hr_sample(const struct hr_sample *sample) {
+	peripheral_ring.last_hr_value = sample->hr;
+	presence_set_hr(sample->hr);
+	if (!sample->hr) { LOG_INF("Own HR lost"); return; }
+	int ret = bt_hrs_notify(sample->hr);
+	if (ret) LOG_WRN("HR notify fail: %d", ret);
+	else LOG_DBG("Own HR: %d bpm, %u beats", sample->hr, sample->rr_count);
+}
+static void hrs_process_sample(const struct hr_sample *sample) {
+	if (sample->hr>250) { LOG_WRN("Invalid HR: %d", sample->hr); return; }
+	LOG_DBG("Partner HR: %d bpm", sample->hr);
+	central_ring.last_hr_value = sample->hr;
+	// 本端序列为自己的心率（本端传感器），没有传感器时为 0，不做同步分析
+	handle_heart_rate(peripheral_ring.last_hr_value, sample->hr);
+	// 有本端传感器时 HRS 和在场广播发布自己的心率（own_hr_sample），否则转发对方的
+	if (!own_hr_source) {
+		int ret = bt_hrs_notify(sample->hr);
+		if (ret) LOG_WRN("HR notify fail: %d", ret);
+		else LOG_DBG("Relayed HR: %d bpm", sample->hr);
+		// 在场广播与 HRS 通知的值一致
+		presence_set_hr(sample->hr);
 	}
+	history_hr(sample);
+	hrv_process_sample(sample);
+}
+// 一次取空环形缓冲；运行期间新入队的样本会让工作项再次提交
+static void hr_relay_work_handler(struct k_work *work) {
+	struct hr_sample sample;
+	while (hr_ring_pop(&hr_ring, &sample))
+		hrs_process_sample(&sample);
 }
-static void status_monitor_thread(void) {
-	while (1) {
-		k_sleep(K_MSEC(10000));
-		if (!atomic_get(&system_ready)) continue;
-		printk("\n=== SMART RING STATUS ===\n");
-		print_power_statistics();
-		printk("Battery: %d%%, Power mode: %d\n", get_battery_level(), get_current_power_mode());
-		printk("Uptime: %u s\n", k_uptime_get_32()/1000);
-		if (central_ring.conn) {
-			uint32_t conn_time = (k_uptime_get_32()-central_ring.connection_time)/1000;
-			printk("CENTRAL: Connected (%u sec)\n", conn_time);
-			printk("RSSI: %d, Distance: %s\n", central_ring.current_rssi, distance_str[central_ring.distance]);
-			printk("Services: HRS %s, LBS %s\n", central_ring.hrs_ready?"Ready":"Not Ready",central_ring.lbs_ready?"Ready":"Not Ready");
-			if (central_ring.last_hr_value>0) printk("Last HR: %d\n",central_ring.last_hr_value);
-		} else printk("CENTRAL: Disconnected\n");
-		if (peripheral_ring.conn) {
-			uint32_t conn_time = (k_uptime_get_32()-peripheral_ring.connection_time)/1000;
-			printk("PERIPHERAL: Connected (%u sec)\n", conn_time);
-			printk("RSSI: %d, Distance: %s\n", peripheral_ring.current_rssi, distance_str[peripheral_ring.distance]);
-			if (peripheral_ring.last_hr_value>0) printk("Last HR: %d\n",peripheral_ring.last_hr_value);
-		} else printk("PERIPHERAL: Disconnected\n");
-		printk("UI: Button: %s\n", atomic_get(&app_button_state)?"PRESSED":"RELEASED");
-		printk("LED State: %d, Flash Active: %s\n", led_manager.state, atomic_get(&led_manager.flash_active)?"YES":"NO");
-		printk("QUEUES: HR Queue: %d/%d\n",k_msgq_num_used_get(&hrs_queue),HRS_QUEUE_SIZE);
-		printk("========================\n\n");
+// 状态快照以二进制记录输出，由主机端 scripts/decode_status.py 解码
+static void status_snapshot_fill(struct ring_status_snapshot *snap) {
+	uint32_t now = k_uptime_get_32();
+	memset(snap, 0, sizeof(*snap));
+	snap->version = RING_STATUS_VERSION;
+	snap->uptime_s = now/1000;
+	snap->battery = get_battery_level();
+	snap->power_mode = get_current_power_mode();
+	snap->led_state = led_manager.state;
+	if (central_ring.conn) {
+		snap->flags |= RING_STATUS_CENTRAL_CONN;
+		if (central_ring.hrs_ready) snap->flags |= RING_STATUS_CENTRAL_HRS;
+		if (central_ring.lbs_ready) snap->flags |= RING_STATUS_CENTRAL_LBS;
+		snap->central.rssi = central_ring.current_rssi;
+		snap->central.distance = central_ring.distance;
+		snap->central.hr = central_ring.last_hr_value;
+		snap->central.conn_s = (now-central_ring.connection_time)/1000;
 	}
+	if (peripheral_ring.conn) {
+		snap->flags |= RING_STATUS_PERIPHERAL_CONN;
+		snap->peripheral.rssi = peripheral_ring.current_rssi;
+		snap->peripheral.distance = peripheral_ring.distance;
+		snap->peripheral.hr = peripheral_ring.last_hr_value;
+		snap->peripheral.conn_s = (now-peripheral_ring.connection_time)/1000;
+	}
+	if (atomic_get(&app_button_state)) snap->flags |= RING_STATUS_BUTTON;
+	if (atomic_get(&led_manager.flash_active)) snap->flags |= RING_STATUS_LED_FLASH;
+	snap->hr_ring_used = hr_ring_count(&hr_ring);
+	snap->hr_dropped = atomic_get(&hr_ring.dropped);
+	snap->hr_rx_errors = atomic_get(&hr_rx_stats.rx_errors);
+	if (hr_rx_stats.rx_count) {
+		snap->hr_rx_avg_us = k_cyc_to_us_floor32(hr_rx_stats.rx_cycles_total / hr_rx_stats.rx_count);
+		snap->hr_rx_max_us = k_cyc_to_us_floor32(hr_rx_stats.rx_cycles_max);
+	}
+	struct app_loop_stats loop;
+	app_loop_get_stats(&loop);
+	snap->loop_stack_used = loop.stack_used;
+	snap->hrv_rmssd_ms = hrv.rmssd_ms;
+	snap->hrv_sdnn_ms = hrv.sdnn_ms;
+	snap->hrv_stress = hrv.stress;
+}
+// 周期性二进制记录在应用事件循环上输出，不再占用独立线程栈；睡眠后降低频率
+static void status_work_handler(struct k_work *work) {
+	struct ring_status_snapshot snap;
+	struct ring_energy_record energy;
+	status_snapshot_fill(&snap);
+	LOG_HEXDUMP_INF(&snap, sizeof(snap), "status");
+	energy_stats_record_fill(&energy);
+	LOG_HEXDUMP_INF(&energy, sizeof(energy), "energy");
+	uint32_t interval = (get_current_power_mode() >= POWER_MODE_SLEEP) ?
+			    STATUS_INTERVAL_SLEEP : STATUS_INTERVAL_ACTIVE;
+	app_loop_schedule(&status_work, K_MSEC(interval));
+}
+
+static void run_led_work_handler(struct k_work *work) {
+	bool led_state = (k_uptime_get_32()/RUN_LED_BLINK_INTERVAL)%2;
+	ring_led_set(RUN_STATUS_LED, led_state);
+	app_loop_schedule(&run_led_work, K_MSEC(RUN_LED_BLINK_INTERVAL));
+}
+
+#if defined(CONFIG_SHELL)
+static const char * const power_mode_names[] = { "active", "idle", "sleep", "deep_sleep" };
+static const char * const led_state_names[] = { "off", "on", "flashing", "breathing" };
+
+static void stats_print_link(const struct shell *sh, const char *name,
+			     const struct ring_status_link *link, bool hrs, bool lbs) {
+	shell_print(sh, "%s: rssi %d dBm, %s, hr %u, up %u s, hrs %s, lbs %s", name, link->rssi,
+		    distance_level_str(link->distance), link->hr, link->conn_s,
+		    hrs ? "ready" : "-", lbs ? "ready" : "-");
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv) {
+	struct ring_status_snapshot snap;
+	struct conn_params_stats cp;
+	struct app_loop_stats loop;
+	status_snapshot_fill(&snap);
+	conn_params_get_stats(&cp);
+	app_loop_get_stats(&loop);
+	shell_print(sh, "Uptime %u s, battery %u%% (%u mV), power %s, led %s%s",
+		    snap.uptime_s, snap.battery, battery_get_mv(), power_mode_names[snap.power_mode],
+		    led_state_names[snap.led_state], (snap.flags & RING_STATUS_BUTTON) ? ", button" : "");
+	if (snap.flags & RING_STATUS_CENTRAL_CONN)
+		stats_print_link(sh, "central", &snap.central,
+				 snap.flags & RING_STATUS_CENTRAL_HRS, snap.flags & RING_STATUS_CENTRAL_LBS);
+	else
+		shell_print(sh, "central: not connected");
+	if (snap.flags & RING_STATUS_PERIPHERAL_CONN)
+		stats_print_link(sh, "peripheral", &snap.peripheral, false, false);
+	else
+		shell_print(sh, "peripheral: not connected");
+	shell_print(sh, "HR ring %u/%u used, %u dropped, %u rx errors, rx avg %u us max %u us",
+		    snap.hr_ring_used, HR_RING_SIZE, snap.hr_dropped, snap.hr_rx_errors,
+		    snap.hr_rx_avg_us, snap.hr_rx_max_us);
+	shell_print(sh, "HR sync %s: coherence %u%%, r %d%% at lag %d, mean diff %u.%u bpm, %u samples",
+		    hr_sync.synced ? "on" : "off", hr_sync.coherence * 100 >> 15, hr_sync.corr * 100 >> 15,
+		    hr_sync.lag, hr_sync.mean_diff_x16 >> 4, (hr_sync.mean_diff_x16 & 15) * 10 >> 4,
+		    hr_sync.count);
+	shell_print(sh, "HRV rmssd %u ms, sdnn %u ms, stress %u, %u beats in window, "
+		    "%u accepted, %u rejected, max %u us",
+		    hrv.rmssd_ms, hrv.sdnn_ms, hrv.stress, hrv.count, hrv.beats, hrv.rejected,
+		    k_cyc_to_us_ceil32(hrv_stats.cycles_max));
+	shell_print(sh, "Conn params: %u requested, %u applied, %u rejected, %u timed out, "
+		    "%u peer requests", cp.requests, cp.applied, cp.rejected, cp.timeouts,
+		    cp.peer_requests);
+	shell_print(sh, "App loop stack %u/%u B peak, %d B RAM reclaimed",
+		    (unsigned)loop.stack_used, (unsigned)loop.stack_size, loop.reclaimed);
+	return 0;
 }
 
+SHELL_SUBCMD_ADD((ring), stats, NULL, "Status snapshot", cmd_stats, 1, 0);
+#endif
+
 int main(void)
 {
     int err;
-    printk("\n=== SMART RING v2.0 Modular ===\n");
-    printk("Initializing...\n");
+    LOG_INF("=== SMART RING v2.0 Modular ===");
+    LOG_INF("Initializing...");
 
+    // 应用事件循环最先启动，其余模块的工作项都提交到它上面
+    app_loop_init();
     // 新增：功耗优化模块初始化，放在初始化最前面即可
     init_nrf54l15_power_optimization();
+    link_stats_init();
+    conn_params_init();
+    energy_stats_init();
 
     err = dk_leds_init();
-    if (err) { printk("LED init failed: %d\n", err); return err; }
+    if (err) { LOG_ERR("LED init failed: %d", err); return err; }
     err = init_button();
-    if (err) { printk("Button init failed: %d\n", err); return err; }
+    if (err) { LOG_ERR("Button init failed: %d", err); return err; }
 
     k_mutex_init(&led_manager.mutex);
     k_work_init_delayable(&led_manager.flash_work, led_flash_work_handler);
@@ -830,57 +616,61 @@ int main(void)
     led_manager.state = LED_STATE_OFF;
     atomic_set(&led_manager.flash_active, 0);
 
-    k_work_init(&adv_work, adv_work_handler);
     // **删除**：k_work_init_delayable(&rssi_work, rssi_work_handler);
     // **删除所有与rssi_work相关的调度**
 
-    k_work_init_delayable(&reconnect_work, reconnect_work_handler);
+    k_work_init_delayable(&status_work, status_work_handler);
+    k_work_init_delayable(&run_led_work, run_led_work_handler);
+    k_work_init(&hr_relay_work, hr_relay_work_handler);
+    hr_sync_init(&hr_sync);
+    hrv_init(&hrv);
+    LOG_INF("HR ring: %u B (k_msgq of measurements: %u B)", (unsigned)sizeof(hr_ring),
+            HR_BASELINE_QUEUE_LEN * HR_BASELINE_MEAS_SIZE);
 
     bt_conn_auth_cb_register(&auth_callbacks);
     bt_conn_auth_info_cb_register(&conn_auth_info_callbacks);
 
-    printk("Enabling Bluetooth...\n");
+    LOG_INF("Enabling Bluetooth...");
     err = bt_enable(NULL);
-    if (err) { printk("Bluetooth enable failed: %d\n", err); return err; }
-    if (IS_ENABLED(CONFIG_SETTINGS)) { printk("Loading settings...\n"); settings_load(); }
+    if (err) { LOG_ERR("Bluetooth enable failed: %d", err); return err; }
+    if (IS_ENABLED(CONFIG_SETTINGS)) { LOG_INF("Loading settings..."); settings_load(); }
 
-    err = bt_hrs_client_init(&hrs_c);
-    if (err) { printk("HRS client init failed: %d\n", err); return err; }
+    err = ring_client_init(&ring_client_callbacks);
+    if (err) { LOG_ERR("Ring client init failed: %d", err); return err; }
     err = bt_lbs_init(&lbs_callbacks);
-    if (err) { printk("LBS service init failed: %d\n", err); return err; }
+    if (err) { LOG_ERR("LBS service init failed: %d", err); return err; }
+    err = battery_init();
+    if (err) LOG_WRN("Battery gauge unavailable: %d", err);
 
     memset(&central_ring,0,sizeof(central_ring));
     memset(&peripheral_ring,0,sizeof(peripheral_ring));
-    memset(&lbs_client_ctx,0,sizeof(lbs_client_ctx));
-    rssi_filter_init(&central_ring.rssi_filter);
-    rssi_filter_init(&peripheral_ring.rssi_filter);
-
-    err = scan_init();
-    if (err) { printk("Scan init failed: %d\n", err); return err; }
-
-    atomic_set(&system_ready, 1);
-    printk("Starting scan & advertising...\n");
-    scan_start();
-    advertising_start();
-
-    printk("=== System Ready ===\n");
-    printk("Press button for partner\n");
-    printk("Auto connect\n");
-
-    while (1) {
-        if (atomic_get(&system_ready)) {
-            bool led_state = (k_uptime_get_32()/RUN_LED_BLINK_INTERVAL)%2;
-            dk_set_led(RUN_STATUS_LED, led_state);
-        }
-        k_sleep(K_MSEC(RUN_LED_BLINK_INTERVAL));
-    }
+    link_stats_reset(&central_ring);
+    link_stats_reset(&peripheral_ring);
+
+    err = reconnect_init();
+    if (err) { LOG_ERR("Reconnect init failed: %d", err); return err; }
+    err = presence_init(&ring_client_callbacks);
+    if (err) LOG_WRN("Presence unavailable: %d", err);
+    err = history_init();
+    if (err) LOG_WRN("History store unavailable: %d", err);
+    err = bulk_init();
+    if (err) LOG_WRN("Bulk transfer unavailable: %d", err);
+    err = ppg_init(own_hr_sample);
+    if (err) LOG_WRN("PPG sensor unavailable: %d", err);
+    else own_hr_source = IS_ENABLED(CONFIG_RING_PPG);
+
+    app_loop_schedule(&status_work, K_MSEC(STATUS_INTERVAL_ACTIVE));
+    app_loop_schedule(&run_led_work, K_NO_WAIT);
+    LOG_INF("Starting scan & advertising...");
+    reconnect_start();
+
+    LOG_INF("=== System Ready ===");
+    LOG_INF("Press button for partner");
+    LOG_INF("Auto connect");
+    // 之后的工作全部由事件循环和系统工作队列驱动，main 线程结束
     return 0;
 }
 
-// ---- 线程定义 ----
-K_THREAD_DEFINE(hrs_notify_thread_id, STACKSIZE, hrs_notify_thread, NULL, NULL, NULL, PRIORITY, 0, 0);
-K_THREAD_DEFINE(status_monitor_thread_id, STACKSIZE, status_monitor_thread, NULL, NULL, NULL, PRIORITY+1, 0, 0);
-
 /////////////////////////////////////////////////////////////////
 ////      END OF MAIN.C (ready for future split)             /////
 /////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -1,40 +1,28 @@
 // nrf54l15_power_mgr.c -- nRF54L15专用功耗优化模块
+// 事件驱动的功耗状态机：活动/连接/电池/shell 事件只在锁内更新输入并立即唤醒 power_work，
+// 模式切换与监听器通知都在 power_work 中串行进行；平时只为下一次空闲阈值跨越
+// （空闲/睡眠/深睡）设置一个定时器；电池采样见 battery.c
 #include "nrf54l15_power_mgr.h"
+#include "link_stats.h"
+#include "ring_tune.h"
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/kernel.h>
-#include <zephyr/sys/printk.h>
+#include <zephyr/logging/log.h>
 #include <zephyr/pm/pm.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
 
-// 连接参数
-#define CONN_PARAM_ACTIVE_MIN        6
-#define CONN_PARAM_ACTIVE_MAX        12
-#define CONN_PARAM_IDLE_MIN          40
-#define CONN_PARAM_IDLE_MAX          60
-#define CONN_PARAM_SLEEP_MIN         80
-#define CONN_PARAM_SLEEP_MAX         120
-#define CONN_PARAM_DEEP_SLEEP_MIN    240
-#define CONN_PARAM_DEEP_SLEEP_MAX    320
-
-#define RSSI_INTERVAL_ACTIVE         3000
-#define RSSI_INTERVAL_IDLE           8000
-#define RSSI_INTERVAL_SLEEP          20000
-#define RSSI_INTERVAL_DEEP_SLEEP     0
-
-#define STATUS_INTERVAL_ACTIVE       10000
-#define STATUS_INTERVAL_SLEEP        30000
-
-#define IDLE_THRESHOLD_MS            5000
-#define SLEEP_THRESHOLD_MS           30000
-#define DEEP_SLEEP_THRESHOLD_MS      120000
+LOG_MODULE_REGISTER(ring_power, CONFIG_RING_LOG_LEVEL);
 
 struct power_manager {
     power_mode_t current_mode;
     uint32_t last_activity_time;
     uint8_t battery_level;
     bool ultra_low_power;
+    bool forced;                 // shell 强制模式，空闲策略暂停
+    power_mode_t forced_mode;
     uint32_t mode_change_time;
-    uint32_t total_active_time;
-    uint32_t total_sleep_time;
 };
 
 static struct power_manager power_mgr = {
@@ -43,177 +31,223 @@ static struct power_manager power_mgr = {
     .ultra_low_power = false
 };
 
-extern struct ring_connection central_ring, peripheral_ring;
-
-static int adjust_connection_params(struct bt_conn *conn, power_mode_t mode) {
-    if (!conn) return -EINVAL;
-    struct bt_le_conn_param param = {0};
-    switch (mode) {
-    case POWER_MODE_ACTIVE:
-        param.interval_min = CONN_PARAM_ACTIVE_MIN;
-        param.interval_max = CONN_PARAM_ACTIVE_MAX;
-        param.latency = 0;
-        param.timeout = 400;
-        break;
-    case POWER_MODE_IDLE:
-        param.interval_min = CONN_PARAM_IDLE_MIN;
-        param.interval_max = CONN_PARAM_IDLE_MAX;
-        param.latency = 1;
-        param.timeout = 600;
-        break;
-    case POWER_MODE_SLEEP:
-        param.interval_min = CONN_PARAM_SLEEP_MIN;
-        param.interval_max = CONN_PARAM_SLEEP_MAX;
-        param.latency = 4;
-        param.timeout = 800;
-        break;
-    case POWER_MODE_DEEP_SLEEP:
-        param.interval_min = CONN_PARAM_DEEP_SLEEP_MIN;
-        param.interval_max = CONN_PARAM_DEEP_SLEEP_MAX;
-        param.latency = 10;
-        param.timeout = 1200;
-        break;
-    }
-    printk("Adjusting conn params: interval %d-%d, latency %d\n", 
-           param.interval_min, param.interval_max, param.latency);
-    return bt_conn_le_param_update(conn, &param);
+static struct k_work_delayable power_work;
+static sys_slist_t mode_listeners = SYS_SLIST_STATIC_INIT(&mode_listeners);
+// 保护 power_mgr 的输入与当前模式；模式只在 power_work 中切换，监听器也只在那里按顺序通知
+static struct k_spinlock power_lock;
+
+// 低电量或强制模式下不按空闲时长切换
+static bool idle_policy_suspended(void) {
+    return power_mgr.ultra_low_power || power_mgr.forced;
+}
+
+// 低电量保持深睡，直到电量回升；调用方持锁
+static power_mode_t power_target_mode(uint32_t now) {
+    if (power_mgr.ultra_low_power)
+        return POWER_MODE_DEEP_SLEEP;
+    if (power_mgr.forced)
+        return power_mgr.forced_mode;
+    return power_policy_target_mode(ring_tune_get(), now - power_mgr.last_activity_time);
+}
+
+// 只为最近的一个空闲阈值设置定时器；调用方持锁，与事件侧的立即重排按加锁顺序生效
+static void power_schedule_next(uint32_t now) {
+    uint32_t delay = idle_policy_suspended() ? UINT32_MAX :
+        power_policy_next_deadline(ring_tune_get(), now - power_mgr.last_activity_time);
+    if (delay == UINT32_MAX)
+        k_work_cancel_delayable(&power_work);
+    else
+        k_work_reschedule(&power_work, K_MSEC(delay));
+}
+
+// 输入已变化，尽快在 power_work 中重新判断；调用方持锁
+static void power_kick(void) {
+    k_work_reschedule(&power_work, K_NO_WAIT);
 }
 
-static void set_power_mode(power_mode_t new_mode) {
-    if (new_mode == power_mgr.current_mode) return;
+static void power_work_handler(struct k_work *work) {
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
     uint32_t now = k_uptime_get_32();
+    power_mode_t old_mode = power_mgr.current_mode;
+    power_mode_t new_mode = power_target_mode(now);
     uint32_t duration = now - power_mgr.mode_change_time;
-    if (power_mgr.current_mode == POWER_MODE_ACTIVE)
-        power_mgr.total_active_time += duration;
-    else
-        power_mgr.total_sleep_time += duration;
-    printk("Power mode: %d->%d (was %ums)\n", power_mgr.current_mode, new_mode, duration);
-    power_mgr.current_mode = new_mode;
-    power_mgr.mode_change_time = now;
-    if (central_ring.conn)
-        adjust_connection_params(central_ring.conn, new_mode);
-    if (peripheral_ring.conn)
-        adjust_connection_params(peripheral_ring.conn, new_mode);
+    if (new_mode != old_mode) {
+        power_mgr.current_mode = new_mode;
+        power_mgr.mode_change_time = now;
+    }
+    power_schedule_next(now);
+    k_spin_unlock(&power_lock, key);
+
+    if (new_mode == old_mode) return;
+    LOG_INF("Power mode: %d->%d (was %ums)", old_mode, new_mode, duration);
+    // 连接参数由 conn_params 模块作为监听器按链路协商
+    struct power_mode_listener *listener;
+    SYS_SLIST_FOR_EACH_CONTAINER(&mode_listeners, listener, node) {
+        if (listener->mode_changed)
+            listener->mode_changed(old_mode, new_mode);
+    }
 }
 
 void on_user_activity(void) {
+    struct power_mode_listener *listener;
+
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
     power_mgr.last_activity_time = k_uptime_get_32();
-    if (power_mgr.current_mode != POWER_MODE_ACTIVE) {
-        set_power_mode(POWER_MODE_ACTIVE);
+    // 已在 ACTIVE 时无需重排定时器：到期时按最新活动时间重新计算
+    if (power_mgr.current_mode != POWER_MODE_ACTIVE && !idle_policy_suspended())
+        power_kick();
+    k_spin_unlock(&power_lock, key);
+    SYS_SLIST_FOR_EACH_CONTAINER(&mode_listeners, listener, node) {
+        if (listener->user_activity)
+            listener->user_activity();
     }
 }
 
 void on_connection_established(struct bt_conn *conn) {
     on_user_activity();
-    adjust_connection_params(conn, POWER_MODE_ACTIVE);
+    link_stats_request_update();
 }
 
 void on_connection_lost(void) {
-    set_power_mode(POWER_MODE_SLEEP);
-}
+    uint32_t sleep_threshold = ring_tune_get()->power_threshold_ms[1];
 
-static void update_power_mode(void) {
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
     uint32_t now = k_uptime_get_32();
-    uint32_t idle_time = now - power_mgr.last_activity_time;
-    static uint32_t last_battery_update = 0;
-    if (now - last_battery_update > 60000) {
-        uint8_t drain_rate = 1;
-        switch (power_mgr.current_mode) {
-        case POWER_MODE_ACTIVE:      drain_rate = 2; break;
-        case POWER_MODE_IDLE:        drain_rate = 1; break;
-        case POWER_MODE_SLEEP:       drain_rate = 0; break;
-        case POWER_MODE_DEEP_SLEEP:  drain_rate = 0; break;
-        }
-        static uint8_t drain_counter = 0;
-        drain_counter += drain_rate;
-        if (drain_counter >= 2) {
-            power_mgr.battery_level = (power_mgr.battery_level > 0) ? power_mgr.battery_level - 1 : 0;
-            drain_counter = 0;
-        }
-        last_battery_update = now;
-        if (power_mgr.battery_level <= 15 && !power_mgr.ultra_low_power) {
-            power_mgr.ultra_low_power = true;
-            set_power_mode(POWER_MODE_DEEP_SLEEP);
-            printk("Ultra low power mode: %d%%\n", power_mgr.battery_level);
-            return;
-        }
+    // 断连视为已空闲到睡眠阈值，之后按正常空闲计时进入深睡
+    if (now - power_mgr.last_activity_time <= sleep_threshold)
+        power_mgr.last_activity_time = now - sleep_threshold - 1;
+    power_kick();
+    k_spin_unlock(&power_lock, key);
+}
+
+void on_battery_level_changed(uint8_t level) {
+    struct power_mode_listener *listener;
+
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
+    bool level_changed = level != power_mgr.battery_level;
+    power_mgr.battery_level = level;
+    bool low = battery_low_state(power_mgr.ultra_low_power, level);
+    bool changed = low != power_mgr.ultra_low_power;
+    if (changed) {
+        power_mgr.ultra_low_power = low;
+        power_kick();
     }
-    if (power_mgr.ultra_low_power) return;
-    power_mode_t target_mode = power_mgr.current_mode;
-    if (idle_time > DEEP_SLEEP_THRESHOLD_MS)
-        target_mode = POWER_MODE_DEEP_SLEEP;
-    else if (idle_time > SLEEP_THRESHOLD_MS)
-        target_mode = POWER_MODE_SLEEP;
-    else if (idle_time > IDLE_THRESHOLD_MS)
-        target_mode = POWER_MODE_IDLE;
-    else
-        target_mode = POWER_MODE_ACTIVE;
-    if (target_mode != power_mgr.current_mode)
-        set_power_mode(target_mode);
-}
-
-static uint32_t get_rssi_update_interval(void) {
-    switch (power_mgr.current_mode) {
-    case POWER_MODE_ACTIVE:      return RSSI_INTERVAL_ACTIVE;
-    case POWER_MODE_IDLE:        return RSSI_INTERVAL_IDLE;
-    case POWER_MODE_SLEEP:       return RSSI_INTERVAL_SLEEP;
-    case POWER_MODE_DEEP_SLEEP:  return RSSI_INTERVAL_DEEP_SLEEP;
-    default:                     return RSSI_INTERVAL_ACTIVE;
+    k_spin_unlock(&power_lock, key);
+
+    if (changed && low)
+        LOG_INF("Ultra low power mode: %d%%", level);
+    else if (changed)
+        LOG_INF("Leaving ultra low power mode: %d%%", level);
+    if (!level_changed)
+        return;
+    SYS_SLIST_FOR_EACH_CONTAINER(&mode_listeners, listener, node) {
+        if (listener->battery_changed)
+            listener->battery_changed(level);
     }
 }
-static bool should_update_rssi(void) {
-    return (power_mgr.current_mode != POWER_MODE_DEEP_SLEEP);
+
+uint32_t get_rssi_update_interval(power_mode_t mode) {
+    const struct ring_tunables *t = ring_tune_get();
+    if ((unsigned)mode >= ARRAY_SIZE(t->rssi_interval_ms))
+        mode = POWER_MODE_ACTIVE;
+    return t->rssi_interval_ms[mode];
 }
 
-static struct k_work_delayable unified_work;
+// 阈值变化后按新阈值重新判断并重排定时器
+static void power_tune_changed(const struct ring_tunables *t) {
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
+    power_kick();
+    k_spin_unlock(&power_lock, key);
+}
 
-void rssi_update_internal(void); // 由主文件实现
+static struct ring_tune_listener power_tune_listener = {
+    .changed = power_tune_changed,
+};
 
-static void unified_periodic_work_handler(struct k_work *work) {
-    update_power_mode();
-    if (should_update_rssi()) {
-        rssi_update_internal();
-    }
-    uint32_t next_interval = get_rssi_update_interval();
-    if (next_interval > 0)
-        k_work_schedule(&unified_work, K_MSEC(next_interval));
+void power_mode_listener_register(struct power_mode_listener *listener) {
+    sys_slist_append(&mode_listeners, &listener->node);
 }
 
 static void enable_advanced_power_features(void) {
 #ifdef CONFIG_SOC_DCDC_NRF54L15
-    printk("DCDC converter enabled\n");
+    LOG_INF("DCDC converter enabled");
 #endif
 #ifdef CONFIG_CLOCK_CONTROL_NRF_K32SRC_XTAL
-    printk("32kHz XTAL configured for low power\n");
+    LOG_INF("32kHz XTAL configured for low power");
 #endif
 #ifdef CONFIG_PM
     pm_constraint_set(PM_STATE_SUSPEND_TO_IDLE);
-    printk("Power management constraints set\n");
+    LOG_INF("Power management constraints set");
 #endif
 }
 
 int init_nrf54l15_power_optimization(void) {
-    printk("Initializing nRF54L15 power optimization...\n");
-    power_mgr.last_activity_time = k_uptime_get_32();
-    power_mgr.mode_change_time = k_uptime_get_32();
+    LOG_INF("Initializing nRF54L15 power optimization...");
+    uint32_t now = k_uptime_get_32();
+    power_mgr.last_activity_time = now;
+    power_mgr.mode_change_time = now;
     enable_advanced_power_features();
-    k_work_init_delayable(&unified_work, unified_periodic_work_handler);
-    k_work_schedule(&unified_work, K_MSEC(RSSI_INTERVAL_ACTIVE));
-    printk("Power optimization ready. Battery: %d%%\n", power_mgr.battery_level);
+    k_work_init_delayable(&power_work, power_work_handler);
+    ring_tune_listener_register(&power_tune_listener);
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
+    power_schedule_next(now);
+    k_spin_unlock(&power_lock, key);
+    LOG_INF("Power optimization ready");
     return 0;
 }
 
 uint8_t get_battery_level(void) {
     return power_mgr.battery_level;
 }
+bool get_battery_low(void) {
+    return power_mgr.ultra_low_power;
+}
 power_mode_t get_current_power_mode(void) {
     return power_mgr.current_mode;
 }
-void print_power_statistics(void) {
-    uint32_t total_time = power_mgr.total_active_time + power_mgr.total_sleep_time;
-    if (total_time == 0) return;
-    uint32_t active_percentage = (power_mgr.total_active_time * 100) / total_time;
-    uint32_t sleep_percentage = 100 - active_percentage;
-    printk("Power Stats: Active %u%%, Sleep %u%%\n", active_percentage, sleep_percentage);
-    printk("Estimated battery life improvement: %ux\n", sleep_percentage > 50 ? (sleep_percentage / 20) + 1 : 1);
-}
\ No newline at end of file
+
+#if defined(CONFIG_SHELL)
+static const char * const mode_names[] = { "active", "idle", "sleep", "deep_sleep" };
+
+static int cmd_power_show(const struct shell *sh, size_t argc, char **argv) {
+    uint32_t now = k_uptime_get_32();
+    shell_print(sh, "Mode %s%s, battery %u%%%s", mode_names[power_mgr.current_mode],
+                power_mgr.forced ? " (forced)" : "", power_mgr.battery_level,
+                power_mgr.ultra_low_power ? ", ultra low power" : "");
+    shell_print(sh, "Idle %u ms, in mode %u ms", now - power_mgr.last_activity_time,
+                now - power_mgr.mode_change_time);
+    return 0;
+}
+
+static int cmd_power_force(const struct shell *sh, size_t argc, char **argv) {
+    for (size_t i = 0; i < ARRAY_SIZE(mode_names); i++) {
+        if (!strcmp(argv[1], mode_names[i])) {
+            k_spinlock_key_t key = k_spin_lock(&power_lock);
+            power_mgr.forced = true;
+            power_mgr.forced_mode = (power_mode_t)i;
+            power_kick();
+            k_spin_unlock(&power_lock, key);
+            if (power_mgr.ultra_low_power)
+                shell_warn(sh, "Ultra low power active, applied when battery recovers");
+            return 0;
+        }
+    }
+    shell_error(sh, "Unknown mode: %s", argv[1]);
+    return -EINVAL;
+}
+
+static int cmd_power_auto(const struct shell *sh, size_t argc, char **argv) {
+    k_spinlock_key_t key = k_spin_lock(&power_lock);
+    power_mgr.forced = false;
+    power_kick();
+    k_spin_unlock(&power_lock, key);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(power_cmds,
+    SHELL_CMD_ARG(force, NULL, "<active|idle|sleep|deep_sleep>", cmd_power_force, 2, 0),
+    SHELL_CMD(auto, NULL, "Return to idle-time policy", cmd_power_auto),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), power, &power_cmds, "Show or force the power mode", cmd_power_show, 1, 0);
+#endif
@@ -0,0 +1,207 @@
+// ppg.c -- 本端 PPG 采集与心搏检测
+// 读取使用传感器的读/解码 API：sensor_read() 把 FIFO 中的全部样本读成驱动自己的原始格式，
+// 再由驱动的解码器解成 Q31 帧，因此换用其他带 FIFO 的 PPG 传感器只需换驱动和别名
+#include "ppg.h"
+#include "app_loop.h"
+#include "beat_detect.h"
+#include "nrf54l15_power_mgr.h"
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/shell/shell.h>
+
+LOG_MODULE_REGISTER(ring_ppg, CONFIG_RING_LOG_LEVEL);
+
+#define PPG_NODE        DT_ALIAS(ppg0)
+#define PPG_FIFO_DEPTH  CONFIG_RING_PPG_FIFO_DEPTH
+// 原始批次的格式由驱动决定，按每帧 8 字节加块头预留
+#define PPG_RAW_SIZE    (64 + PPG_FIFO_DEPTH * 8)
+
+static const struct device *const ppg_dev = DEVICE_DT_GET(PPG_NODE);
+SENSOR_DT_READ_IODEV(ppg_iodev, PPG_NODE, {SENSOR_CHAN_GREEN, 0});
+RTIO_DEFINE(ppg_rtio, 1, 1);
+
+static const struct sensor_trigger ppg_trigger = {
+    .type = SENSOR_TRIG_FIFO_WATERMARK,
+    .chan = SENSOR_CHAN_GREEN,
+};
+static const struct sensor_chan_spec ppg_chan = { SENSOR_CHAN_GREEN, 0 };
+
+static struct k_work ppg_work;
+static struct k_work ppg_mode_work;
+
+static struct {
+    ppg_sample_cb_t cb;
+    struct beat_detect bd;
+    struct ppg_stats stats;
+    uint8_t raw[PPG_RAW_SIZE] __aligned(8);
+    // sensor_q31_data 只带一个读数，后面接着放其余的帧
+    struct {
+        struct sensor_q31_data data;
+        struct sensor_q31_sample_data more[PPG_FIFO_DEPTH - 1];
+    } frames;
+    int32_t x[PPG_FIFO_DEPTH];
+} ppg;
+
+static void ppg_publish(uint16_t hr, const uint16_t *rr, uint8_t rr_count) {
+    struct hr_sample sample = {
+        .timestamp = k_uptime_get_32(),
+        .hr = hr,
+        .rr_count = rr_count,
+    };
+
+    for (uint8_t i = 0; i < rr_count; i++)
+        sample.rr[i] = rr[i];
+    ppg.stats.hr = hr;
+    ppg.cb(&sample);
+}
+
+// Q31 定点值 v · 2^shift / 2^31 转为整数计数；负值不做左移（未定义行为），改用乘法
+static int32_t q31_to_count(q31_t v, int8_t shift) {
+    if (shift >= 31)
+        return (int32_t)((int64_t)v * ((int64_t)1 << (shift - 31)));
+    return (int32_t)((int64_t)v >> (31 - shift));
+}
+
+static void ppg_work_handler(struct k_work *work) {
+    const struct sensor_decoder_api *decoder;
+    uint32_t start = k_cycle_get_32();
+    uint16_t rr[HR_SAMPLE_RR_MAX];
+    uint16_t frames = 0;
+    uint32_t fit = 0;
+    uint8_t beats;
+    int rc;
+
+    if (!ppg.stats.running)
+        return;
+    rc = sensor_read(&ppg_iodev, &ppg_rtio, ppg.raw, sizeof(ppg.raw));
+    if (!rc)
+        rc = sensor_get_decoder(ppg_dev, &decoder);
+    if (!rc)
+        rc = decoder->get_frame_count(ppg.raw, ppg_chan, &frames);
+    if (!rc && frames)
+        rc = decoder->decode(ppg.raw, ppg_chan, &fit, MIN(frames, PPG_FIFO_DEPTH),
+                             &ppg.frames.data);
+    if (rc < 0) {
+        ppg.stats.read_errors++;
+        LOG_WRN("PPG read failed: %d", rc);
+        return;
+    }
+    frames = rc;
+    for (uint16_t i = 0; i < frames; i++) {
+        int32_t v = q31_to_count(ppg.frames.data.readings[i].value, ppg.frames.data.shift);
+        ppg.x[i] = IS_ENABLED(CONFIG_RING_PPG_INVERT) ? -v : v;
+    }
+
+    beats = beat_detect_run(&ppg.bd, ppg.x, frames, rr, ARRAY_SIZE(rr));
+    ppg.stats.batches++;
+    ppg.stats.samples += frames;
+    ppg.stats.batch_max = MAX(ppg.stats.batch_max, frames);
+    ppg.stats.beats = ppg.bd.beats;
+    // 有新的 RR 或心率变为无效时发布
+    if (beats || ppg.bd.hr != ppg.stats.hr)
+        ppg_publish(ppg.bd.hr, rr, beats);
+    ppg.stats.cycles_max = MAX(ppg.stats.cycles_max, k_cycle_get_32() - start);
+}
+
+// 在驱动的中断或线程上下文中调用，只提交工作项
+static void ppg_fifo_ready(const struct device *dev, const struct sensor_trigger *trig) {
+    app_loop_submit(&ppg_work);
+}
+
+// 采样率 0 让传感器停止采样并关闭 LED
+static int ppg_set_rate(uint16_t hz) {
+    struct sensor_value v = { .val1 = hz };
+    return sensor_attr_set(ppg_dev, SENSOR_CHAN_GREEN, SENSOR_ATTR_SAMPLING_FREQUENCY, &v);
+}
+
+// 与 ppg_work 同在事件循环中，检测器状态不需要加锁
+static void ppg_mode_work_handler(struct k_work *work) {
+    bool run = get_current_power_mode() != POWER_MODE_DEEP_SLEEP;
+    int err;
+
+    if (run == ppg.stats.running)
+        return;
+    err = ppg_set_rate(run ? ppg.stats.rate_hz : 0);
+    if (err) {
+        LOG_WRN("PPG %s failed: %d", run ? "start" : "stop", err);
+        return;
+    }
+    ppg.stats.running = run;
+    LOG_INF("PPG %s", run ? "started" : "stopped");
+    // 重新开始时重新学习脉搏幅度
+    beat_detect_init(&ppg.bd, ppg.stats.rate_hz);
+    if (!run && ppg.stats.hr)
+        ppg_publish(0, NULL, 0);
+}
+
+static void ppg_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    app_loop_submit(&ppg_mode_work);
+}
+
+static struct power_mode_listener ppg_mode_listener = {
+    .mode_changed = ppg_mode_changed,
+};
+
+int ppg_init(ppg_sample_cb_t cb) {
+    struct sensor_value v;
+    int err;
+
+    if (!device_is_ready(ppg_dev)) {
+        LOG_ERR("PPG sensor not ready");
+        return -ENODEV;
+    }
+    ppg.cb = cb;
+    ppg.stats.rate_hz = CONFIG_RING_PPG_RATE_HZ;
+    k_work_init(&ppg_work, ppg_work_handler);
+    k_work_init(&ppg_mode_work, ppg_mode_work_handler);
+
+    err = ppg_set_rate(ppg.stats.rate_hz);
+    if (err) {
+        // 只支持固定采样率的传感器（如回放的记录）按它自己的采样率检测
+        err = sensor_attr_get(ppg_dev, SENSOR_CHAN_GREEN, SENSOR_ATTR_SAMPLING_FREQUENCY, &v);
+        if (err || v.val1 <= 0) {
+            LOG_ERR("PPG sampling rate unavailable: %d", err);
+            return err ? err : -EINVAL;
+        }
+        ppg.stats.rate_hz = v.val1;
+        err = ppg_set_rate(ppg.stats.rate_hz);
+        if (err) {
+            LOG_ERR("PPG start failed: %d", err);
+            return err;
+        }
+    }
+    beat_detect_init(&ppg.bd, ppg.stats.rate_hz);
+    ppg.stats.running = true;
+    err = sensor_trigger_set(ppg_dev, &ppg_trigger, ppg_fifo_ready);
+    if (err) {
+        LOG_ERR("PPG FIFO trigger failed: %d", err);
+        ppg_set_rate(0);
+        ppg.stats.running = false;
+        return err;
+    }
+    power_mode_listener_register(&ppg_mode_listener);
+    LOG_INF("PPG: %s at %u Hz", ppg_dev->name, ppg.stats.rate_hz);
+    return 0;
+}
+
+void ppg_get_stats(struct ppg_stats *stats) {
+    *stats = ppg.stats;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_ppg(const struct shell *sh, size_t argc, char **argv) {
+    struct ppg_stats s = ppg.stats;
+
+    shell_print(sh, "PPG %s at %u Hz, hr %u bpm, %u beats", s.running ? "running" : "stopped",
+                s.rate_hz, s.hr, s.beats);
+    shell_print(sh, "%u wakeups, %u samples (%u per wakeup, max %u), %u read errors, max %u us",
+                s.batches, s.samples, s.batches ? s.samples / s.batches : 0, s.batch_max,
+                s.read_errors, k_cyc_to_us_ceil32(s.cycles_max));
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ring), ppg, NULL, "Local PPG sensor", cmd_ppg, 1, 0);
+#endif
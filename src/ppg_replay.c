@@ -0,0 +1,290 @@
+// ppg_replay.c -- native_sim 上的 PPG 传感器模拟器：回放编进镜像的记录
+// 模拟一个带 FIFO 的传感器：定时器按记录的采样率逐个“采样”，FIFO 达到水位时调用
+// SENSOR_TRIG_FIFO_WATERMARK 回调；sensor_read() 一次读出 FIFO 中的全部样本，
+// FIFO 满时丢弃最旧的样本并计数。只有 SENSOR_CHAN_GREEN 一个通道。
+// 记录格式见 scripts/ppg_trace.py，由 CONFIG_RING_PPG_REPLAY_TRACE 选择，循环回放
+#define DT_DRV_COMPAT ring_ppg_replay
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ppg_replay, CONFIG_SENSOR_LOG_LEVEL);
+
+static const uint8_t ppg_trace[] = {
+#include "ppg_trace.inc"
+};
+
+#define TRACE_MAGIC   "PPGT"
+#define TRACE_HEADER  8
+// 解码输出的 Q31 定标：int16 样本原样表示为计数
+#define PPG_REPLAY_SHIFT 15
+
+struct ppg_replay_config {
+    uint16_t fifo_depth;
+    uint16_t watermark;
+};
+
+struct ppg_replay_data {
+    const struct device *dev;
+    struct k_timer timer;
+    struct k_spinlock lock;
+    sensor_trigger_handler_t handler;
+    const struct sensor_trigger *trigger;
+    uint16_t rate_hz;
+    uint32_t period_ns;
+    uint32_t length;         // 记录中的样本数
+    uint64_t start_ns;       // 开始采样的时刻
+    uint32_t produced;       // 开始采样以来的样本数
+    uint32_t consumed;       // 已读出的样本数，produced - consumed 即 FIFO 中的样本
+    uint32_t overflows;
+    int16_t latest;          // sample_fetch() 锁存的样本
+};
+
+// sensor_read() 读出的原始批次
+struct ppg_replay_batch {
+    uint64_t timestamp_ns;   // 第一个样本的时刻
+    uint32_t period_ns;
+    uint16_t count;
+    int16_t samples[];
+};
+
+static int16_t trace_sample(const struct ppg_replay_data *data, uint32_t i) {
+    return (int16_t)sys_get_le16(&ppg_trace[TRACE_HEADER + (i % data->length) * 2]);
+}
+
+static void ppg_replay_tick(struct k_timer *timer) {
+    struct ppg_replay_data *data = CONTAINER_OF(timer, struct ppg_replay_data, timer);
+    const struct ppg_replay_config *cfg = data->dev->config;
+    sensor_trigger_handler_t handler = NULL;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    data->produced++;
+    if (data->produced - data->consumed > cfg->fifo_depth) {
+        data->consumed++;
+        data->overflows++;
+    }
+    // 只在 FIFO 刚达到水位时触发一次，读出后重新计数
+    if (data->produced - data->consumed == cfg->watermark)
+        handler = data->handler;
+    k_spin_unlock(&data->lock, key);
+    if (handler)
+        handler(data->dev, data->trigger);
+}
+
+static int ppg_replay_attr_set(const struct device *dev, enum sensor_channel chan,
+                               enum sensor_attribute attr, const struct sensor_value *val) {
+    struct ppg_replay_data *data = dev->data;
+    k_spinlock_key_t key;
+
+    if (chan != SENSOR_CHAN_GREEN || attr != SENSOR_ATTR_SAMPLING_FREQUENCY)
+        return -ENOTSUP;
+    if (val->val1 == 0) {
+        k_timer_stop(&data->timer);
+        return 0;
+    }
+    // 记录只能按录制时的采样率回放
+    if (val->val1 != data->rate_hz)
+        return -ENOTSUP;
+    if (k_timer_remaining_ticks(&data->timer))
+        return 0;
+    key = k_spin_lock(&data->lock);
+    data->start_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+    data->produced = data->consumed = 0;
+    k_spin_unlock(&data->lock, key);
+    k_timer_start(&data->timer, K_NSEC(data->period_ns), K_NSEC(data->period_ns));
+    return 0;
+}
+
+static int ppg_replay_attr_get(const struct device *dev, enum sensor_channel chan,
+                               enum sensor_attribute attr, struct sensor_value *val) {
+    const struct ppg_replay_data *data = dev->data;
+
+    if (chan != SENSOR_CHAN_GREEN || attr != SENSOR_ATTR_SAMPLING_FREQUENCY)
+        return -ENOTSUP;
+    val->val1 = data->rate_hz;
+    val->val2 = 0;
+    return 0;
+}
+
+static int ppg_replay_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                                  sensor_trigger_handler_t handler) {
+    struct ppg_replay_data *data = dev->data;
+    k_spinlock_key_t key;
+
+    if (trig->type != SENSOR_TRIG_FIFO_WATERMARK)
+        return -ENOTSUP;
+    key = k_spin_lock(&data->lock);
+    data->handler = handler;
+    data->trigger = trig;
+    k_spin_unlock(&data->lock, key);
+    return 0;
+}
+
+static int ppg_replay_sample_fetch(const struct device *dev, enum sensor_channel chan) {
+    struct ppg_replay_data *data = dev->data;
+
+    if (chan != SENSOR_CHAN_ALL && chan != SENSOR_CHAN_GREEN)
+        return -ENOTSUP;
+    data->latest = trace_sample(data, data->produced);
+    return 0;
+}
+
+static int ppg_replay_channel_get(const struct device *dev, enum sensor_channel chan,
+                                  struct sensor_value *val) {
+    const struct ppg_replay_data *data = dev->data;
+
+    if (chan != SENSOR_CHAN_GREEN)
+        return -ENOTSUP;
+    val->val1 = data->latest;
+    val->val2 = 0;
+    return 0;
+}
+
+static void ppg_replay_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe) {
+    const struct sensor_read_config *cfg = iodev_sqe->sqe.iodev->data;
+    const struct ppg_replay_config *config = dev->config;
+    struct ppg_replay_data *data = dev->data;
+    struct ppg_replay_batch *batch;
+    uint32_t min_len = sizeof(*batch) + sizeof(int16_t);
+    uint32_t max_len = sizeof(*batch) + config->fifo_depth * sizeof(int16_t);
+    uint32_t buf_len, n;
+    uint8_t *buf;
+    k_spinlock_key_t key;
+    int rc;
+
+    if (cfg->is_streaming) {
+        rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+        return;
+    }
+    for (size_t i = 0; i < cfg->count; i++) {
+        if (cfg->channels[i].chan_type != SENSOR_CHAN_GREEN) {
+            rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+            return;
+        }
+    }
+    rc = rtio_sqe_rx_buf(iodev_sqe, min_len, max_len, &buf, &buf_len);
+    if (rc) {
+        rtio_iodev_sqe_err(iodev_sqe, rc);
+        return;
+    }
+    batch = (struct ppg_replay_batch *)buf;
+
+    key = k_spin_lock(&data->lock);
+    n = MIN(data->produced - data->consumed, (buf_len - sizeof(*batch)) / sizeof(int16_t));
+    batch->timestamp_ns = data->start_ns + (uint64_t)data->consumed * data->period_ns;
+    batch->period_ns = data->period_ns;
+    batch->count = n;
+    for (uint32_t i = 0; i < n; i++)
+        batch->samples[i] = trace_sample(data, data->consumed + i);
+    data->consumed += n;
+    k_spin_unlock(&data->lock, key);
+    rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+static int ppg_replay_get_frame_count(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+                                      uint16_t *frame_count) {
+    const struct ppg_replay_batch *batch = (const struct ppg_replay_batch *)buffer;
+
+    if (chan_spec.chan_type != SENSOR_CHAN_GREEN || chan_spec.chan_idx != 0)
+        return -ENOTSUP;
+    *frame_count = batch->count;
+    return 0;
+}
+
+static int ppg_replay_get_size_info(struct sensor_chan_spec chan_spec, size_t *base_size,
+                                    size_t *frame_size) {
+    if (chan_spec.chan_type != SENSOR_CHAN_GREEN)
+        return -ENOTSUP;
+    *base_size = sizeof(struct sensor_q31_data);
+    *frame_size = sizeof(struct sensor_q31_sample_data);
+    return 0;
+}
+
+static int ppg_replay_decode(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+                             uint32_t *fit, uint16_t max_count, void *data_out) {
+    const struct ppg_replay_batch *batch = (const struct ppg_replay_batch *)buffer;
+    struct sensor_q31_data *out = data_out;
+    uint16_t n = 0;
+
+    if (chan_spec.chan_type != SENSOR_CHAN_GREEN || chan_spec.chan_idx != 0)
+        return -ENOTSUP;
+    if (*fit >= batch->count)
+        return 0;
+    out->header.base_timestamp_ns = batch->timestamp_ns + (uint64_t)*fit * batch->period_ns;
+    out->shift = PPG_REPLAY_SHIFT;
+    for (; *fit < batch->count && n < max_count; (*fit)++, n++) {
+        out->readings[n].timestamp_delta = n * batch->period_ns;
+        out->readings[n].value = batch->samples[*fit] * (1 << (31 - PPG_REPLAY_SHIFT));
+    }
+    out->header.reading_count = n;
+    return n;
+}
+
+static bool ppg_replay_has_trigger(const uint8_t *buffer, enum sensor_trigger_type trigger) {
+    return false;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+    .get_frame_count = ppg_replay_get_frame_count,
+    .get_size_info = ppg_replay_get_size_info,
+    .decode = ppg_replay_decode,
+    .has_trigger = ppg_replay_has_trigger,
+};
+
+static int ppg_replay_get_decoder(const struct device *dev,
+                                  const struct sensor_decoder_api **decoder) {
+    *decoder = &SENSOR_DECODER_NAME();
+    return 0;
+}
+
+static DEVICE_API(sensor, ppg_replay_api) = {
+    .attr_set = ppg_replay_attr_set,
+    .attr_get = ppg_replay_attr_get,
+    .trigger_set = ppg_replay_trigger_set,
+    .sample_fetch = ppg_replay_sample_fetch,
+    .channel_get = ppg_replay_channel_get,
+    .get_decoder = ppg_replay_get_decoder,
+    .submit = ppg_replay_submit,
+};
+
+static int ppg_replay_init(const struct device *dev) {
+    const struct ppg_replay_config *cfg = dev->config;
+    struct ppg_replay_data *data = dev->data;
+
+    if (sizeof(ppg_trace) < TRACE_HEADER + 2 ||
+        memcmp(ppg_trace, TRACE_MAGIC, strlen(TRACE_MAGIC)) != 0) {
+        LOG_ERR("%s: not a PPG trace", dev->name);
+        return -EINVAL;
+    }
+    data->dev = dev;
+    data->rate_hz = sys_get_le16(&ppg_trace[4]);
+    if (!data->rate_hz || cfg->watermark > cfg->fifo_depth) {
+        LOG_ERR("%s: bad rate %u or watermark %u", dev->name, data->rate_hz, cfg->watermark);
+        return -EINVAL;
+    }
+    data->period_ns = NSEC_PER_SEC / data->rate_hz;
+    data->length = (sizeof(ppg_trace) - TRACE_HEADER) / 2;
+    k_timer_init(&data->timer, ppg_replay_tick, NULL);
+    LOG_INF("%s: %u samples at %u Hz, FIFO %u, watermark %u", dev->name, data->length,
+            data->rate_hz, cfg->fifo_depth, cfg->watermark);
+    return 0;
+}
+
+#define PPG_REPLAY_DEFINE(inst)                                                         \
+    static struct ppg_replay_data ppg_replay_data_##inst;                               \
+    static const struct ppg_replay_config ppg_replay_config_##inst = {                  \
+        .fifo_depth = DT_INST_PROP(inst, fifo_depth),                                   \
+        .watermark = DT_INST_PROP(inst, fifo_watermark),                                \
+    };                                                                                  \
+    SENSOR_DEVICE_DT_INST_DEFINE(inst, ppg_replay_init, NULL, &ppg_replay_data_##inst,  \
+                                 &ppg_replay_config_##inst, POST_KERNEL,                \
+                                 CONFIG_SENSOR_INIT_PRIORITY, &ppg_replay_api);
+
+DT_INST_FOREACH_STATUS_OKAY(PPG_REPLAY_DEFINE)
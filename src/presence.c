@@ -0,0 +1,283 @@
+// presence.c -- 周期广播在场信息的发送与同步接收
+// 发送：单独一个不可连接的扩展广播集承载周期广播，内容变化时在系统工作队列中更新数据，
+// 连接建立后把同步信息经 PAST 交给对方。
+// 接收：默认接受所有连接上的 PAST；断开后仍同步时由周期广播投递对方的心率和按钮，
+// 同步丢失时唤醒重连
+#include "presence.h"
+#include "adv_mgr.h"
+#include "energy_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include "reconnect.h"
+#include "ring_types.h"
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_presence, CONFIG_RING_LOG_LEVEL);
+
+// 周期广播间隔，1.25 ms 单位
+#define PER_ADV_INTERVAL  (CONFIG_RING_PRESENCE_INTERVAL_MS * 4 / 5)
+// 同步只经 PAST 建立，不需要被扫描发现，扩展广播放到 10.24 s
+#define EXT_ADV_INTERVAL  0x4000
+// 周期广播的 AD：长度/类型 2 + 公司 ID 2 + 在场数据
+#define PRESENCE_AD_LEN   (2 + 2 + sizeof(struct ring_presence_data))
+// 扩展广播的 AUX_ADV_IND 不带 AD，扩展头里多一个 SyncInfo
+#define SYNC_INFO_LEN     18
+// 同步超时（10 ms 单位）：连续 6 个周期收不到
+#define SYNC_TIMEOUT      (CONFIG_RING_PRESENCE_INTERVAL_MS * 6 / 10)
+
+// presence_flags 位
+enum {
+    PR_SYNCED,             // 本端已同步到对方
+    PR_PARTNER_SYNCED,     // 对方载荷表明它已同步到本端
+};
+
+static const struct ring_client_cb *presence_cb;
+static struct bt_le_ext_adv *presence_set;
+static struct k_work update_work;
+static struct k_work past_work;
+static struct k_work release_work;
+static atomic_t presence_flags;
+
+static struct {
+    uint16_t hr;
+    bool button;
+    uint8_t seq;
+    uint32_t updates;
+    uint32_t transfers;    // 发出的 PAST
+} tx;
+
+static struct {
+    struct bt_le_per_adv_sync *sync;
+    bool seq_valid;
+    struct ring_presence_data last;
+    uint32_t last_rx;
+    uint32_t reports;
+    uint32_t changes;
+    uint32_t missed;       // 按序号间隔估算的丢失更新
+} rx;
+
+// ---- 发送 ----
+
+static void update_work_handler(struct k_work *work) {
+    struct ring_presence_data d = {
+        .version = RING_PRESENCE_VERSION,
+        .seq = ++tx.seq,
+        .hr = sys_cpu_to_le16(tx.hr),
+        .flags = (tx.button ? RING_PRESENCE_BUTTON : 0) |
+                 (atomic_test_bit(&presence_flags, PR_SYNCED) ? RING_PRESENCE_SYNCED : 0),
+        .battery = get_battery_level(),
+    };
+    uint8_t buf[2 + sizeof(d)];
+    struct bt_data ad = BT_DATA(BT_DATA_MANUFACTURER_DATA, buf, sizeof(buf));
+
+    sys_put_le16(RING_ADV_COMPANY_ID, buf);
+    memcpy(&buf[2], &d, sizeof(d));
+    int err = bt_le_per_adv_set_data(presence_set, &ad, 1);
+    if (err) LOG_WRN("Presence data update failed: %d", err);
+    else tx.updates++;
+}
+
+void presence_set_hr(uint16_t hr) {
+    if (tx.hr == hr) return;
+    tx.hr = hr;
+    k_work_submit(&update_work);
+}
+
+void presence_set_button(bool pressed) {
+    if (tx.button == pressed) return;
+    tx.button = pressed;
+    k_work_submit(&update_work);
+}
+
+static void past_send(struct bt_conn *conn, void *user_data) {
+    struct bt_conn_info info;
+    if (bt_conn_get_info(conn, &info) || info.state != BT_CONN_STATE_CONNECTED) return;
+    int err = bt_le_per_adv_set_info_transfer(presence_set, conn, 0);
+    if (err) LOG_DBG("PAST failed: %d", err);
+    else tx.transfers++;
+}
+
+static void past_work_handler(struct k_work *work) {
+    bt_conn_foreach(BT_CONN_TYPE_LE, past_send, NULL);
+}
+
+static void connected(struct bt_conn *conn, uint8_t err) {
+    if (!err) k_work_submit(&past_work);
+}
+
+BT_CONN_CB_DEFINE(presence_conn_callbacks) = {
+    .connected = connected,
+};
+
+// ---- 接收 ----
+
+bool presence_linked(void) {
+    return atomic_test_bit(&presence_flags, PR_SYNCED) &&
+           atomic_test_bit(&presence_flags, PR_PARTNER_SYNCED);
+}
+
+static bool presence_parse(struct bt_data *data, void *user_data) {
+    struct ring_presence_data *out = user_data;
+
+    if (data->type != BT_DATA_MANUFACTURER_DATA || data->data_len != 2 + sizeof(*out) ||
+        sys_get_le16(data->data) != RING_ADV_COMPANY_ID)
+        return true;
+    memcpy(out, &data->data[2], sizeof(*out));
+    return false;
+}
+
+static void sync_synced(struct bt_le_per_adv_sync *sync,
+                        struct bt_le_per_adv_sync_synced_info *info) {
+    rx.sync = sync;
+    rx.seq_valid = false;
+    atomic_set_bit(&presence_flags, PR_SYNCED);
+    LOG_INF("Partner presence synced%s, interval %u ms", info->conn ? " via PAST" : "",
+            info->interval * 5 / 4);
+    // 载荷中的 SYNCED 位告诉对方可以释放链路
+    k_work_submit(&update_work);
+}
+
+static void sync_term(struct bt_le_per_adv_sync *sync,
+                      const struct bt_le_per_adv_sync_term_info *info) {
+    rx.sync = NULL;
+    atomic_clear_bit(&presence_flags, PR_SYNCED);
+    atomic_clear_bit(&presence_flags, PR_PARTNER_SYNCED);
+    LOG_INF("Partner presence lost: 0x%02x", info->reason);
+    k_work_submit(&update_work);
+    reconnect_kick();
+}
+
+// 连接存在时心率和按钮已经通过 GATT 到达，只在无连接时投递
+static void sync_recv(struct bt_le_per_adv_sync *sync,
+                      const struct bt_le_per_adv_sync_recv_info *info,
+                      struct net_buf_simple *buf) {
+    struct ring_presence_data d = { 0 };
+
+    bt_data_parse(buf, presence_parse, &d);
+    if (d.version != RING_PRESENCE_VERSION) return;
+    rx.reports++;
+    rx.last_rx = k_uptime_get_32();
+    if (d.flags & RING_PRESENCE_SYNCED) {
+        // 已在深睡时不会再有模式变化来触发释放，对方刚同步上就释放链路
+        if (!atomic_test_and_set_bit(&presence_flags, PR_PARTNER_SYNCED) &&
+            get_current_power_mode() == POWER_MODE_DEEP_SLEEP && presence_linked())
+            k_work_submit(&release_work);
+    } else {
+        atomic_clear_bit(&presence_flags, PR_PARTNER_SYNCED);
+    }
+    if (rx.seq_valid && d.seq == rx.last.seq) return;
+
+    bool button_changed = !rx.seq_valid || ((d.flags ^ rx.last.flags) & RING_PRESENCE_BUTTON);
+    if (rx.seq_valid) rx.missed += (uint8_t)(d.seq - rx.last.seq - 1);
+    rx.last = d;
+    rx.seq_valid = true;
+    rx.changes++;
+    if (central_ring.conn || peripheral_ring.conn || !presence_cb) return;
+
+    uint16_t hr = sys_le16_to_cpu(d.hr);
+    if (hr && presence_cb->hr_received) {
+        struct hr_sample sample = { .timestamp = rx.last_rx, .hr = hr };
+        presence_cb->hr_received(&sample);
+    }
+    if (button_changed && presence_cb->button_changed)
+        presence_cb->button_changed(d.flags & RING_PRESENCE_BUTTON);
+}
+
+static struct bt_le_per_adv_sync_cb sync_callbacks = {
+    .synced = sync_synced,
+    .term = sync_term,
+    .recv = sync_recv,
+};
+
+// ---- 长时间空闲时释放链路 ----
+
+static void release_conn(struct bt_conn *conn, void *user_data) {
+    bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+}
+
+static void release_work_handler(struct k_work *work) {
+    if (!presence_linked()) return;
+    LOG_INF("Partner in presence sync, releasing link");
+    bt_conn_foreach(BT_CONN_TYPE_LE, release_conn, NULL);
+}
+
+static void presence_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    if (new_mode == POWER_MODE_DEEP_SLEEP && presence_linked())
+        k_work_submit(&release_work);
+}
+
+// 载荷带电量，电量变化时也要更新
+static void presence_battery_changed(uint8_t level) {
+    k_work_submit(&update_work);
+}
+
+static struct power_mode_listener presence_power_listener = {
+    .mode_changed = presence_mode_changed,
+    .battery_changed = presence_battery_changed,
+};
+
+int presence_init(const struct ring_client_cb *cb) {
+    struct bt_le_adv_param param = BT_LE_ADV_PARAM_INIT(BT_LE_ADV_OPT_EXT_ADV,
+        EXT_ADV_INTERVAL, EXT_ADV_INTERVAL, NULL);
+    struct bt_le_per_adv_param per_param = BT_LE_PER_ADV_PARAM_INIT(
+        PER_ADV_INTERVAL, PER_ADV_INTERVAL, BT_LE_PER_ADV_OPT_NONE);
+    struct bt_le_per_adv_sync_transfer_param past_param = {
+        .skip = 0,
+        .timeout = SYNC_TIMEOUT,
+        .options = 0,
+    };
+    int err;
+
+    presence_cb = cb;
+    k_work_init(&update_work, update_work_handler);
+    k_work_init(&past_work, past_work_handler);
+    k_work_init(&release_work, release_work_handler);
+
+    err = bt_le_ext_adv_create(&param, NULL, &presence_set);
+    if (err) { LOG_ERR("Presence set create failed: %d", err); return err; }
+    err = bt_le_per_adv_set_param(presence_set, &per_param);
+    if (err) { LOG_ERR("Periodic adv param failed: %d", err); return err; }
+    update_work_handler(&update_work);
+    err = bt_le_per_adv_start(presence_set);
+    if (err) { LOG_ERR("Periodic adv start failed: %d", err); return err; }
+    energy_stats_adv(ENERGY_ADV_PERIODIC, PER_ADV_INTERVAL * 1250U,
+                     per_adv_event_airtime_us(PRESENCE_AD_LEN, false));
+    err = bt_le_ext_adv_start(presence_set, BT_LE_EXT_ADV_START_DEFAULT);
+    if (err) { LOG_ERR("Presence adv start failed: %d", err); return err; }
+    energy_stats_adv(ENERGY_ADV_PRESENCE, EXT_ADV_INTERVAL * 625U + ADV_DELAY_AVG_US,
+                     adv_event_airtime_us(SYNC_INFO_LEN, true, false));
+
+    bt_le_per_adv_sync_cb_register(&sync_callbacks);
+    err = bt_le_per_adv_sync_transfer_subscribe(NULL, &past_param);
+    if (err) { LOG_ERR("PAST subscribe failed: %d", err); return err; }
+    power_mode_listener_register(&presence_power_listener);
+    LOG_INF("Presence train every %u ms", CONFIG_RING_PRESENCE_INTERVAL_MS);
+    return 0;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_presence(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "TX seq %u, hr %u, button %u, %u updates, %u PAST sent", tx.seq, tx.hr,
+                tx.button, tx.updates, tx.transfers);
+    if (!atomic_test_bit(&presence_flags, PR_SYNCED)) {
+        shell_print(sh, "Partner not synced");
+        return 0;
+    }
+    shell_print(sh, "RX seq %u, hr %u, button %u, battery %u%%, %u ms ago%s", rx.last.seq,
+                sys_le16_to_cpu(rx.last.hr), !!(rx.last.flags & RING_PRESENCE_BUTTON),
+                rx.last.battery, k_uptime_get_32() - rx.last_rx,
+                presence_linked() ? ", linked" : "");
+    shell_print(sh, "%u reports, %u changes, %u missed", rx.reports, rx.changes, rx.missed);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ring), presence, NULL, "Periodic advertising presence", cmd_presence, 1, 0);
+#endif
@@ -0,0 +1,650 @@
+// reconnect.c -- 寻找对方戒指：广播、扫描与断线重连
+// 角色选举：身份地址较小的一端做 central，较大的一端做 peripheral，双方结论互补，
+// 因此不会建立随后又要因重复而断开的连接。未绑定时两端都扫描和广播，但只有地址
+// 较小的一端发起连接
+// 阶段：
+//   BURST_FAST  意外断线后：central 全占空比接受列表自动建连，peripheral 高占空比定向广播
+//   BURST_LOW   随后 5 s 降为低占空比
+//   SEARCH      central 扫描一个窗口（有绑定时用接受列表自动建连，否则按戒指标识过滤扫描），
+//               扫描占空比随功耗模式变化（scan_profile_get），模式切换时立即按新参数重启扫描
+//   BACKOFF     central 关闭扫描，按功耗模式和电量档位指数退避；
+//   STOPPED     低电量下退避次数用尽，全部关闭，直到用户活动
+//   PRESENCE    双方已互相同步周期广播（presence.c），全部关闭，直到同步丢失或用户活动
+// peripheral 在 SEARCH/BACKOFF 中持续慢速广播（adv_mgr.c，间隔随功耗模式，不超过 1.05 s；
+// 有绑定时为低占空比定向广播，否则为带戒指标识的非定向广播），间隔随退避次数加倍，
+// 不超过 2 s。central 的搜索窗口覆盖两个未退避的广播间隔、至少一个退避后的间隔，
+// 两端无需对齐时间。CONFIG_RING_SCAN_CODED 时同时扫描 Coded PHY
+// 控制器的接受列表装入全部绑定对端，开启隐私时由解析列表匹配其可解析地址；
+// 运行中新绑定的对端在工作项中射频全部关闭后加入，失败时重试
+// 广播/扫描的启停只在工作项中进行，连接回调只切换期望状态，避免并发操作控制器
+#include "reconnect.h"
+#include "adv_mgr.h"
+#include "conn_params.h"
+#include "energy_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include "presence.h"
+#include "ring_types.h"
+#include <bluetooth/scan.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gap.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+LOG_MODULE_REGISTER(ring_reconnect, CONFIG_RING_LOG_LEVEL);
+
+#define RECONNECT_BURST_FAST_MS   1280    // 高占空比定向广播的规范上限
+#define RECONNECT_BURST_LOW_MS    5000
+#define RECONNECT_SEARCH_MS       2100    // 覆盖两个最慢的广播间隔
+#define RECONNECT_RETRY_MS        100     // 连接对象尚未回收等情况下重试
+#define ACCEPT_LIST_RETRIES       20      // 空闲时加入接受列表的重试次数
+#define ADV_DELAY_MAX_MS          10      // advDelay 上限
+
+BUILD_ASSERT(ADV_BACKOFF_INTERVAL_MAX * 625 / 1000 + ADV_DELAY_MAX_MS < RECONNECT_SEARCH_MS,
+             "backed-off beacon must fit in one search window");
+
+// 接受列表自动建连的扫描间隔/窗口（0.625 ms 单位）
+#define AUTO_CONN_INTERVAL_FAST   0x0060  // 60 ms，全占空比
+#define AUTO_CONN_WINDOW_FAST     0x0060
+#define AUTO_CONN_INTERVAL_SLOW   0x01E0  // 300 ms
+#define AUTO_CONN_WINDOW_SLOW     0x0030  // 30 ms，10% 占空比
+
+enum reconnect_phase {
+    PHASE_IDLE,
+    PHASE_BURST_FAST,
+    PHASE_BURST_LOW,
+    PHASE_SEARCH,
+    PHASE_BACKOFF,
+    PHASE_STOPPED,
+    PHASE_PRESENCE,
+};
+
+enum link_role {
+    ROLE_CENTRAL,
+    ROLE_PERIPHERAL,
+    ROLE_ANY,          // 未绑定：两种角色都做，按地址决定是否发起连接
+};
+
+enum adv_mode { ADV_OFF, ADV_DIRECTED_HIGH, ADV_DIRECTED_LOW, ADV_BEACON };
+// SCAN_AUTO 与 SCAN_FILTER（按戒指标识过滤）按功耗模式的扫描档位运行
+enum scan_mode { SCAN_OFF, SCAN_AUTO_FAST, SCAN_AUTO_SLOW, SCAN_AUTO, SCAN_FILTER };
+
+// rc.flags 位
+enum {
+    RC_ACTIVE,         // 期望寻找对方
+    RC_RESTART,        // 从头开始（启动或断线）
+    RC_BURST,          // 重新开始时先做快速重连
+    RC_ACTIVITY,       // 用户活动，重置退避
+    RC_PROFILE,        // 功耗模式变化，按新档位重启扫描
+    RC_ACCEPT_LIST,    // 对方需加入接受列表
+};
+
+static const char * const phase_names[] = {
+    "idle", "burst", "burst low duty", "search", "backoff", "stopped", "presence"
+};
+static const char * const role_names[] = { "central", "peripheral", "any" };
+
+static struct k_work_delayable reconnect_work;
+static struct reconnect_stats stats;
+
+static struct {
+    atomic_t flags;                 // 任意上下文写
+    uint32_t search_start;          // 本轮寻找开始时间
+    // 以下仅在工作项中访问
+    enum reconnect_phase phase;
+    uint32_t phase_start;
+    uint32_t next_delay;            // 当前阶段时长
+    uint32_t attempt;               // 本轮已退避次数
+    bool retry;
+    uint8_t accept_retries;         // 加入接受列表连续失败的次数
+    enum adv_mode adv;
+    enum scan_mode scan;
+    power_mode_t scan_power;        // 当前扫描所用档位对应的功耗模式
+    // 定向广播的目标：最近连接过的绑定对端
+    bool partner_valid;
+    bt_addr_le_t partner;
+    bt_addr_le_t own;               // 本机身份地址
+} rc;
+
+// 双方用同一规则比较，结果互补；无法解析的可解析私有地址无从比较，照常发起连接
+static bool role_is_central(const bt_addr_le_t *peer) {
+    if (peer->type == BT_ADDR_LE_RANDOM && BT_ADDR_IS_RPA(&peer->a))
+        return true;
+    return bt_addr_le_cmp(&rc.own, peer) < 0;
+}
+
+static enum link_role partner_role(void) {
+    if (!rc.partner_valid)
+        return ROLE_ANY;
+    return role_is_central(&rc.partner) ? ROLE_CENTRAL : ROLE_PERIPHERAL;
+}
+
+// ---- 绑定对端与接受列表 ----
+
+static void bond_add(const struct bt_bond_info *info, void *user_data) {
+    int err = bt_le_filter_accept_list_add(&info->addr);
+    if (err) LOG_WRN("Accept list add failed: %d", err);
+    if (!rc.partner_valid) {
+        bt_addr_le_copy(&rc.partner, &info->addr);
+        rc.partner_valid = true;
+    }
+}
+
+// 在连接回调中调用：此时另一角色的广播或扫描可能仍在运行，接受列表留给工作项修改
+static void partner_set(const bt_addr_le_t *addr) {
+    char str[BT_ADDR_LE_STR_LEN];
+
+    if (rc.partner_valid && bt_addr_le_eq(&rc.partner, addr))
+        return;
+    bt_addr_le_copy(&rc.partner, addr);
+    rc.partner_valid = true;
+    bt_addr_le_to_str(addr, str, sizeof(str));
+    LOG_INF("Partner for directed reconnect: %s, role %s", str,
+            role_is_central(addr) ? "central" : "peripheral");
+    atomic_set_bit(&rc.flags, RC_ACCEPT_LIST);
+    // 寻找中的工作项会在下一次关闭射频时加入；已停止时唤醒它
+    if (!atomic_test_bit(&rc.flags, RC_ACTIVE))
+        k_work_reschedule(&reconnect_work, K_NO_WAIT);
+}
+
+// ---- 广播与扫描 ----
+
+// prev 为之前的广播模式：低占空比定向之后接慢速广播时不再快速广播
+static int adv_start(enum adv_mode mode, enum adv_mode prev) {
+    switch (mode) {
+    case ADV_DIRECTED_HIGH:
+        return adv_mgr_start(ADV_MGR_DIRECTED_HIGH, &rc.partner, false);
+    case ADV_DIRECTED_LOW:
+        return adv_mgr_start(ADV_MGR_DIRECTED_LOW, &rc.partner, false);
+    case ADV_BEACON:
+        return adv_mgr_start(ADV_MGR_BEACON, rc.partner_valid ? &rc.partner : NULL,
+                             prev != ADV_DIRECTED_LOW);
+    default:
+        return 0;
+    }
+}
+
+static bool scan_profiled(enum scan_mode mode) {
+    return mode == SCAN_AUTO || mode == SCAN_FILTER;
+}
+
+// 开启 Coded PHY 时扫描窗口在 1M 与 Coded 间平分，总接收占空比不变
+static uint16_t scan_window_1m(uint16_t window) {
+    return IS_ENABLED(CONFIG_RING_SCAN_CODED) ? window / 2 : window;
+}
+
+static int scan_start(enum scan_mode mode) {
+    struct bt_conn_le_create_param param = BT_CONN_LE_CREATE_PARAM_INIT(
+        BT_CONN_LE_OPT_NONE, AUTO_CONN_INTERVAL_FAST, AUTO_CONN_WINDOW_FAST);
+    struct bt_le_scan_param scan_param = {
+        .type = BT_LE_SCAN_TYPE_PASSIVE,
+        .options = BT_LE_SCAN_OPT_FILTER_DUPLICATE,
+    };
+    const struct scan_profile *profile = scan_profile_get(get_current_power_mode());
+    uint16_t interval, window;
+    int err;
+
+    switch (mode) {
+    case SCAN_AUTO_SLOW:
+        param.interval = AUTO_CONN_INTERVAL_SLOW;
+        param.window = AUTO_CONN_WINDOW_SLOW;
+        break;
+    case SCAN_AUTO:
+    case SCAN_FILTER:
+        param.interval = profile->interval;
+        param.window = profile->window;
+        rc.scan_power = get_current_power_mode();
+        break;
+    case SCAN_AUTO_FAST:
+        break;
+    default:
+        return 0;
+    }
+    interval = param.interval;
+    window = param.window;
+    param.window = scan_window_1m(window);
+    if (IS_ENABLED(CONFIG_RING_SCAN_CODED)) {
+        param.options |= BT_CONN_LE_OPT_CODED;
+        param.interval_coded = interval;
+        param.window_coded = window - param.window;
+    }
+
+    if (mode == SCAN_FILTER) {
+        scan_param.interval = param.interval;
+        scan_param.window = param.window;
+        if (IS_ENABLED(CONFIG_RING_SCAN_CODED)) {
+            scan_param.options |= BT_LE_SCAN_OPT_CODED;
+            scan_param.interval_coded = param.interval_coded;
+            scan_param.window_coded = param.window_coded;
+        }
+        bt_scan_params_set(&scan_param);
+        err = bt_scan_start(BT_SCAN_TYPE_SCAN_PASSIVE);
+    } else {
+        err = bt_conn_le_create_auto(&param, conn_params_for_mode(get_current_power_mode()));
+    }
+    if (err) {
+        LOG_WRN("Scan start failed: %d", err);
+        return err;
+    }
+    LOG_DBG("Scanning started (%d), %u/%u", mode, window, interval);
+    energy_stats_scan(interval, window);
+    return 0;
+}
+
+static void adv_stop(void) {
+    if (rc.adv != ADV_OFF) adv_mgr_stop();
+    rc.adv = ADV_OFF;
+}
+
+static void scan_stop(void) {
+    if (rc.scan == SCAN_FILTER) bt_scan_stop();
+    else if (rc.scan != SCAN_OFF) bt_conn_create_auto_stop();
+    if (rc.scan != SCAN_OFF) energy_stats_scan(0, 0);
+    rc.scan = SCAN_OFF;
+}
+
+// 只启停发生变化的部分，慢速广播跨阶段保持
+static int radio_apply(enum adv_mode adv, enum scan_mode scan) {
+    int err = 0;
+
+    if (rc.adv != adv) {
+        enum adv_mode prev = rc.adv;
+        adv_stop();
+        err = adv_start(adv, prev);
+        if (!err) rc.adv = adv;
+    }
+    if (rc.scan != scan) {
+        scan_stop();
+        int serr = scan_start(scan);
+        if (!serr) rc.scan = scan;
+        else if (!err) err = serr;
+    }
+    return err;
+}
+
+static void radio_off(void) {
+    adv_stop();
+    scan_stop();
+}
+
+// 只在广播、扫描和自动建连都已停止时修改接受列表。仍需重试时返回 true
+static bool accept_list_apply(void) {
+    int err;
+
+    if (!atomic_test_bit(&rc.flags, RC_ACCEPT_LIST))
+        return false;
+    if (rc.adv != ADV_OFF || rc.scan != SCAN_OFF)
+        return true;
+    err = bt_le_filter_accept_list_add(&rc.partner);
+    if (!err) {
+        LOG_DBG("Partner added to accept list");
+    } else if (++rc.accept_retries < ACCEPT_LIST_RETRIES) {
+        LOG_DBG("Accept list add: %d, retrying", err);
+        return true;
+    } else {
+        LOG_WRN("Accept list add failed: %d", err);
+    }
+    rc.accept_retries = 0;
+    atomic_clear_bit(&rc.flags, RC_ACCEPT_LIST);
+    return false;
+}
+
+// 空闲、停止和在场同步中射频全关且工作项不再排期，失败时定时重试
+static void accept_list_retry(void) {
+    if (accept_list_apply())
+        k_work_schedule(&reconnect_work, K_MSEC(RECONNECT_RETRY_MS));
+}
+
+// ---- 阶段 ----
+
+// 低电量状态取功耗管理的判断，与进入超低功耗用同一个迟滞
+static const struct reconnect_profile *current_profile(void) {
+    return reconnect_profile_get(get_current_power_mode(),
+                                 battery_band_get(get_battery_low(), get_battery_level()));
+}
+
+static void phase_enter(enum reconnect_phase phase) {
+    enum link_role role = partner_role();
+    enum adv_mode adv = ADV_OFF;
+    enum scan_mode scan = SCAN_OFF;
+    uint32_t delay = 0;
+    int err;
+
+    if (phase != rc.phase || !rc.retry)
+        LOG_INF("Reconnect phase: %s (%s)", phase_names[phase], role_names[role]);
+    rc.phase = phase;
+    rc.phase_start = k_uptime_get_32();
+    rc.retry = false;
+
+    switch (phase) {
+    case PHASE_BURST_FAST:
+        adv = role == ROLE_PERIPHERAL ? ADV_DIRECTED_HIGH : ADV_OFF;
+        scan = role == ROLE_CENTRAL ? SCAN_AUTO_FAST : SCAN_OFF;
+        delay = RECONNECT_BURST_FAST_MS;
+        stats.attempts++;
+        break;
+    case PHASE_BURST_LOW:
+        adv = role == ROLE_PERIPHERAL ? ADV_DIRECTED_LOW : ADV_OFF;
+        scan = role == ROLE_CENTRAL ? SCAN_AUTO_SLOW : SCAN_OFF;
+        delay = RECONNECT_BURST_LOW_MS;
+        break;
+    case PHASE_SEARCH:
+        adv = role == ROLE_CENTRAL ? ADV_OFF : ADV_BEACON;
+        scan = role == ROLE_CENTRAL ? SCAN_AUTO : role == ROLE_ANY ? SCAN_FILTER : SCAN_OFF;
+        delay = RECONNECT_SEARCH_MS;
+        stats.attempts++;
+        break;
+    case PHASE_BACKOFF:
+        delay = reconnect_backoff_ms(current_profile(), rc.attempt);
+        if (delay == UINT32_MAX) {
+            // 电量低且对方久寻不见：停止一切射频，等用户操作
+            LOG_INF("Reconnect paused after %u attempts until user activity", rc.attempt);
+            stats.paused++;
+            rc.phase = PHASE_STOPPED;
+            radio_off();
+            accept_list_retry();
+            return;
+        }
+        rc.attempt++;
+        adv = role == ROLE_CENTRAL ? ADV_OFF : ADV_BEACON;
+        LOG_DBG("Reconnect backoff %u ms (attempt %u)", delay, rc.attempt);
+        break;
+    default:
+        radio_off();
+        accept_list_retry();
+        return;
+    }
+
+    // 慢速广播跟随退避次数放慢，重新开始或用户活动后恢复
+    if (adv == ADV_BEACON)
+        adv_mgr_backoff(rc.attempt);
+    err = radio_apply(adv, scan);
+    // central 的退避阶段射频全关，未完成的接受列表修改在此补上
+    accept_list_apply();
+    if (err == -ENOMEM || err == -EBUSY || err == -EAGAIN) {
+        // 上一条连接的对象还未回收，稍后重进本阶段
+        rc.retry = true;
+        if (phase == PHASE_BACKOFF) rc.attempt--;
+        delay = RECONNECT_RETRY_MS;
+    }
+    rc.next_delay = delay;
+    k_work_schedule(&reconnect_work, K_MSEC(delay));
+}
+
+static void reconnect_work_handler(struct k_work *work) {
+    if (!atomic_test_bit(&rc.flags, RC_ACTIVE)) {
+        radio_off();
+        rc.phase = PHASE_IDLE;
+        accept_list_retry();
+        return;
+    }
+    if (atomic_test_and_clear_bit(&rc.flags, RC_RESTART)) {
+        atomic_clear_bit(&rc.flags, RC_ACTIVITY);
+        rc.attempt = 0;
+        rc.retry = false;
+        radio_off();
+        accept_list_apply();
+        bool burst = atomic_test_and_clear_bit(&rc.flags, RC_BURST) && rc.partner_valid;
+        if (presence_linked())
+            phase_enter(PHASE_PRESENCE);
+        else
+            phase_enter(burst ? PHASE_BURST_FAST : PHASE_SEARCH);
+        return;
+    }
+    if (atomic_test_and_clear_bit(&rc.flags, RC_ACTIVITY)) {
+        rc.attempt = 0;
+        if (rc.phase == PHASE_PRESENCE) {
+            // 在场同步期间不算寻找时间
+            rc.search_start = k_uptime_get_32();
+            phase_enter(PHASE_SEARCH);
+            return;
+        }
+        if (rc.phase == PHASE_BACKOFF || rc.phase == PHASE_STOPPED) {
+            LOG_INF("User activity, reconnect backoff reset");
+            if (rc.adv == ADV_BEACON) adv_mgr_burst();
+            phase_enter(PHASE_SEARCH);
+            return;
+        }
+    }
+    if (rc.retry) {
+        phase_enter(rc.phase);
+        return;
+    }
+    if (atomic_test_and_clear_bit(&rc.flags, RC_PROFILE)) {
+        uint32_t elapsed = k_uptime_get_32() - rc.phase_start;
+        if (scan_profiled(rc.scan) && rc.scan_power != get_current_power_mode()) {
+            enum scan_mode scan = rc.scan;
+            scan_stop();
+            if (!scan_start(scan)) rc.scan = scan;
+        }
+        // 阶段定时器被本次唤醒取消，按剩余时长重新排期
+        if (rc.phase == PHASE_STOPPED || rc.phase == PHASE_PRESENCE) {
+            accept_list_retry();
+            return;
+        }
+        if (elapsed < rc.next_delay) {
+            k_work_schedule(&reconnect_work, K_MSEC(rc.next_delay - elapsed));
+            return;
+        }
+    }
+    switch (rc.phase) {
+    case PHASE_BURST_FAST:
+        phase_enter(PHASE_BURST_LOW);
+        break;
+    case PHASE_BURST_LOW:
+    case PHASE_BACKOFF:
+        phase_enter(PHASE_SEARCH);
+        break;
+    case PHASE_SEARCH:
+        phase_enter(PHASE_BACKOFF);
+        break;
+    default:
+        accept_list_retry();
+        break;
+    }
+}
+
+static void reconnect_begin(bool burst) {
+    rc.search_start = k_uptime_get_32();
+    if (burst)
+        atomic_set_bit(&rc.flags, RC_BURST);
+    atomic_set_bit(&rc.flags, RC_RESTART);
+    atomic_set_bit(&rc.flags, RC_ACTIVE);
+    k_work_reschedule(&reconnect_work, K_NO_WAIT);
+}
+
+void reconnect_start(void) {
+    if (atomic_test_bit(&rc.flags, RC_ACTIVE))
+        return;
+    reconnect_begin(true);
+}
+
+// 对端主动断开或本端断开属于预期，不做快速重连
+static bool link_loss_unexpected(uint8_t reason) {
+    switch (reason) {
+    case BT_HCI_ERR_REMOTE_USER_TERM_CONN:
+    case BT_HCI_ERR_LOCALHOST_TERM_CONN:
+    case BT_HCI_ERR_REMOTE_POWER_OFF:
+    case BT_HCI_ERR_REMOTE_LOW_RESOURCES:
+        return false;
+    default:
+        return true;
+    }
+}
+
+void reconnect_link_lost(uint8_t reason) {
+    reconnect_begin(link_loss_unexpected(reason));
+}
+
+void reconnect_stop(void) {
+    if (!atomic_test_and_clear_bit(&rc.flags, RC_ACTIVE))
+        return;
+    uint32_t ms = k_uptime_get_32() - rc.search_start;
+    stats.reconnects++;
+    stats.last_ms = ms;
+    stats.total_ms += ms;
+    if (ms > stats.max_ms) stats.max_ms = ms;
+    LOG_INF("Reconnected after %u ms", ms);
+    k_work_reschedule(&reconnect_work, K_NO_WAIT);
+}
+
+void reconnect_get_stats(struct reconnect_stats *out) {
+    *out = stats;
+}
+
+// 只置位并唤醒工作项，退避状态由工作项判断
+void reconnect_kick(void) {
+    if (!atomic_test_bit(&rc.flags, RC_ACTIVE) ||
+        (rc.phase != PHASE_BACKOFF && rc.phase != PHASE_STOPPED && rc.phase != PHASE_PRESENCE))
+        return;
+    if (!atomic_test_and_set_bit(&rc.flags, RC_ACTIVITY))
+        k_work_reschedule(&reconnect_work, K_NO_WAIT);
+}
+
+static void reconnect_user_activity(void) {
+    reconnect_kick();
+}
+
+static void reconnect_mode_changed(power_mode_t old_mode, power_mode_t new_mode) {
+    if (!scan_profiled(rc.scan))
+        return;
+    if (!atomic_test_and_set_bit(&rc.flags, RC_PROFILE))
+        k_work_reschedule(&reconnect_work, K_NO_WAIT);
+}
+
+static struct power_mode_listener reconnect_power_listener = {
+    .mode_changed = reconnect_mode_changed,
+    .user_activity = reconnect_user_activity,
+};
+
+// ---- 扫描回调（非定向阶段，按戒指标识过滤后按角色选举决定是否建连） ----
+
+static void scan_filter_match(struct bt_scan_device_info *device_info,
+                              struct bt_scan_filter_match *filter_match, bool connectable) {
+    char addr[BT_ADDR_LE_STR_LEN];
+    const bt_addr_le_t *peer;
+    struct bt_conn *conn;
+    int err;
+
+    if (!device_info || !device_info->recv_info) return;
+    peer = device_info->recv_info->addr;
+    bt_addr_le_to_str(peer, addr, sizeof(addr));
+    LOG_DBG("Device found: %s, connectable: %s, RSSI: %d", addr, connectable ? "yes" : "no",
+            device_info->recv_info->rssi);
+    if (!connectable || central_ring.conn)
+        return;
+    if (!role_is_central(peer)) {
+        // 对方地址较小，由对方发起连接，本端继续广播等待
+        LOG_DBG("Leaving connection to %s", addr);
+        return;
+    }
+    bt_scan_stop();
+    err = bt_conn_le_create(peer, BT_CONN_LE_CREATE_CONN,
+                            conn_params_for_mode(get_current_power_mode()), &conn);
+    if (err) {
+        LOG_WRN("Conn attempt failed: %d", err);
+        return;
+    }
+    central_ring.conn = conn;
+    LOG_INF("Conn initiated");
+}
+
+BT_SCAN_CB_INIT(scan_cb, scan_filter_match, NULL, NULL, NULL);
+
+// ---- 连接与绑定事件 ----
+
+static void connected(struct bt_conn *conn, uint8_t conn_err) {
+    const bt_addr_le_t *dst = bt_conn_get_dst(conn);
+    if (!conn_err && bt_addr_le_is_bonded(BT_ID_DEFAULT, dst))
+        partner_set(dst);
+}
+
+// 首次配对后地址已更新为身份地址
+static void security_changed(struct bt_conn *conn, bt_security_t level, enum bt_security_err err) {
+    const bt_addr_le_t *dst = bt_conn_get_dst(conn);
+    if (!err && bt_addr_le_is_bonded(BT_ID_DEFAULT, dst))
+        partner_set(dst);
+}
+
+BT_CONN_CB_DEFINE(reconnect_conn_callbacks) = {
+    .connected = connected,
+    .security_changed = security_changed,
+};
+
+static void bond_deleted(uint8_t id, const bt_addr_le_t *peer) {
+    bt_le_filter_accept_list_remove(peer);
+    if (rc.partner_valid && bt_addr_le_eq(&rc.partner, peer)) {
+        rc.partner_valid = false;
+        bt_foreach_bond(BT_ID_DEFAULT, bond_add, NULL);
+    }
+}
+
+static struct bt_conn_auth_info_cb reconnect_auth_info = {
+    .bond_deleted = bond_deleted,
+};
+
+int reconnect_init(void) {
+    static uint8_t ring_id_bytes[] = { RING_ADV_ID_BYTES };
+    struct bt_scan_manufacturer_data ring_id = {
+        .data = ring_id_bytes,
+        .data_len = sizeof(ring_id_bytes),
+    };
+    // 匹配后由 scan_filter_match 按角色选举自行建连；扫描参数在每次开始时按档位设置
+    const struct scan_profile *profile = scan_profile_get(get_current_power_mode());
+    struct bt_le_scan_param scan_param = {
+        .type = BT_LE_SCAN_TYPE_PASSIVE,
+        .options = BT_LE_SCAN_OPT_FILTER_DUPLICATE,
+        .interval = profile->interval,
+        .window = profile->window,
+    };
+    struct bt_scan_init_param param = {
+        .scan_param = &scan_param,
+        .conn_param = conn_params_for_mode(get_current_power_mode()),
+        .connect_if_match = 0,
+    };
+    size_t id_count = CONFIG_BT_ID_MAX;
+    bt_addr_le_t ids[CONFIG_BT_ID_MAX];
+    int err;
+
+    bt_id_get(ids, &id_count);
+    if (id_count)
+        bt_addr_le_copy(&rc.own, &ids[BT_ID_DEFAULT]);
+
+    err = adv_mgr_init();
+    if (err) return err;
+    k_work_init_delayable(&reconnect_work, reconnect_work_handler);
+    power_mode_listener_register(&reconnect_power_listener);
+    bt_scan_init(&param);
+    bt_scan_cb_register(&scan_cb);
+    err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_MANUFACTURER_DATA, &ring_id);
+    if (err) { LOG_ERR("Scan filter add failed: %d", err); return err; }
+    bt_scan_filter_enable(BT_SCAN_MANUFACTURER_DATA_FILTER, false);
+
+    bt_foreach_bond(BT_ID_DEFAULT, bond_add, NULL);
+    if (rc.partner_valid)
+        LOG_INF("Bonded partner found, using directed reconnect");
+    return bt_conn_auth_info_cb_register(&reconnect_auth_info);
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_reconnect(const struct shell *sh, size_t argc, char **argv) {
+    const struct reconnect_profile *p = current_profile();
+
+    shell_print(sh, "Phase %s, role %s, attempt %u, phase %u/%u ms", phase_names[rc.phase],
+                role_names[partner_role()], rc.attempt, k_uptime_get_32() - rc.phase_start,
+                rc.next_delay);
+    shell_print(sh, "Backoff %u..%u ms, limit %u attempts", p->base_ms, p->max_ms, p->max_attempts);
+    const struct scan_profile *sp = scan_profile_get(get_current_power_mode());
+    shell_print(sh, "Scan profile %u/%u (x0.625 ms)%s, scanning: %s", sp->window, sp->interval,
+                IS_ENABLED(CONFIG_RING_SCAN_CODED) ? ", 1M + Coded" : "", rc.scan ? "yes" : "no");
+    shell_print(sh, "%u attempts, %u reconnects, last %u ms, avg %u ms, max %u ms, %u paused",
+                stats.attempts, stats.reconnects, stats.last_ms,
+                stats.reconnects ? stats.total_ms / stats.reconnects : 0, stats.max_ms, stats.paused);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ring), reconnect, NULL, "Reconnect scheduler state and counters", cmd_reconnect, 1, 0);
+#endif
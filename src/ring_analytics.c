@@ -0,0 +1,235 @@
+// ring_analytics.c -- 戒指纯逻辑实现，不依赖蓝牙协议栈和内核
+#include "ring_analytics.h"
+#include <stdlib.h>
+
+// 锂聚合物电池小电流放电曲线 (mV, %)，按电压降序
+static const struct {
+    uint16_t mv;
+    uint8_t soc;
+} battery_curve[] = {
+    { 4200, 100 }, { 4100, 92 }, { 4000, 81 }, { 3900, 70 },
+    { 3800, 56 },  { 3700, 40 }, { 3650, 28 }, { 3600, 18 },
+    { 3500, 8 },   { 3400, 3 },  { 3300, 0 },
+};
+
+static const char * const distance_str[] = {
+    "Unknown", "Very Close", "Close", "Medium", "Far", "Very Far"
+};
+
+bool ring_tunables_valid(const struct ring_tunables *t) {
+    for (int i = 1; i < RSSI_THRESHOLD_COUNT; i++) {
+        if (t->rssi_threshold[i] >= t->rssi_threshold[i - 1])
+            return false;
+    }
+    if (t->power_threshold_ms[0] == 0 ||
+        t->power_threshold_ms[1] <= t->power_threshold_ms[0] ||
+        t->power_threshold_ms[2] <= t->power_threshold_ms[1])
+        return false;
+    return t->hr_sync_threshold > 0;
+}
+
+// 基于 RSSI 估算距离等级
+distance_level_t estimate_distance(const struct ring_tunables *t, int8_t rssi) {
+    for (int i = 0; i < RSSI_THRESHOLD_COUNT; i++) {
+        if (rssi >= t->rssi_threshold[i])
+            return (distance_level_t)(DISTANCE_VERY_CLOSE + i);
+    }
+    return DISTANCE_VERY_FAR;
+}
+
+const char *distance_level_str(distance_level_t level) {
+    return ((unsigned)level < sizeof(distance_str) / sizeof(distance_str[0])) ? distance_str[level] : "?";
+}
+
+power_mode_t power_policy_target_mode(const struct ring_tunables *t, uint32_t idle_time_ms) {
+    if (idle_time_ms > t->power_threshold_ms[2])
+        return POWER_MODE_DEEP_SLEEP;
+    else if (idle_time_ms > t->power_threshold_ms[1])
+        return POWER_MODE_SLEEP;
+    else if (idle_time_ms > t->power_threshold_ms[0])
+        return POWER_MODE_IDLE;
+    else
+        return POWER_MODE_ACTIVE;
+}
+
+uint32_t power_policy_next_deadline(const struct ring_tunables *t, uint32_t idle_time_ms) {
+    // 策略使用 “>” 比较，因此在阈值之后 1 ms 才切换
+    for (size_t i = 0; i < 3; i++) {
+        if (idle_time_ms <= t->power_threshold_ms[i])
+            return t->power_threshold_ms[i] - idle_time_ms + 1;
+    }
+    return UINT32_MAX;
+}
+
+uint8_t battery_soc_from_mv(uint16_t mv) {
+    const size_t n = sizeof(battery_curve) / sizeof(battery_curve[0]);
+    if (mv >= battery_curve[0].mv)
+        return battery_curve[0].soc;
+    for (size_t i = 1; i < n; i++) {
+        if (mv >= battery_curve[i].mv) {
+            uint32_t span_mv = battery_curve[i - 1].mv - battery_curve[i].mv;
+            uint32_t span_soc = battery_curve[i - 1].soc - battery_curve[i].soc;
+            return battery_curve[i].soc + (uint8_t)(((mv - battery_curve[i].mv) * span_soc) / span_mv);
+        }
+    }
+    return 0;
+}
+
+bool battery_low_state(bool low, uint8_t level) {
+    if (low)
+        return level < BATTERY_LOW_EXIT_LEVEL;
+    return level <= BATTERY_LOW_ENTER_LEVEL;
+}
+
+enum battery_band battery_band_get(bool low, uint8_t level) {
+    if (low)
+        return BATTERY_BAND_LOW;
+    return level <= BATTERY_REDUCED_LEVEL ? BATTERY_BAND_REDUCED : BATTERY_BAND_NORMAL;
+}
+
+// 越空闲、电量越低，退避越慢；低电量时有限次数后放弃，等用户操作再找
+static const struct reconnect_profile reconnect_profiles[4][BATTERY_BAND_COUNT] = {
+    [POWER_MODE_ACTIVE] = {
+        { 2000, 30000, 0 }, { 4000, 60000, 0 }, { 10000, 300000, 20 },
+    },
+    [POWER_MODE_IDLE] = {
+        { 5000, 60000, 0 }, { 10000, 120000, 0 }, { 30000, 600000, 12 },
+    },
+    [POWER_MODE_SLEEP] = {
+        { 10000, 300000, 0 }, { 20000, 600000, 0 }, { 60000, 1800000, 8 },
+    },
+    [POWER_MODE_DEEP_SLEEP] = {
+        { 30000, 900000, 0 }, { 60000, 1800000, 40 }, { 120000, 3600000, 4 },
+    },
+};
+
+const struct reconnect_profile *reconnect_profile_get(power_mode_t mode, enum battery_band band) {
+    if ((unsigned)mode > POWER_MODE_DEEP_SLEEP)
+        mode = POWER_MODE_DEEP_SLEEP;
+    if ((unsigned)band >= BATTERY_BAND_COUNT)
+        band = BATTERY_BAND_LOW;
+    return &reconnect_profiles[mode][band];
+}
+
+uint32_t reconnect_backoff_ms(const struct reconnect_profile *p, uint32_t attempt) {
+    if (p->max_attempts && attempt >= p->max_attempts)
+        return UINT32_MAX;
+    // 移位前先判断，避免溢出
+    if (attempt >= 31 || p->base_ms > (p->max_ms >> attempt))
+        return p->max_ms;
+    return p->base_ms << attempt;
+}
+
+// 窗口都不短于 30 ms，至少覆盖一次三信道广播事件
+static const struct scan_profile scan_profiles[4] = {
+    [POWER_MODE_ACTIVE]     = { 0x0060, 0x0060 },   // 60/60 ms，100%
+    [POWER_MODE_IDLE]       = { 0x00A0, 0x0050 },   // 100/50 ms，50%
+    [POWER_MODE_SLEEP]      = { 0x0140, 0x0050 },   // 200/50 ms，25%
+    [POWER_MODE_DEEP_SLEEP] = { 0x0280, 0x0050 },   // 400/50 ms，12.5%
+};
+
+const struct scan_profile *scan_profile_get(power_mode_t mode) {
+    if ((unsigned)mode > POWER_MODE_DEEP_SLEEP)
+        mode = POWER_MODE_DEEP_SLEEP;
+    return &scan_profiles[mode];
+}
+
+uint32_t scan_rx_ms(uint16_t interval, uint16_t window, uint32_t elapsed_ms) {
+    if (!interval)
+        return 0;
+    if (window > interval)
+        window = interval;
+    return (uint32_t)((uint64_t)elapsed_ms * window / interval);
+}
+
+static const struct adv_profile adv_profiles[4] = {
+    [POWER_MODE_ACTIVE]     = { 0x0140, 0x0150 },   // 200-210 ms
+    [POWER_MODE_IDLE]       = { 0x0320, 0x0340 },   // 500-520 ms
+    [POWER_MODE_SLEEP]      = { 0x0640, 0x0690 },   // 1000-1050 ms
+    [POWER_MODE_DEEP_SLEEP] = { 0x0640, 0x0690 },
+};
+
+const struct adv_profile *adv_profile_get(power_mode_t mode) {
+    if ((unsigned)mode > POWER_MODE_DEEP_SLEEP)
+        mode = POWER_MODE_DEEP_SLEEP;
+    return &adv_profiles[mode];
+}
+
+static uint16_t adv_interval_backoff(uint16_t interval, uint32_t attempt) {
+    if (interval >= ADV_BACKOFF_INTERVAL_MAX)
+        return interval;
+    // 移位前先判断，避免溢出
+    if (attempt >= 16 || interval > (ADV_BACKOFF_INTERVAL_MAX >> attempt))
+        return ADV_BACKOFF_INTERVAL_MAX;
+    return (uint16_t)(interval << attempt);
+}
+
+struct adv_profile adv_profile_backoff(const struct adv_profile *p, uint32_t attempt) {
+    struct adv_profile out = {
+        .interval_min = adv_interval_backoff(p->interval_min, attempt),
+        .interval_max = adv_interval_backoff(p->interval_max, attempt),
+    };
+    return out;
+}
+
+#define ADV_RAMP_US 40   // 每次发射的射频启动时间
+
+// 一个 PDU 的空口时间：1M 为前导码 1 + 接入地址 4 + 头 2 + 载荷 + CRC 3 字节，每字节 8 µs；
+// Coded S=8 为 FEC 块 1 固定 376 µs，其后每字节 64 µs，再加 TERM2 24 µs
+static uint32_t pdu_airtime_us(uint32_t len, bool coded) {
+    if (coded)
+        return 376 + (2 + len + 3) * 64 + 24 + ADV_RAMP_US;
+    return (1 + 4 + 2 + len + 3) * 8 + ADV_RAMP_US;
+}
+
+uint32_t adv_event_airtime_us(uint8_t payload, bool extended, bool coded) {
+    if (!extended)
+        return 3 * pdu_airtime_us(6 + payload, false);
+    // ADV_EXT_IND：扩展头长度/模式 1 + 标志 1 + ADI 2 + AuxPtr 3；
+    // AUX_ADV_IND：扩展头长度/模式 1 + 标志 1 + AdvA 6 + ADI 2，之后为载荷
+    return 3 * pdu_airtime_us(7, coded) + pdu_airtime_us(10 + payload, coded);
+}
+
+uint32_t per_adv_event_airtime_us(uint8_t payload, bool coded) {
+    // AUX_SYNC_IND：扩展头长度/模式 1（无扩展头字段），之后为 AD 数据
+    return pdu_airtime_us(1 + payload, coded);
+}
+
+#define LL_T_IFS_US 150
+
+// 数据包：前导码 + 接入地址 4 + 头 2 + 载荷 + MIC 4 + CRC 3；空包无 MIC。2M 前导码 2 字节
+static uint32_t ll_pdu_us(uint32_t len, bool mic, bool phy_2m) {
+    uint32_t bytes = (phy_2m ? 2 : 1) + 4 + 2 + len + (mic ? 4 : 0) + 3;
+    return bytes * (phy_2m ? 4 : 8);
+}
+
+uint32_t bulk_airtime_us(uint32_t sdu_bytes, uint32_t sdus, uint16_t mps, uint16_t ll_octets,
+                         bool phy_2m) {
+    // 每个 SDU 首帧带 2 字节 SDU 长度，每个 K 帧带 4 字节基本头
+    uint32_t payload = sdu_bytes + 2 * sdus;
+    uint32_t kframes, frame, frags, pdus, pdu_len;
+
+    if (!payload || !mps || !ll_octets)
+        return 0;
+    kframes = (payload + mps - 1) / mps;
+    frame = payload / kframes + 4;
+    frags = (frame + ll_octets - 1) / ll_octets;
+    pdus = kframes * frags;
+    pdu_len = (payload + 4 * kframes) / pdus;
+    return pdus * (ll_pdu_us(pdu_len, true, phy_2m) + ll_pdu_us(0, false, phy_2m) +
+                   2 * LL_T_IFS_US);
+}
+
+// RR 间期只在 ACTIVE 下记录，其余模式只留平均心率和稀疏的 HRV 指标
+static const struct history_profile history_profiles[4] = {
+    [POWER_MODE_ACTIVE]     = { 10, 300, 60, true },
+    [POWER_MODE_IDLE]       = { 60, 300, 300, false },
+    [POWER_MODE_SLEEP]      = { 300, 900, 900, false },
+    [POWER_MODE_DEEP_SLEEP] = { 900, 3600, 0, false },
+};
+
+const struct history_profile *history_profile_get(power_mode_t mode) {
+    if ((unsigned)mode > POWER_MODE_DEEP_SLEEP)
+        mode = POWER_MODE_DEEP_SLEEP;
+    return &history_profiles[mode];
+}
@@ -0,0 +1,577 @@
+// ring_client.c -- 对方戒指 HRS/LBS 的 GATT 客户端
+// 建连后先按 UUID 读对端 Database Hash（一次 ATT 往返）：
+//   命中缓存：直接使用缓存句柄；对端已按绑定保存 CCC，只在本地登记订阅，不写 CCC
+//   未命中：  一次主服务发现找出 HRS、LBS 的句柄范围，再在各自范围内做属性发现，
+//             找齐所需句柄即提前结束；读传感器位置，写 CCC 订阅；绑定后写入缓存
+// 所有 ATT 操作经 gatt_ops 排队，一次只有一个在途；建链步骤在连接时一次性入队，
+// 各步骤按缓存命中与否自行跳过，加密等事件重复触发也不会重复入队
+#include "ring_client.h"
+#include "gatt_cache.h"
+#include "gatt_ops.h"
+#include "ring_types.h"
+#include <bluetooth/services/lbs.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_client, CONFIG_RING_LOG_LEVEL);
+
+#define BUTTON_DEBOUNCE_MS 70
+
+// Heart Rate Measurement 标志位
+#define HRM_FLAG_VALUE_16BIT  BIT(0)
+#define HRM_FLAG_ENERGY       BIT(3)
+#define HRM_FLAG_RR           BIT(4)
+
+static const char * const sensor_location_str[] = {
+    "Other", "Chest", "Wrist", "Finger", "Hand", "Ear lobe", "Foot"
+};
+
+// 订阅参数在绑定链路断开后仍留在主机的订阅列表中（非易失），不能随连接清零
+struct client_sub {
+    struct bt_gatt_subscribe_params params;
+    bool registered;
+    bt_addr_le_t peer;
+};
+
+struct svc_range {
+    uint16_t start;
+    uint16_t end;
+};
+
+static const struct ring_client_cb *client_cb;
+static struct ring_client_stats stats;
+static struct client_sub hr_sub, button_sub;
+
+static struct {
+    struct bt_conn *conn;
+    struct gatt_ops ops;
+    bool hash_valid;
+    bool from_cache;
+    bool write_ccc;         // 订阅时是否需要写 CCC
+    bool setup_failed;
+    bool setup_retried;
+    bool ready_reported;
+    bool cache_pending;     // 发现完成，等待绑定后写入缓存
+    struct gatt_cache_entry entry;
+    struct svc_range hrs_range;
+    struct svc_range lbs_range;
+    uint16_t *pending_ccc;  // 属性发现中下一个 CCC 所属的特征
+    uint32_t connect_time;
+    bool first_notify_seen;
+    // 同一时刻只有一个操作在途，读/发现/写参数可共用
+    struct bt_gatt_read_params read_params;
+    struct bt_gatt_discover_params discover_params;
+    struct bt_gatt_write_params write_params;
+    uint8_t write_buf[2];
+    atomic_t led_value;
+    uint32_t last_button_time;
+} client;
+
+static void cache_commit(void) {
+    const bt_addr_le_t *peer = bt_conn_get_dst(client.conn);
+    if (!client.cache_pending || !bt_addr_le_is_bonded(BT_ID_DEFAULT, peer))
+        return;
+    client.cache_pending = false;
+    int err = gatt_cache_store(peer, &client.entry);
+    if (err)
+        LOG_WRN("GATT cache store failed: %d", err);
+    else
+        LOG_INF("GATT cache stored");
+}
+
+// ---- 通知 ----
+
+static int hr_measurement_parse(const uint8_t *data, uint16_t len, struct hr_sample *sample) {
+    uint16_t off = 1;
+
+    if (len < 2)
+        return -EINVAL;
+    uint8_t flags = data[0];
+    if (flags & HRM_FLAG_VALUE_16BIT) {
+        if (len < 3) return -EINVAL;
+        sample->hr = sys_get_le16(&data[off]);
+        off += 2;
+    } else {
+        sample->hr = data[off++];
+    }
+    if (flags & HRM_FLAG_ENERGY)
+        off += 2;
+    sample->rr_count = 0;
+    if ((flags & HRM_FLAG_RR) && off < len) {
+        uint16_t n = (len - off) / 2;
+        sample->rr_count = MIN(n, HR_SAMPLE_RR_MAX);
+        for (int i = 0; i < sample->rr_count; i++)
+            sample->rr[i] = sys_get_le16(&data[off + 2 * i]);
+    }
+    return sample->hr ? 0 : -EINVAL;
+}
+
+static uint8_t hr_notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+                            const void *data, uint16_t length) {
+    struct hr_sample sample = { .timestamp = k_uptime_get_32() };
+
+    if (!data) {
+        hr_sub.registered = false;
+        central_ring.hrs_ready = false;
+        return BT_GATT_ITER_STOP;
+    }
+    if (conn == client.conn && !client.first_notify_seen) {
+        uint32_t ms = sample.timestamp - client.connect_time;
+        client.first_notify_seen = true;
+        if (client.from_cache)
+            stats.first_notify_hit_ms = ms;
+        else
+            stats.first_notify_miss_ms = ms;
+        LOG_INF("First HR notification %u ms after connect (%s)", ms,
+                client.from_cache ? "cached" : "discovered");
+    }
+    if (client_cb && client_cb->hr_received)
+        client_cb->hr_received(hr_measurement_parse(data, length, &sample) ? NULL : &sample);
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t button_notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+                                const void *data, uint16_t length) {
+    uint32_t now = k_uptime_get_32();
+
+    if (!data) {
+        button_sub.registered = false;
+        central_ring.lbs_ready = false;
+        LOG_WRN("Button sub removed");
+        return BT_GATT_ITER_STOP;
+    }
+    if (length < 1 || now - client.last_button_time < BUTTON_DEBOUNCE_MS)
+        return BT_GATT_ITER_CONTINUE;
+    client.last_button_time = now;
+    if (client_cb && client_cb->button_changed)
+        client_cb->button_changed(((const uint8_t *)data)[0] != 0);
+    return BT_GATT_ITER_CONTINUE;
+}
+
+// ---- Database Hash ----
+
+// 按 UUID 读取，不需要事先知道句柄
+static uint8_t db_hash_read_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_read_params *params,
+                               const void *data, uint16_t length) {
+    struct gatt_cache_entry cached;
+
+    if (conn != client.conn)
+        return BT_GATT_ITER_STOP;
+    if (!err && data && length == GATT_CACHE_HASH_LEN) {
+        memcpy(client.entry.db_hash, data, GATT_CACHE_HASH_LEN);
+        client.hash_valid = true;
+    }
+    if (client.hash_valid && !gatt_cache_find(bt_conn_get_dst(conn), &cached) &&
+        !memcmp(cached.db_hash, client.entry.db_hash, GATT_CACHE_HASH_LEN)) {
+        client.entry = cached;
+        client.from_cache = true;
+        client.write_ccc = false;
+        stats.cache_hits++;
+        LOG_INF("GATT cache hit, skipping discovery");
+    } else {
+        client.from_cache = false;
+        client.write_ccc = true;
+        stats.cache_misses++;
+        LOG_INF("GATT cache miss%s, discovering", client.hash_valid ? "" : " (no DB hash)");
+    }
+    // 读失败不影响后续步骤，按未命中处理
+    gatt_ops_complete(&client.ops, conn, 0);
+    return BT_GATT_ITER_STOP;
+}
+
+static int start_hash_read(struct bt_conn *conn) {
+    memset(&client.read_params, 0, sizeof(client.read_params));
+    client.read_params.func = db_hash_read_cb;
+    client.read_params.handle_count = 0;
+    client.read_params.by_uuid.uuid = BT_UUID_GATT_DB_HASH;
+    client.read_params.by_uuid.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    client.read_params.by_uuid.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    return bt_gatt_read(conn, &client.read_params);
+}
+
+// ---- 发现 ----
+
+static uint8_t service_discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                   struct bt_gatt_discover_params *params) {
+    if (conn != client.conn)
+        return BT_GATT_ITER_STOP;
+    if (!attr) {
+        gatt_ops_complete(&client.ops, conn, 0);
+        return BT_GATT_ITER_STOP;
+    }
+    const struct bt_gatt_service_val *svc = attr->user_data;
+    struct svc_range *range = NULL;
+
+    if (!bt_uuid_cmp(svc->uuid, BT_UUID_HRS))
+        range = &client.hrs_range;
+    else if (!bt_uuid_cmp(svc->uuid, BT_UUID_LBS))
+        range = &client.lbs_range;
+    if (range) {
+        range->start = attr->handle;
+        range->end = svc->end_handle;
+    }
+    // 两个服务都已找到时不再请求剩余的主服务
+    if (client.hrs_range.start && client.lbs_range.start) {
+        gatt_ops_complete(&client.ops, conn, 0);
+        return BT_GATT_ITER_STOP;
+    }
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static int start_service_discovery(struct bt_conn *conn) {
+    if (client.from_cache)
+        return GATT_OP_DONE;
+    memset(&client.hrs_range, 0, sizeof(client.hrs_range));
+    memset(&client.lbs_range, 0, sizeof(client.lbs_range));
+    memset(&client.discover_params, 0, sizeof(client.discover_params));
+    client.discover_params.func = service_discover_cb;
+    client.discover_params.type = BT_GATT_DISCOVER_PRIMARY;
+    client.discover_params.uuid = NULL;
+    client.discover_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    client.discover_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    return bt_gatt_discover(conn, &client.discover_params);
+}
+
+static bool hrs_complete(void) {
+    return client.entry.hrs_measurement && client.entry.hrs_measurement_ccc &&
+           client.entry.hrs_location;
+}
+
+static bool lbs_complete(void) {
+    return client.entry.lbs_button && client.entry.lbs_button_ccc && client.entry.lbs_led;
+}
+
+// 属性发现（Find Information）只返回句柄和类型，值句柄的类型即特征 UUID，
+// CCC 归属于它之前最近的一个需要订阅的特征
+static uint8_t attr_discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                struct bt_gatt_discover_params *params) {
+    if (conn != client.conn)
+        return BT_GATT_ITER_STOP;
+    if (!attr) {
+        gatt_ops_complete(&client.ops, conn, 0);
+        return BT_GATT_ITER_STOP;
+    }
+    if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CHRC)) {
+        client.pending_ccc = NULL;
+    } else if (!bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CCC)) {
+        if (client.pending_ccc)
+            *client.pending_ccc = attr->handle;
+        client.pending_ccc = NULL;
+    } else if (!bt_uuid_cmp(attr->uuid, BT_UUID_HRS_MEASUREMENT)) {
+        client.entry.hrs_measurement = attr->handle;
+        client.pending_ccc = &client.entry.hrs_measurement_ccc;
+    } else if (!bt_uuid_cmp(attr->uuid, BT_UUID_HRS_BODY_SENSOR)) {
+        client.entry.hrs_location = attr->handle;
+    } else if (!bt_uuid_cmp(attr->uuid, BT_UUID_LBS_BUTTON)) {
+        client.entry.lbs_button = attr->handle;
+        client.pending_ccc = &client.entry.lbs_button_ccc;
+    } else if (!bt_uuid_cmp(attr->uuid, BT_UUID_LBS_LED)) {
+        client.entry.lbs_led = attr->handle;
+    }
+    if (params->end_handle == client.hrs_range.end ? hrs_complete() : lbs_complete()) {
+        gatt_ops_complete(&client.ops, conn, 0);
+        return BT_GATT_ITER_STOP;
+    }
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static int start_attr_discovery(struct bt_conn *conn, const struct svc_range *range, const char *name) {
+    if (client.from_cache)
+        return GATT_OP_DONE;
+    if (!range->start) {
+        LOG_WRN("%s not found", name);
+        return GATT_OP_DONE;
+    }
+    client.pending_ccc = NULL;
+    memset(&client.discover_params, 0, sizeof(client.discover_params));
+    client.discover_params.func = attr_discover_cb;
+    client.discover_params.type = BT_GATT_DISCOVER_ATTRIBUTE;
+    client.discover_params.start_handle = range->start + 1;
+    client.discover_params.end_handle = range->end;
+    return bt_gatt_discover(conn, &client.discover_params);
+}
+
+static int start_hrs_discovery(struct bt_conn *conn) {
+    return start_attr_discovery(conn, &client.hrs_range, "HRS");
+}
+
+static int start_lbs_discovery(struct bt_conn *conn) {
+    return start_attr_discovery(conn, &client.lbs_range, "LBS");
+}
+
+// ---- 读取 ----
+
+static uint8_t location_read_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_read_params *params,
+                                const void *data, uint16_t length) {
+    if (conn != client.conn)
+        return BT_GATT_ITER_STOP;
+    if (!err && data && length >= 1)
+        client.entry.sensor_location = ((const uint8_t *)data)[0];
+    else
+        LOG_WRN("HRS location read failed: %d", err);
+    if (client.entry.sensor_location < ARRAY_SIZE(sensor_location_str))
+        LOG_INF("HRS location: %s", sensor_location_str[client.entry.sensor_location]);
+    gatt_ops_complete(&client.ops, conn, 0);
+    return BT_GATT_ITER_STOP;
+}
+
+static int start_location_read(struct bt_conn *conn) {
+    if (client.from_cache || !client.entry.hrs_location)
+        return GATT_OP_DONE;
+    memset(&client.read_params, 0, sizeof(client.read_params));
+    client.read_params.func = location_read_cb;
+    client.read_params.handle_count = 1;
+    client.read_params.single.handle = client.entry.hrs_location;
+    return bt_gatt_read(conn, &client.read_params);
+}
+
+// ---- 订阅 ----
+
+static void write_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_write_params *params) {
+    gatt_ops_complete(&client.ops, conn, err);
+}
+
+static void subscribe_cb(struct bt_conn *conn, uint8_t err, struct bt_gatt_subscribe_params *params) {
+    // 写 CCC 失败时主机已将其移出订阅列表
+    if (err)
+        CONTAINER_OF(params, struct client_sub, params)->registered = false;
+    gatt_ops_complete(&client.ops, conn, err);
+}
+
+// 返回 0 表示 ATT 写已发出；GATT_OP_DONE 表示只在本地登记
+static int sub_register(struct bt_conn *conn, struct client_sub *s, uint16_t value, uint16_t ccc,
+                        bt_gatt_notify_func_t fn) {
+    const bt_addr_le_t *peer = bt_conn_get_dst(conn);
+    int err;
+
+    if (s->registered && !bt_addr_le_eq(&s->peer, peer))
+        return -EADDRINUSE;
+    if (!s->registered)
+        memset(&s->params, 0, sizeof(s->params));
+    // 已登记的参数仍在主机链表中，只原地更新句柄
+    s->params.notify = fn;
+    s->params.subscribe = subscribe_cb;
+    s->params.value = BT_GATT_CCC_NOTIFY;
+    s->params.value_handle = value;
+    s->params.ccc_handle = ccc;
+
+    if (!s->registered) {
+        err = client.write_ccc ? bt_gatt_subscribe(conn, &s->params)
+                               : bt_gatt_resubscribe(BT_ID_DEFAULT, peer, &s->params);
+        if (err && err != -EALREADY)
+            return err;
+        s->registered = true;
+        bt_addr_le_copy(&s->peer, peer);
+        return client.write_ccc && !err ? 0 : GATT_OP_DONE;
+    }
+    if (!client.write_ccc)
+        return GATT_OP_DONE;
+    sys_put_le16(BT_GATT_CCC_NOTIFY, client.write_buf);
+    client.write_params.handle = ccc;
+    client.write_params.offset = 0;
+    client.write_params.data = client.write_buf;
+    client.write_params.length = sizeof(uint16_t);
+    client.write_params.func = write_cb;
+    return bt_gatt_write(conn, &client.write_params);
+}
+
+static int start_hr_subscribe(struct bt_conn *conn) {
+    if (!client.entry.hrs_measurement || !client.entry.hrs_measurement_ccc)
+        return GATT_OP_DONE;
+    int err = sub_register(conn, &hr_sub, client.entry.hrs_measurement,
+                           client.entry.hrs_measurement_ccc, hr_notify_cb);
+    if (err >= 0) {
+        central_ring.hrs_ready = true;
+        LOG_INF("Subscribed HR");
+    }
+    return err;
+}
+
+static int start_button_subscribe(struct bt_conn *conn) {
+    if (!client.entry.lbs_button || !client.entry.lbs_button_ccc)
+        return GATT_OP_DONE;
+    int err = sub_register(conn, &button_sub, client.entry.lbs_button,
+                           client.entry.lbs_button_ccc, button_notify_cb);
+    if (err >= 0) {
+        central_ring.lbs_ready = true;
+        LOG_INF("Subscribed to button");
+    }
+    return err;
+}
+
+// ---- LED ----
+
+static int start_led_write(struct bt_conn *conn) {
+    if (!client.entry.lbs_led)
+        return -ENOENT;
+    // 排队期间的多次写入合并为最新状态
+    client.write_buf[0] = atomic_get(&client.led_value) ? 1 : 0;
+    client.write_params.handle = client.entry.lbs_led;
+    client.write_params.offset = 0;
+    client.write_params.data = client.write_buf;
+    client.write_params.length = 1;
+    client.write_params.func = write_cb;
+    return bt_gatt_write(conn, &client.write_params);
+}
+
+// ---- 操作表 ----
+
+static const struct gatt_op op_hash = { "DB hash read", start_hash_read, 0 };
+static const struct gatt_op op_services = { "service discovery", start_service_discovery, 0 };
+static const struct gatt_op op_hrs = { "HRS discovery", start_hrs_discovery, 0 };
+static const struct gatt_op op_lbs = { "LBS discovery", start_lbs_discovery, 0 };
+static const struct gatt_op op_location = { "HRS location read", start_location_read, 0 };
+// 订阅写入对端的绑定状态，等加密完成后再发起，避免未加密时写入被拒后重试
+static const struct gatt_op op_sub_hr = { "HR subscribe", start_hr_subscribe, GATT_OP_F_ENCRYPTED };
+static const struct gatt_op op_sub_button = { "button subscribe", start_button_subscribe,
+                                              GATT_OP_F_ENCRYPTED };
+static const struct gatt_op op_led = { "LED write", start_led_write, 0 };
+
+static const struct gatt_op * const setup_ops[] = {
+    &op_hash, &op_services, &op_hrs, &op_lbs, &op_location, &op_sub_hr, &op_sub_button,
+};
+
+static void setup_submit(void) {
+    client.setup_failed = false;
+    client.ready_reported = false;
+    for (int i = 0; i < ARRAY_SIZE(setup_ops); i++)
+        gatt_ops_submit(&client.ops, setup_ops[i]);
+}
+
+static void ops_failed(const struct gatt_op *op, int err) {
+    if (op != &op_led)
+        client.setup_failed = true;
+}
+
+static void ops_idle(void) {
+    if (client.ready_reported || !client.conn)
+        return;
+    // 因加密前被拒等原因失败的步骤，加密后整体重排一次
+    if (client.setup_failed && !client.setup_retried &&
+        bt_conn_get_security(client.conn) >= BT_SECURITY_L2) {
+        client.setup_retried = true;
+        LOG_INF("Retrying GATT setup");
+        setup_submit();
+        return;
+    }
+    client.ready_reported = true;
+    stats.setup_att_ops = client.ops.stats.att_ops;
+    stats.setup_retries = client.ops.stats.retries;
+    LOG_INF("Partner GATT %s in %u ms, %u ATT ops, %u retries",
+            client.setup_failed ? "incomplete" : "ready", k_uptime_get_32() - client.connect_time,
+            stats.setup_att_ops, stats.setup_retries);
+    if (!client.setup_failed && !client.from_cache && client.hash_valid) {
+        client.cache_pending = true;
+        cache_commit();
+    }
+}
+
+void ring_client_start(struct bt_conn *conn) {
+    if (client.conn == conn)
+        return;
+    if (client.conn)
+        bt_conn_unref(client.conn);
+    client.conn = bt_conn_ref(conn);
+    client.hash_valid = false;
+    client.from_cache = false;
+    client.write_ccc = true;
+    client.cache_pending = false;
+    client.setup_retried = false;
+    memset(&client.entry, 0, sizeof(client.entry));
+    client.entry.sensor_location = GATT_CACHE_LOCATION_UNKNOWN;
+    client.connect_time = k_uptime_get_32();
+    client.first_notify_seen = false;
+    gatt_ops_attach(&client.ops, conn);
+    if (bt_conn_get_security(conn) >= BT_SECURITY_L2)
+        gatt_ops_set_encrypted(&client.ops);
+    LOG_INF("Starting GATT setup...");
+    setup_submit();
+}
+
+int ring_client_led_write(bool on) {
+    if (!client.conn || !client.entry.lbs_led || !central_ring.lbs_ready)
+        return -EAGAIN;
+    atomic_set(&client.led_value, on);
+    return gatt_ops_submit(&client.ops, &op_led);
+}
+
+void ring_client_get_stats(struct ring_client_stats *out) {
+    *out = stats;
+}
+
+// ---- 连接与配对事件 ----
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    if (conn != client.conn) return;
+    gatt_ops_detach(&client.ops);
+    bt_conn_unref(client.conn);
+    client.conn = NULL;
+}
+
+// 加密结果确定（成功或失败）后放行订阅；不重新入队，进行中的步骤不受影响
+static void security_changed(struct bt_conn *conn, bt_security_t level, enum bt_security_err err) {
+    if (conn != client.conn) return;
+    gatt_ops_set_encrypted(&client.ops);
+    if (!err && level >= BT_SECURITY_L2)
+        cache_commit();
+}
+
+BT_CONN_CB_DEFINE(ring_client_conn_callbacks) = {
+    .disconnected = disconnected,
+    .security_changed = security_changed,
+};
+
+static void pairing_complete(struct bt_conn *conn, bool bonded) {
+    if (conn != client.conn) return;
+    if (client.from_cache) {
+        // 重新配对意味着对端丢失了我们的 CCC 配置，缓存句柄仍有效，只需补写 CCC
+        client.write_ccc = true;
+        gatt_ops_submit(&client.ops, &op_sub_hr);
+        gatt_ops_submit(&client.ops, &op_sub_button);
+    }
+    if (bonded)
+        cache_commit();
+}
+
+static void bond_deleted(uint8_t id, const bt_addr_le_t *peer) {
+    gatt_cache_delete(peer);
+}
+
+static struct bt_conn_auth_info_cb ring_client_auth_info = {
+    .pairing_complete = pairing_complete,
+    .bond_deleted = bond_deleted,
+};
+
+int ring_client_init(const struct ring_client_cb *cb) {
+    client_cb = cb;
+    gatt_ops_init(&client.ops, ops_failed, ops_idle);
+    return bt_conn_auth_info_cb_register(&ring_client_auth_info);
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_gatt(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "Cache: %d entries, %u hits, %u misses", gatt_cache_count(),
+                stats.cache_hits, stats.cache_misses);
+    shell_print(sh, "Connect to first HR notification: cached %u ms, discovered %u ms",
+                stats.first_notify_hit_ms, stats.first_notify_miss_ms);
+    shell_print(sh, "Last setup: %u ATT ops, %u retries", stats.setup_att_ops, stats.setup_retries);
+    return 0;
+}
+
+static int cmd_gatt_clear(const struct shell *sh, size_t argc, char **argv) {
+    gatt_cache_delete(NULL);
+    shell_print(sh, "GATT cache cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(gatt_cmds,
+    SHELL_CMD(clear, NULL, "Forget cached handles", cmd_gatt_clear),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), gatt, &gatt_cmds, "GATT discovery cache", cmd_gatt, 1, 0);
+#endif
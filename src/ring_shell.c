@@ -0,0 +1,6 @@
+// ring_shell.c -- `ring` shell 命令组根节点
+// 各模块在自己的源文件中用 SHELL_SUBCMD_ADD((ring), ...) 挂载子命令
+#include <zephyr/shell/shell.h>
+
+SHELL_SUBCMD_SET_CREATE(ring_cmds, (ring));
+SHELL_CMD_REGISTER(ring, &ring_cmds, "Smart ring commands", NULL);
@@ -0,0 +1,172 @@
+// ring_tune.c -- 运行时可调参数与持久化
+// 参数整体以一个 blob 保存；固件改变结构布局后长度不符，旧值被忽略并使用默认值
+#include "ring_tune.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(ring_tune, CONFIG_RING_LOG_LEVEL);
+
+#define RING_TUNE_KEY "ring/tune"
+
+static struct ring_tunables tunables = RING_TUNABLES_DEFAULT;
+static struct ring_tunables loaded;
+static bool loaded_valid;
+static sys_slist_t tune_listeners = SYS_SLIST_STATIC_INIT(&tune_listeners);
+
+const struct ring_tunables *ring_tune_get(void) {
+    return &tunables;
+}
+
+static void tune_apply(const struct ring_tunables *t) {
+    // 读取方在线程/工作队列中直接访问，拷贝期间禁止线程切换，避免读到一半的参数
+    k_sched_lock();
+    tunables = *t;
+    k_sched_unlock();
+    struct ring_tune_listener *listener;
+    SYS_SLIST_FOR_EACH_CONTAINER(&tune_listeners, listener, node) {
+        listener->changed(&tunables);
+    }
+}
+
+int ring_tune_set(const struct ring_tunables *t) {
+    if (!ring_tunables_valid(t))
+        return -EINVAL;
+    tune_apply(t);
+    int err = settings_save_one(RING_TUNE_KEY, &tunables, sizeof(tunables));
+    if (err)
+        LOG_WRN("Tune save failed: %d", err);
+    return err;
+}
+
+int ring_tune_reset(void) {
+    static const struct ring_tunables defaults = RING_TUNABLES_DEFAULT;
+    tune_apply(&defaults);
+    return settings_delete(RING_TUNE_KEY);
+}
+
+void ring_tune_listener_register(struct ring_tune_listener *listener) {
+    sys_slist_append(&tune_listeners, &listener->node);
+}
+
+static int tune_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    const char *next;
+
+    if (!settings_name_steq(name, "tune", &next) || next)
+        return -ENOENT;
+    if (len != sizeof(loaded)) {
+        LOG_WRN("Stored tune has a different layout, using defaults");
+        return 0;
+    }
+    ssize_t rc = read_cb(cb_arg, &loaded, sizeof(loaded));
+    if (rc < 0)
+        return rc;
+    loaded_valid = ring_tunables_valid(&loaded);
+    if (!loaded_valid)
+        LOG_WRN("Stored tune is inconsistent, using defaults");
+    return 0;
+}
+
+// 所有设置加载完成后一次性生效，监听器只收到一次通知
+static int tune_settings_commit(void) {
+    if (loaded_valid) {
+        tune_apply(&loaded);
+        LOG_INF("Tune loaded from settings");
+    }
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ring_tune, "ring", NULL, tune_settings_set, tune_settings_commit, NULL);
+
+#if defined(CONFIG_SHELL)
+static const char * const mode_names[] = { "active", "idle", "sleep", "deep_sleep" };
+
+static int cmd_tune_show(const struct shell *sh, size_t argc, char **argv) {
+    const struct ring_tunables *t = ring_tune_get();
+    shell_print(sh, "rssi      %d %d %d %d dBm", t->rssi_threshold[0], t->rssi_threshold[1],
+                t->rssi_threshold[2], t->rssi_threshold[3]);
+    shell_print(sh, "hr_sync   %u bpm", t->hr_sync_threshold);
+    shell_print(sh, "power     idle %u, sleep %u, deep_sleep %u ms", t->power_threshold_ms[0],
+                t->power_threshold_ms[1], t->power_threshold_ms[2]);
+    for (size_t i = 0; i < ARRAY_SIZE(t->rssi_interval_ms); i++)
+        shell_print(sh, "interval  %-10s %u ms", mode_names[i], t->rssi_interval_ms[i]);
+    return 0;
+}
+
+// 解析 argv[1..n] 为整数，任一失败则整条命令不生效
+static int parse_args(const struct shell *sh, size_t argc, char **argv, long *out, long min, long max) {
+    int err = 0;
+    for (size_t i = 1; i < argc; i++) {
+        out[i - 1] = shell_strtol(argv[i], 10, &err);
+        if (err || out[i - 1] < min || out[i - 1] > max) {
+            shell_error(sh, "Invalid value: %s", argv[i]);
+            return -EINVAL;
+        }
+    }
+    return 0;
+}
+
+static int tune_commit(const struct shell *sh, const struct ring_tunables *t) {
+    int err = ring_tune_set(t);
+    if (err == -EINVAL)
+        shell_error(sh, "Rejected: RSSI thresholds must decrease, power thresholds increase");
+    else if (err)
+        shell_warn(sh, "Applied but not saved: %d", err);
+    return err == -EINVAL ? err : 0;
+}
+
+static int cmd_tune_rssi(const struct shell *sh, size_t argc, char **argv) {
+    struct ring_tunables t = *ring_tune_get();
+    long v[RSSI_THRESHOLD_COUNT];
+    if (parse_args(sh, argc, argv, v, -127, 20)) return -EINVAL;
+    for (int i = 0; i < RSSI_THRESHOLD_COUNT; i++)
+        t.rssi_threshold[i] = (int8_t)v[i];
+    return tune_commit(sh, &t);
+}
+
+static int cmd_tune_hr_sync(const struct shell *sh, size_t argc, char **argv) {
+    struct ring_tunables t = *ring_tune_get();
+    long v[1];
+    if (parse_args(sh, argc, argv, v, 1, 100)) return -EINVAL;
+    t.hr_sync_threshold = (uint8_t)v[0];
+    return tune_commit(sh, &t);
+}
+
+static int cmd_tune_power(const struct shell *sh, size_t argc, char **argv) {
+    struct ring_tunables t = *ring_tune_get();
+    long v[3];
+    if (parse_args(sh, argc, argv, v, 1, 86400000)) return -EINVAL;
+    for (int i = 0; i < 3; i++)
+        t.power_threshold_ms[i] = (uint32_t)v[i];
+    return tune_commit(sh, &t);
+}
+
+static int cmd_tune_interval(const struct shell *sh, size_t argc, char **argv) {
+    struct ring_tunables t = *ring_tune_get();
+    long v[4];
+    if (parse_args(sh, argc, argv, v, 0, 3600000)) return -EINVAL;
+    for (int i = 0; i < 4; i++)
+        t.rssi_interval_ms[i] = (uint32_t)v[i];
+    return tune_commit(sh, &t);
+}
+
+static int cmd_tune_reset(const struct shell *sh, size_t argc, char **argv) {
+    int err = ring_tune_reset();
+    if (err && err != -ENOENT)
+        shell_warn(sh, "Defaults applied, delete failed: %d", err);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(tune_cmds,
+    SHELL_CMD_ARG(rssi, NULL, "<very_close> <close> <medium> <far> dBm", cmd_tune_rssi, 5, 0),
+    SHELL_CMD_ARG(hr_sync, NULL, "<bpm>", cmd_tune_hr_sync, 2, 0),
+    SHELL_CMD_ARG(power, NULL, "<idle_ms> <sleep_ms> <deep_sleep_ms>", cmd_tune_power, 4, 0),
+    SHELL_CMD_ARG(interval, NULL, "<active_ms> <idle_ms> <sleep_ms> <deep_sleep_ms> (0 = off)",
+                  cmd_tune_interval, 5, 0),
+    SHELL_CMD(reset, NULL, "Restore defaults", cmd_tune_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((ring), tune, &tune_cmds, "Show or change runtime tunables", cmd_tune_show, 1, 0);
+#endif
@@ -0,0 +1,113 @@
+// rssi_filter.c -- 可插拔 RSSI 滤波引擎实现，不依赖蓝牙协议栈和内核
+#include "rssi_filter.h"
+#include <string.h>
+
+#define Q8_ONE 256
+
+static const char * const mode_str[] = {
+    "Boxcar", "EMA", "Median", "Kalman"
+};
+
+// Q8 四舍五入到整数 dBm
+static int8_t q8_to_dbm(int32_t v) {
+    return (int8_t)((v >= 0) ? (v + Q8_ONE / 2) / Q8_ONE : (v - Q8_ONE / 2) / Q8_ONE);
+}
+
+void rssi_filter_init(struct rssi_filter *filter, rssi_filter_mode_t mode) {
+    memset(filter, 0, sizeof(*filter));
+    filter->mode = mode;
+}
+
+void rssi_filter_set_mode(struct rssi_filter *filter, rssi_filter_mode_t mode) {
+    rssi_filter_init(filter, mode);
+}
+
+// 中值窗口：移除最旧样本并插入新样本，保持有序（窗口长度固定，上限 15）
+static void median_update(struct rssi_filter *filter, int8_t old, int8_t rssi) {
+    int8_t *s = filter->sorted;
+    uint8_t n = filter->count;
+
+    if (n == RSSI_FILTER_WINDOW) {
+        uint8_t i = 0;
+        while (i < n - 1 && s[i] != old) i++;
+        for (; i < n - 1; i++) s[i] = s[i + 1];
+        n--;
+    }
+    uint8_t j = n;
+    while (j > 0 && s[j - 1] > rssi) {
+        s[j] = s[j - 1];
+        j--;
+    }
+    s[j] = rssi;
+}
+
+static void kalman_update(struct rssi_filter *filter, int8_t rssi) {
+    int32_t z = (int32_t)rssi * Q8_ONE;
+
+    if (filter->count == 0) {
+        filter->kalman.x_q8 = z;
+        filter->kalman.p_q8 = RSSI_FILTER_KALMAN_R;
+        return;
+    }
+    // 预测：P += Q；更新：K = P/(P+R), x += K(z-x), P = (1-K)P
+    int32_t p = filter->kalman.p_q8 + RSSI_FILTER_KALMAN_Q;
+    int32_t k_q16 = (int32_t)(((int64_t)p << 16) / (p + RSSI_FILTER_KALMAN_R));
+    filter->kalman.x_q8 += (int32_t)(((int64_t)k_q16 * (z - filter->kalman.x_q8)) >> 16);
+    filter->kalman.p_q8 = (int32_t)(((int64_t)(65536 - k_q16) * p) >> 16);
+}
+
+void rssi_filter_add(struct rssi_filter *filter, int8_t rssi) {
+    int8_t old = filter->history[filter->index];
+
+    switch (filter->mode) {
+    case RSSI_FILTER_BOXCAR:
+        if (filter->count == RSSI_FILTER_WINDOW)
+            filter->sum -= old;
+        filter->sum += rssi;
+        break;
+    case RSSI_FILTER_MEDIAN:
+        median_update(filter, old, rssi);
+        break;
+    case RSSI_FILTER_EMA:
+        if (filter->count == 0)
+            filter->ema_q8 = (int32_t)rssi * Q8_ONE;
+        else
+            filter->ema_q8 += (RSSI_FILTER_EMA_ALPHA * ((int32_t)rssi * Q8_ONE - filter->ema_q8)) / Q8_ONE;
+        break;
+    case RSSI_FILTER_KALMAN:
+        kalman_update(filter, rssi);
+        break;
+    }
+
+    filter->history[filter->index] = rssi;
+    filter->index = (filter->index + 1) % RSSI_FILTER_WINDOW;
+    if (filter->count < RSSI_FILTER_WINDOW)
+        filter->count++;
+}
+
+bool rssi_filter_get(const struct rssi_filter *filter, int8_t *rssi) {
+    if (filter->count == 0)
+        return false;
+
+    switch (filter->mode) {
+    case RSSI_FILTER_BOXCAR:
+        *rssi = (int8_t)(filter->sum / filter->count);
+        break;
+    case RSSI_FILTER_MEDIAN:
+        *rssi = filter->sorted[filter->count / 2];
+        break;
+    case RSSI_FILTER_EMA:
+        *rssi = q8_to_dbm(filter->ema_q8);
+        break;
+    case RSSI_FILTER_KALMAN:
+        *rssi = q8_to_dbm(filter->kalman.x_q8);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+const char *rssi_filter_mode_str(rssi_filter_mode_t mode) {
+    return ((unsigned)mode < sizeof(mode_str) / sizeof(mode_str[0])) ? mode_str[mode] : "?";
+}
@@ -0,0 +1,134 @@
+// test_battery.c -- ADC 模拟器驱动电池电压，经 battery.c 和功耗管理检查 BAS 电量、低电量迟滞和功耗模式
+#include <zephyr/ztest.h>
+#include "battery.h"
+#include "link_stats.h"
+#include "nrf54l15_power_mgr.h"
+#include "ring_tune.h"
+
+// 替身：BAS 只记录最近发布的电量；链路统计和可调参数不在本测试范围内
+static const struct ring_tunables tunables = RING_TUNABLES_DEFAULT;
+static int bas_level = -1;
+
+int bt_bas_set_battery_level(uint8_t level) {
+    bas_level = level;
+    return 0;
+}
+
+const struct ring_tunables *ring_tune_get(void) {
+    return &tunables;
+}
+
+void ring_tune_listener_register(struct ring_tune_listener *listener) {
+}
+
+void link_stats_request_update(void) {
+}
+
+// 电量曲线上电量不高于 level 的最高电压
+static uint16_t mv_for_level(uint8_t level) {
+    uint16_t mv = 4200;
+
+    while (mv > 0 && battery_soc_from_mv(mv) > level)
+        mv -= 5;
+    return mv;
+}
+
+// 设置电压并立即采样；模式在系统工作队列的 power_work 中切换，让出 CPU 等它完成
+static void battery_set_level(uint8_t level) {
+    zassert_ok(battery_emul_set_mv(mv_for_level(level)));
+    zassert_ok(battery_sample_now());
+    k_sleep(K_MSEC(10));
+}
+
+// 发布的电量与测得电压一致；ADC 量化可能让电量比目标低 1 到 2 个百分点
+static void assert_level(uint8_t target) {
+    zassert_equal(bas_level, battery_soc_from_mv(battery_get_mv()));
+    zassert_between_inclusive(bas_level, target - 2, target, "level %d, target %u",
+                              bas_level, target);
+}
+
+// 初始化失败时没有采样，由 test_boot_voltage 报告
+static void *setup(void) {
+    init_nrf54l15_power_optimization();
+    battery_init();
+    k_sleep(K_MSEC(100));
+    return NULL;
+}
+
+static void before(void *fixture) {
+    on_user_activity();
+    k_sleep(K_MSEC(10));
+}
+
+// 模拟器默认 0 mV；启动时应采用 CONFIG_RING_BATTERY_EMUL_MV，而不是当作电池耗尽
+ZTEST(battery, test_boot_voltage) {
+    zassert_within(battery_get_mv(), CONFIG_RING_BATTERY_EMUL_MV, 5);
+    zassert_equal(bas_level, battery_soc_from_mv(battery_get_mv()));
+    zassert_false(get_battery_low());
+    zassert_equal(get_current_power_mode(), POWER_MODE_ACTIVE);
+}
+
+// 不高于进入阈值进入深睡；回到两阈值之间保持；达到退出阈值后恢复按空闲时长切换
+ZTEST(battery, test_low_battery_thresholds) {
+    const uint8_t between = (BATTERY_LOW_ENTER_LEVEL + BATTERY_LOW_EXIT_LEVEL) / 2;
+
+    battery_set_level(BATTERY_LOW_ENTER_LEVEL + 5);
+    assert_level(BATTERY_LOW_ENTER_LEVEL + 5);
+    zassert_false(get_battery_low());
+    zassert_equal(get_current_power_mode(), POWER_MODE_ACTIVE);
+
+    battery_set_level(BATTERY_LOW_ENTER_LEVEL - 3);
+    assert_level(BATTERY_LOW_ENTER_LEVEL - 3);
+    zassert_true(get_battery_low());
+    zassert_equal(get_current_power_mode(), POWER_MODE_DEEP_SLEEP);
+
+    battery_set_level(between);
+    assert_level(between);
+    zassert_true(get_battery_low(), "hysteresis: below the exit level stays low");
+    zassert_equal(get_current_power_mode(), POWER_MODE_DEEP_SLEEP);
+    on_user_activity();
+    k_sleep(K_MSEC(10));
+    zassert_equal(get_current_power_mode(), POWER_MODE_DEEP_SLEEP);
+
+    battery_set_level(BATTERY_LOW_EXIT_LEVEL + 5);
+    assert_level(BATTERY_LOW_EXIT_LEVEL + 5);
+    zassert_false(get_battery_low());
+    zassert_equal(get_current_power_mode(), POWER_MODE_ACTIVE);
+
+    zassert_ok(battery_emul_set_mv(CONFIG_RING_BATTERY_EMUL_MV));
+    zassert_ok(battery_sample_now());
+}
+
+static int listener_level = -1;
+static int listener_calls;
+
+static void battery_changed(uint8_t level) {
+    listener_level = level;
+    listener_calls++;
+}
+
+static struct power_mode_listener listener = {
+    .battery_changed = battery_changed,
+};
+
+// 电量变化通知监听器（在场广播靠它更新载荷中的电量），电量不变时不通知
+ZTEST(battery, test_level_listener) {
+    static bool registered;
+
+    if (!registered) {
+        power_mode_listener_register(&listener);
+        registered = true;
+    }
+    listener_calls = 0;
+    battery_set_level(50);
+    zassert_equal(listener_calls, 1);
+    zassert_equal(listener_level, get_battery_level());
+    zassert_equal(listener_level, bas_level);
+    on_battery_level_changed(get_battery_level());
+    zassert_equal(listener_calls, 1);
+
+    zassert_ok(battery_emul_set_mv(CONFIG_RING_BATTERY_EMUL_MV));
+    zassert_ok(battery_sample_now());
+}
+
+ZTEST_SUITE(battery, NULL, setup, before, NULL, NULL);
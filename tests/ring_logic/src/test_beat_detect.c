@@ -0,0 +1,95 @@
+// test_beat_detect.c -- PPG 心搏检测：合成脉搏波上的 RR 与心率、脱落、时间回绕
+#include <zephyr/ztest.h>
+#include "beat_detect.h"
+
+#define RATE_HZ 50
+#define BATCH   25
+#define RR_BUF  8
+
+static struct beat_detect bd;
+static uint16_t rr_out[512];
+static int rr_n;
+
+static void before(void *fixture) {
+    beat_detect_init(&bd, RATE_HZ);
+    rr_n = 0;
+}
+
+// 脉搏波：周期的前 15% 上升，其余时间下降，幅度 10000；i 为样本序号
+static int32_t pulse(uint32_t i, uint16_t bpm) {
+    uint32_t p = (uint32_t)((uint64_t)i * bpm * 1000 / (60 * RATE_HZ)) % 1000;
+
+    return p < 150 ? (int32_t)(p * 10000 / 150) : (int32_t)((1000 - p) * 10000 / 850);
+}
+
+// 按 BATCH 个样本一批输入 seconds 秒，bpm 为 0 时输入平直信号；RR 收集到 rr_out
+static void run(uint32_t *i, int seconds, uint16_t bpm) {
+    int32_t x[BATCH];
+    uint16_t rr[RR_BUF];
+
+    for (int b = 0; b < seconds * RATE_HZ / BATCH; b++) {
+        for (int k = 0; k < BATCH; k++, (*i)++)
+            x[k] = bpm ? pulse(*i, bpm) : 0;
+        uint8_t n = beat_detect_run(&bd, x, BATCH, rr, RR_BUF);
+        for (uint8_t k = 0; k < n && rr_n < (int)ARRAY_SIZE(rr_out); k++)
+            rr_out[rr_n++] = rr[k];
+    }
+}
+
+// 75 bpm 的 RR 为 0.8 s = 819.2/1024 s；心搏时刻插值，误差应在一个样本 (20.48) 以内
+static void check_rr_75(void) {
+    zassert_true(rr_n > 0);
+    for (int k = 0; k < rr_n; k++)
+        zassert_within(rr_out[k], 819, 21, "rr[%d] = %u", k, rr_out[k]);
+    zassert_within(bd.hr, 75, 1);
+}
+
+ZTEST(beat_detect, test_steady_rate) {
+    uint32_t i = 0;
+
+    run(&i, 2, 75);
+    // 学习阶段不检测
+    zassert_equal(bd.beats, 0);
+    run(&i, 30, 75);
+    check_rr_75();
+    // 30 s 约 37 拍，首拍没有 RR
+    zassert_within(rr_n, 36, 2);
+}
+
+ZTEST(beat_detect, test_follows_rate_change) {
+    uint32_t i = 0;
+
+    run(&i, 20, 60);
+    zassert_within(bd.hr, 60, 1);
+    rr_n = 0;
+    run(&i, 20, 120);
+    zassert_within(bd.hr, 120, 2);
+    zassert_within(rr_out[rr_n - 1], 512, 21);
+}
+
+// 信号消失后 BEAT_LOST_MS 内 hr 置 0，恢复后重新输出
+ZTEST(beat_detect, test_lost_and_recovered) {
+    uint32_t i = 0;
+
+    run(&i, 20, 75);
+    zassert_not_equal(bd.hr, 0);
+    run(&i, BEAT_LOST_MS / 1000 + 1, 0);
+    zassert_equal(bd.hr, 0);
+    rr_n = 0;
+    run(&i, 20, 75);
+    zassert_within(bd.hr, 75, 1);
+}
+
+// 时刻和样本计数在检测过程中回绕：RR 不受影响，也不会重新进入学习阶段
+ZTEST(beat_detect, test_time_wraps) {
+    uint32_t i = 0;
+
+    bd.t = UINT32_MAX - 5 * 1024;
+    bd.n = UINT32_MAX - 3 * RATE_HZ;
+    run(&i, 20, 75);
+    zassert_true(bd.t < 20 * 1024);
+    check_rr_75();
+    zassert_within(rr_n, 22, 2);
+}
+
+ZTEST_SUITE(beat_detect, NULL, NULL, before, NULL, NULL);
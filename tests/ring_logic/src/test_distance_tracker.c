@@ -0,0 +1,121 @@
+// test_distance_tracker.c -- 区域迟滞和最短驻留时间
+#include <zephyr/ztest.h>
+#include "distance_tracker.h"
+
+static const struct distance_tracker_config cfg = DISTANCE_TRACKER_CONFIG_DEFAULT;
+static struct distance_tracker tracker;
+
+static void before(void *fixture) {
+    distance_tracker_init(&tracker);
+}
+
+ZTEST(distance_tracker, test_first_reading_confirmed) {
+    zassert_equal(tracker.zone, DISTANCE_UNKNOWN);
+    zassert_true(distance_tracker_update(&tracker, &cfg, -50, 0));
+    zassert_equal(tracker.zone, DISTANCE_CLOSE);
+    zassert_false(distance_tracker_update(&tracker, &cfg, -50, 100));
+}
+
+// 在 CLOSE 区域，越过 CLOSE/MEDIUM 边界但不超过迟滞余量时不切换
+ZTEST(distance_tracker, test_hysteresis) {
+    distance_tracker_update(&tracker, &cfg, -50, 0);
+    zassert_equal(tracker.zone, DISTANCE_CLOSE);
+    for (uint32_t t = 1000; t < 60000; t += 1000)
+        zassert_false(distance_tracker_update(&tracker, &cfg,
+                                              RSSI_CLOSE_THRESHOLD - DISTANCE_HYSTERESIS_DB, t));
+    zassert_equal(tracker.zone, DISTANCE_CLOSE);
+}
+
+ZTEST(distance_tracker, test_dwell) {
+    const int8_t medium = RSSI_CLOSE_THRESHOLD - DISTANCE_HYSTERESIS_DB - 1;
+
+    distance_tracker_update(&tracker, &cfg, -50, 0);
+    zassert_false(distance_tracker_update(&tracker, &cfg, medium, 1000));
+    zassert_false(distance_tracker_update(&tracker, &cfg, medium, 1000 + DISTANCE_DWELL_MS - 1));
+    zassert_true(distance_tracker_update(&tracker, &cfg, medium, 1000 + DISTANCE_DWELL_MS));
+    zassert_equal(tracker.zone, DISTANCE_MEDIUM);
+}
+
+// 候选区域在驻留时间内回到原区域，计时重新开始
+ZTEST(distance_tracker, test_dwell_restarts) {
+    const int8_t medium = RSSI_CLOSE_THRESHOLD - DISTANCE_HYSTERESIS_DB - 1;
+
+    distance_tracker_update(&tracker, &cfg, -50, 0);
+    distance_tracker_update(&tracker, &cfg, medium, 1000);
+    zassert_false(distance_tracker_update(&tracker, &cfg, -50, 2000));
+    zassert_false(distance_tracker_update(&tracker, &cfg, medium, 3000));
+    zassert_false(distance_tracker_update(&tracker, &cfg, medium, 1000 + DISTANCE_DWELL_MS));
+    zassert_true(distance_tracker_update(&tracker, &cfg, medium, 3000 + DISTANCE_DWELL_MS));
+}
+
+// 跨越多个区域时直接进入目标区域
+ZTEST(distance_tracker, test_jump_several_zones) {
+    distance_tracker_update(&tracker, &cfg, -30, 0);
+    zassert_equal(tracker.zone, DISTANCE_VERY_CLOSE);
+    distance_tracker_update(&tracker, &cfg, -95, 1000);
+    zassert_true(distance_tracker_update(&tracker, &cfg, -95, 1000 + DISTANCE_DWELL_MS));
+    zassert_equal(tracker.zone, DISTANCE_VERY_FAR);
+}
+
+// 在边界两侧 ±3 dB 交替，每侧停留超过驻留时间：裸阈值每次都翻转，
+// 驻留时间挡不住，只有迟滞让跟踪器保持不动
+ZTEST(distance_tracker, test_no_flaps_near_boundary) {
+    static const struct ring_tunables t = RING_TUNABLES_DEFAULT;
+    distance_level_t last = estimate_distance(&t, RSSI_MEDIUM_THRESHOLD);
+    int raw_flaps = 0, flaps = 0;
+
+    distance_tracker_update(&tracker, &cfg, RSSI_MEDIUM_THRESHOLD, 0);
+    for (uint32_t i = 1; i <= 200; i++) {
+        uint32_t now = i * 1000;
+        int8_t rssi = RSSI_MEDIUM_THRESHOLD + ((now / (2 * DISTANCE_DWELL_MS)) % 2 ? -3 : 3);
+        distance_level_t raw = estimate_distance(&t, rssi);
+
+        raw_flaps += raw != last;
+        last = raw;
+        flaps += distance_tracker_update(&tracker, &cfg, rssi, now);
+    }
+    zassert_true(raw_flaps >= 10, "%d", raw_flaps);
+    zassert_equal(flaps, 0);
+}
+
+// 阈值收窄后迟滞随之缩小：中间区域两侧迟滞之和小于区域宽度，默认阈值下保持原值
+ZTEST(distance_tracker, test_config_set_limits_hysteresis) {
+    static const struct ring_tunables t = RING_TUNABLES_DEFAULT;
+    static const int8_t narrow[DISTANCE_BOUNDARY_COUNT] = { -60, -64, -65, -90 };
+    struct distance_tracker_config c = cfg;
+
+    distance_tracker_config_set(&c, t.rssi_threshold, DISTANCE_HYSTERESIS_DB);
+    zassert_mem_equal(&c, &cfg, sizeof(c));
+
+    distance_tracker_config_set(&c, narrow, 10);
+    zassert_mem_equal(c.threshold, narrow, sizeof(narrow));
+    zassert_equal(c.hysteresis[0], 1);
+    zassert_equal(c.hysteresis[1], 0);
+    zassert_equal(c.hysteresis[2], 0);
+    zassert_equal(c.hysteresis[3], 10);
+    for (int i = 0; i + 1 < DISTANCE_BOUNDARY_COUNT; i++)
+        zassert_true(c.hysteresis[i] + c.hysteresis[i + 1] < narrow[i] - narrow[i + 1]);
+}
+
+// 窄区域 (MEDIUM: -64..-60) 从远近两侧都能以区域内的同一读数进入
+ZTEST(distance_tracker, test_narrow_zone_reachable) {
+    static const int8_t narrow[DISTANCE_BOUNDARY_COUNT] = { -40, -60, -64, -90 };
+    struct distance_tracker_config c = cfg;
+    const int8_t inside = -62;
+
+    distance_tracker_config_set(&c, narrow, 10);
+    distance_tracker_update(&tracker, &c, -75, 0);
+    zassert_equal(tracker.zone, DISTANCE_FAR);
+    distance_tracker_update(&tracker, &c, inside, 1000);
+    zassert_true(distance_tracker_update(&tracker, &c, inside, 1000 + c.dwell_ms));
+    zassert_equal(tracker.zone, DISTANCE_MEDIUM);
+
+    distance_tracker_init(&tracker);
+    distance_tracker_update(&tracker, &c, -50, 0);
+    zassert_equal(tracker.zone, DISTANCE_CLOSE);
+    distance_tracker_update(&tracker, &c, inside, 1000);
+    zassert_true(distance_tracker_update(&tracker, &c, inside, 1000 + c.dwell_ms));
+    zassert_equal(tracker.zone, DISTANCE_MEDIUM);
+}
+
+ZTEST_SUITE(distance_tracker, NULL, NULL, before, NULL, NULL);
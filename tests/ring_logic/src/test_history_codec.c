@@ -0,0 +1,185 @@
+// test_history_codec.c -- 历史块编码往返：按 history_codec.h 的格式说明独立解码，
+// 与 scripts/decode_status.py 的解码规则一致
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "history_codec.h"
+
+#define RECORDS_MAX 32
+
+struct record {
+    uint8_t type;
+    uint8_t arg;
+    uint32_t t_s;
+    uint16_t v[HISTORY_RR_MAX];
+};
+
+static uint8_t buf[256];
+static struct history_encoder enc;
+static struct record out[RECORDS_MAX];
+
+static void before(void *fixture) {
+    memset(buf, 0xa5, sizeof(buf));
+    history_encoder_init(&enc, buf, sizeof(buf), 1000);
+}
+
+static uint32_t varint_get(const uint8_t **p) {
+    uint32_t v = 0;
+
+    for (int shift = 0;; shift += 7) {
+        uint8_t b = *(*p)++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+static int32_t zigzag_get(const uint8_t **p) {
+    uint32_t v = varint_get(p);
+
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// 返回记录数，记录区长度不符时返回 -1
+static int decode(void) {
+    const uint8_t *p = buf, *end = buf + enc.len;
+    uint32_t t_s = enc.start_s;
+    int32_t hr = 0, rr = 0;
+    int n = 0;
+
+    while (p < end && n < RECORDS_MAX) {
+        struct record *r = &out[n++];
+
+        r->type = *p & 0x0f;
+        r->arg = *p++ >> 4;
+        t_s += varint_get(&p);
+        r->t_s = t_s;
+        switch (r->type) {
+        case HISTORY_HR:
+            hr += zigzag_get(&p);
+            r->v[0] = (uint16_t)hr;
+            break;
+        case HISTORY_RR:
+            for (int i = 0; i < r->arg; i++) {
+                rr += zigzag_get(&p);
+                r->v[i] = (uint16_t)rr;
+            }
+            break;
+        case HISTORY_HRV:
+            for (int i = 0; i < 3; i++)
+                r->v[i] = (uint16_t)varint_get(&p);
+            break;
+        default:
+            break;
+        }
+    }
+    return p == end ? n : -1;
+}
+
+ZTEST(history_codec, test_round_trip) {
+    static const uint16_t rr1[] = { 800, 812, 790 };
+    static const uint16_t rr2[] = { 1200, 600 };
+
+    zassert_true(history_encode_hr(&enc, 1000, 72));
+    zassert_true(history_encode_rr(&enc, 1001, rr1, ARRAY_SIZE(rr1)));
+    zassert_true(history_encode_hr(&enc, 1001, 65));
+    zassert_true(history_encode_zone(&enc, 1300, 2));
+    zassert_true(history_encode_touch(&enc, 1300, HISTORY_TOUCH_PRESSED | HISTORY_TOUCH_REMOTE));
+    zassert_true(history_encode_rr(&enc, 200000, rr2, ARRAY_SIZE(rr2)));
+    zassert_true(history_encode_hrv(&enc, 200060, 45, 300, 1234));
+    zassert_true(history_encode_hr(&enc, 200061, 250));
+    zassert_equal(enc.count, 8);
+    zassert_equal(decode(), 8);
+
+    zassert_equal(out[0].type, HISTORY_HR);
+    zassert_equal(out[0].t_s, 1000);
+    zassert_equal(out[0].v[0], 72);
+    zassert_equal(out[1].type, HISTORY_RR);
+    zassert_equal(out[1].arg, 3);
+    zassert_mem_equal(out[1].v, rr1, sizeof(rr1));
+    zassert_equal(out[2].v[0], 65);
+    zassert_equal(out[2].t_s, 1001);
+    zassert_equal(out[3].type, HISTORY_ZONE);
+    zassert_equal(out[3].arg, 2);
+    zassert_equal(out[3].t_s, 1300);
+    zassert_equal(out[4].type, HISTORY_TOUCH);
+    zassert_equal(out[4].arg, HISTORY_TOUCH_PRESSED | HISTORY_TOUCH_REMOTE);
+    zassert_equal(out[5].t_s, 200000);
+    zassert_mem_equal(out[5].v, rr2, sizeof(rr2));
+    zassert_equal(out[6].type, HISTORY_HRV);
+    zassert_equal(out[6].v[0], 45);
+    zassert_equal(out[6].v[1], 300);
+    zassert_equal(out[6].v[2], 1234);
+    zassert_equal(out[7].v[0], 250);
+}
+
+// 时间倒退按同一时刻记录，不写负的间隔
+ZTEST(history_codec, test_time_never_goes_back) {
+    zassert_true(history_encode_hr(&enc, 1010, 70));
+    zassert_true(history_encode_hr(&enc, 1005, 71));
+    zassert_true(history_encode_hr(&enc, 1011, 72));
+    zassert_equal(decode(), 3);
+    zassert_equal(out[1].t_s, 1010);
+    zassert_equal(out[2].t_s, 1011);
+}
+
+// 超过 HISTORY_RR_MAX 个 RR 时截断，空 RR 不写记录
+ZTEST(history_codec, test_rr_limits) {
+    uint16_t rr[HISTORY_RR_MAX + 3];
+
+    for (size_t i = 0; i < ARRAY_SIZE(rr); i++)
+        rr[i] = 700 + i * 10;
+    zassert_true(history_encode_rr(&enc, 1000, rr, 0));
+    zassert_equal(enc.count, 0);
+    zassert_true(history_encode_rr(&enc, 1000, rr, ARRAY_SIZE(rr)));
+    zassert_equal(decode(), 1);
+    zassert_equal(out[0].arg, HISTORY_RR_MAX);
+    zassert_mem_equal(out[0].v, rr, HISTORY_RR_MAX * sizeof(rr[0]));
+}
+
+// 放不下时返回 false，编码器和已写入的内容不变，差分基准也不变
+ZTEST(history_codec, test_full_block_unchanged) {
+    uint16_t len;
+
+    history_encoder_init(&enc, buf, 9, 1000);
+    zassert_true(history_encode_hr(&enc, 1000, 60));
+    zassert_true(history_encode_hr(&enc, 1001, 61));
+    len = enc.len;
+    zassert_false(history_encode_hrv(&enc, 1002, 1000, 1000, 1000));
+    zassert_equal(enc.len, len);
+    zassert_equal(enc.count, 2);
+    zassert_equal(enc.last_hr, 61);
+    zassert_equal(buf[len], 0xa5);
+    zassert_true(history_encode_hr(&enc, 1002, 62));
+    zassert_equal(decode(), 3);
+    zassert_equal(out[2].v[0], 62);
+}
+
+ZTEST(history_codec, test_header_round_trip) {
+    const struct history_block_header hdr = {
+        .version = HISTORY_FORMAT_VERSION,
+        .boot = 0x1234,
+        .seq = 0xdeadbeef,
+        .start_s = 86400 * 30,
+        .count = 517,
+        .len = 4080,
+    };
+    uint8_t raw[HISTORY_HEADER_SIZE];
+    struct history_block_header got;
+
+    history_header_write(raw, &hdr);
+    // 小端
+    zassert_equal(raw[4], 0xef);
+    zassert_equal(raw[7], 0xde);
+    zassert_true(history_header_read(raw, &got));
+    zassert_mem_equal(&got, &hdr, sizeof(hdr));
+
+    // v1 块仍可读，未知版本拒绝
+    raw[0] = 1;
+    zassert_true(history_header_read(raw, &got));
+    raw[0] = HISTORY_FORMAT_VERSION + 1;
+    zassert_false(history_header_read(raw, &got));
+    raw[0] = 0xff;
+    zassert_false(history_header_read(raw, &got));
+}
+
+ZTEST_SUITE(history_codec, NULL, NULL, before, NULL, NULL);
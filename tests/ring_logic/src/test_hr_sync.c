@@ -0,0 +1,110 @@
+// test_hr_sync.c -- 心率同步：滞后方向、同步迟滞、未知心率清窗，以及心率等级迟滞
+#include <zephyr/ztest.h>
+#include "hr_sync.h"
+
+static const struct ring_tunables tunables = RING_TUNABLES_DEFAULT;
+static struct hr_sync sync;
+
+static void before(void *fixture) {
+    hr_sync_init(&sync);
+}
+
+// 周期 12 的三角波，67 到 73 bpm
+static uint16_t wave(int i) {
+    int p = ((i % 12) + 12) % 12;
+
+    return 70 + (p < 6 ? p : 12 - p) - 3;
+}
+
+// 输入 n 对样本，返回事件位的并集
+static uint8_t feed(int from, int n, int partner_delay, int partner_offset) {
+    uint8_t ev = 0;
+
+    for (int i = from; i < from + n; i++)
+        ev |= hr_sync_update(&sync, &tunables, wave(i),
+                             wave(i - partner_delay) + partner_offset);
+    return ev;
+}
+
+ZTEST(hr_sync, test_in_phase_syncs_once) {
+    uint8_t ev = feed(0, HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG, 0, 0);
+
+    zassert_equal(ev, HR_SYNC_EV_SYNC_ON);
+    zassert_true(sync.synced);
+    zassert_equal(sync.lag, 0);
+    zassert_true(sync.corr > HR_SYNC_Q15_ONE * 9 / 10);
+    // 保持同步时不再报事件
+    zassert_equal(feed(HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG, 20, 0, 0), 0);
+}
+
+// 对方的序列晚 2 个样本：滞后为正
+ZTEST(hr_sync, test_partner_lag_positive) {
+    feed(0, HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG, 2, 0);
+    zassert_equal(sync.lag, 2);
+    hr_sync_init(&sync);
+    feed(0, HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG, -2, 0);
+    zassert_equal(sync.lag, -2);
+}
+
+// 平均差达到 2 倍同步阈值时一致度为 0，同步退出；回到同一水平再进入
+ZTEST(hr_sync, test_sync_hysteresis) {
+    int n = HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG;
+
+    zassert_equal(feed(0, n, 0, 0), HR_SYNC_EV_SYNC_ON);
+    zassert_equal(feed(n, n, 0, 2 * tunables.hr_sync_threshold), HR_SYNC_EV_SYNC_OFF);
+    zassert_equal(sync.coherence, 0);
+    zassert_equal(feed(2 * n, n, 0, 0), HR_SYNC_EV_SYNC_ON);
+}
+
+// 一致度落在进入和退出阈值之间时保持原状态
+ZTEST(hr_sync, test_sync_holds_between_thresholds) {
+    int n = HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG;
+    // 完全相关时一致度等于平均差得分 1 - d / (2 * 阈值)，d 取阈值的一半得 0.75，
+    // 再取 1.1 倍阈值得 0.45，位于 0.4 和 0.6 之间
+    int mid = tunables.hr_sync_threshold * 11 / 10;
+
+    zassert_equal(feed(0, n, 0, mid), 0);
+    zassert_false(sync.synced);
+    zassert_equal(feed(n, n, 0, tunables.hr_sync_threshold / 2), HR_SYNC_EV_SYNC_ON);
+    // 平均差每个窗口增加 1 bpm，跳变不会破坏相关性
+    for (int d = tunables.hr_sync_threshold / 2 + 1, i = 2 * n; d <= mid; d++, i += n)
+        zassert_equal(feed(i, n, 0, d), 0);
+    zassert_true(sync.synced);
+}
+
+// 任一方心率未知时清空窗口并退出同步
+ZTEST(hr_sync, test_zero_clears_window) {
+    feed(0, HR_SYNC_WINDOW + 2 * HR_SYNC_MAX_LAG, 0, 0);
+    zassert_true(sync.synced);
+    zassert_equal(hr_sync_update(&sync, &tunables, 70, 0), HR_SYNC_EV_SYNC_OFF);
+    zassert_equal(sync.count, 0);
+    zassert_equal(sync.n, 0);
+    zassert_equal(hr_sync_update(&sync, &tunables, 0, 70), 0);
+    // 重新积累到最少样本数之前不判断
+    zassert_equal(feed(0, HR_SYNC_MIN_SAMPLES + 2 * HR_SYNC_MAX_LAG - 1, 0, 0), 0);
+    zassert_false(sync.synced);
+}
+
+ZTEST(hr_sync, test_level_hysteresis) {
+    hr_level_t level = HR_LEVEL_NORMAL;
+
+    level = hr_level_update(level, HR_HIGH_THRESHOLD);
+    zassert_equal(level, HR_LEVEL_NORMAL);
+    level = hr_level_update(level, HR_HIGH_THRESHOLD + 1);
+    zassert_equal(level, HR_LEVEL_HIGH);
+    level = hr_level_update(level, HR_HIGH_THRESHOLD - HR_LEVEL_HYSTERESIS);
+    zassert_equal(level, HR_LEVEL_HIGH);
+    level = hr_level_update(level, HR_HIGH_THRESHOLD - HR_LEVEL_HYSTERESIS - 1);
+    zassert_equal(level, HR_LEVEL_NORMAL);
+
+    level = hr_level_update(level, HR_LOW_THRESHOLD - 1);
+    zassert_equal(level, HR_LEVEL_LOW);
+    level = hr_level_update(level, HR_LOW_THRESHOLD + HR_LEVEL_HYSTERESIS);
+    zassert_equal(level, HR_LEVEL_LOW);
+    // 未知心率保持原等级
+    zassert_equal(hr_level_update(level, 0), HR_LEVEL_LOW);
+    level = hr_level_update(level, HR_LOW_THRESHOLD + HR_LEVEL_HYSTERESIS + 1);
+    zassert_equal(level, HR_LEVEL_NORMAL);
+}
+
+ZTEST_SUITE(hr_sync, NULL, NULL, before, NULL, NULL);
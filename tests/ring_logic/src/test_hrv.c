@@ -0,0 +1,103 @@
+// test_hrv.c -- HRV 指标、伪差剔除与滑动窗口
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "hrv.h"
+
+// ms 转 1/1024 s，125 ms 的整数倍可以精确表示
+#define RR(ms) ((uint16_t)((ms) * 1024 / 1000))
+
+static struct hrv hrv;
+
+static void before(void *fixture) {
+    hrv_init(&hrv);
+}
+
+ZTEST(hrv, test_no_metrics_below_min_beats) {
+    for (int i = 0; i < HRV_MIN_BEATS - 1; i++)
+        zassert_true(hrv_add_rr(&hrv, RR(i & 1 ? 875 : 750)));
+    zassert_equal(hrv.rmssd_ms, 0);
+    zassert_equal(hrv.sdnn_ms, 0);
+    zassert_equal(hrv.stress, 0);
+    zassert_true(hrv_add_rr(&hrv, RR(875)));
+    zassert_not_equal(hrv.rmssd_ms, 0);
+}
+
+// 750/875 ms 交替：相邻差 125 ms；16 拍的样本标准差 √(62.5² · 16/15) ≈ 64.5；
+// 众数桶取先出现的 750 ms 所在桶（中心 775 ms），跨度 3 个桶 (150 ms)，
+// SI = 50% / (2 · 0.775 · 0.15) ≈ 215
+ZTEST(hrv, test_alternating_metrics) {
+    for (int i = 0; i < HRV_MIN_BEATS; i++)
+        hrv_add_rr(&hrv, RR(i & 1 ? 875 : 750));
+    zassert_equal(hrv.count, HRV_MIN_BEATS);
+    zassert_equal(hrv.diff_count, HRV_MIN_BEATS - 1);
+    zassert_equal(hrv.rmssd_ms, 125);
+    zassert_equal(hrv.sdnn_ms, 64);
+    zassert_equal(hrv.stress, 215);
+}
+
+ZTEST(hrv, test_rejects_out_of_range) {
+    zassert_false(hrv_add_rr(&hrv, RR(250)));
+    zassert_false(hrv_add_rr(&hrv, RR(2125)));
+    zassert_equal(hrv.rejected, 2);
+    zassert_equal(hrv.count, 0);
+}
+
+// 与上一拍相差超过 20% 的拍被拒，连续 HRV_RESYNC 拍后以新值为基准，且不与旧拍求差
+ZTEST(hrv, test_jump_resyncs) {
+    hrv_add_rr(&hrv, RR(1000));
+    hrv_add_rr(&hrv, RR(1125));
+    zassert_equal(hrv.diff_count, 1);
+    for (int i = 0; i < HRV_RESYNC - 1; i++)
+        zassert_false(hrv_add_rr(&hrv, RR(625)));
+    zassert_true(hrv_add_rr(&hrv, RR(625)));
+    zassert_equal(hrv.count, 3);
+    zassert_equal(hrv.diff_count, 1);
+    zassert_equal(hrv.rejected, HRV_RESYNC - 1);
+    zassert_true(hrv_add_rr(&hrv, RR(750)));
+    zassert_equal(hrv.diff_count, 2);
+}
+
+// 单个伪差不打断节律：之后的拍仍与伪差前的拍比较，但不求差
+ZTEST(hrv, test_single_artifact) {
+    hrv_add_rr(&hrv, RR(1000));
+    zassert_false(hrv_add_rr(&hrv, RR(500)));
+    zassert_true(hrv_add_rr(&hrv, RR(1000)));
+    zassert_equal(hrv.count, 2);
+    zassert_equal(hrv.diff_count, 0);
+}
+
+ZTEST(hrv, test_break_skips_diff) {
+    hrv_add_rr(&hrv, RR(1000));
+    hrv_break(&hrv);
+    hrv_add_rr(&hrv, RR(1000));
+    zassert_equal(hrv.count, 2);
+    zassert_equal(hrv.diff_count, 0);
+}
+
+// 窗口滑动后的增量结果与只输入窗口内的拍重新计算的结果一致
+ZTEST(hrv, test_window_slides) {
+    static struct hrv fresh;
+    static const uint16_t pattern[] = { 750, 875, 1000, 875, 750, 625, 750 };
+    const int total = 3 * HRV_WINDOW + 5;
+
+    hrv_init(&fresh);
+    for (int i = 0; i < total; i++) {
+        uint16_t rr = RR(pattern[i % ARRAY_SIZE(pattern)]);
+
+        zassert_true(hrv_add_rr(&hrv, rr));
+        if (i >= total - HRV_WINDOW)
+            hrv_add_rr(&fresh, rr);
+    }
+    zassert_equal(hrv.count, HRV_WINDOW);
+    zassert_equal(hrv.sum, fresh.sum);
+    zassert_equal(hrv.sum_sq, fresh.sum_sq);
+    zassert_mem_equal(hrv.hist, fresh.hist, sizeof(hrv.hist));
+    zassert_equal(hrv.sdnn_ms, fresh.sdnn_ms);
+    zassert_equal(hrv.stress, fresh.stress);
+    // fresh 的首拍没有前一拍，相邻差少一个
+    zassert_equal(hrv.diff_count, HRV_WINDOW);
+    zassert_equal(fresh.diff_count, HRV_WINDOW - 1);
+    zassert_within(hrv.rmssd_ms, fresh.rmssd_ms, 2);
+}
+
+ZTEST_SUITE(hrv, NULL, NULL, before, NULL, NULL);
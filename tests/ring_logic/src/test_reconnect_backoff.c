@@ -0,0 +1,120 @@
+// test_reconnect_backoff.c -- 重连退避曲线与各功耗模式、电量档位的档位表
+#include <zephyr/ztest.h>
+#include "ring_analytics.h"
+
+static const power_mode_t modes[] = {
+    POWER_MODE_ACTIVE, POWER_MODE_IDLE, POWER_MODE_SLEEP, POWER_MODE_DEEP_SLEEP,
+};
+
+ZTEST(reconnect_backoff, test_doubles_then_caps) {
+    const struct reconnect_profile p = { 2000, 30000, 0 };
+
+    zassert_equal(reconnect_backoff_ms(&p, 0), 2000);
+    zassert_equal(reconnect_backoff_ms(&p, 1), 4000);
+    zassert_equal(reconnect_backoff_ms(&p, 3), 16000);
+    zassert_equal(reconnect_backoff_ms(&p, 4), 30000);
+    // 次数很大时不因移位溢出而变小
+    for (uint32_t a = 4; a < 70; a++)
+        zassert_equal(reconnect_backoff_ms(&p, a), 30000, "attempt %u", a);
+    zassert_equal(reconnect_backoff_ms(&p, UINT32_MAX - 1), 30000);
+}
+
+ZTEST(reconnect_backoff, test_attempt_limit) {
+    const struct reconnect_profile p = { 1000, 8000, 3 };
+
+    zassert_equal(reconnect_backoff_ms(&p, 2), 4000);
+    zassert_equal(reconnect_backoff_ms(&p, 3), UINT32_MAX);
+    zassert_equal(reconnect_backoff_ms(&p, 100), UINT32_MAX);
+}
+
+// 越空闲、电量越低，退避不会更快；低电量档一定有次数上限，正常电量不限
+ZTEST(reconnect_backoff, test_profile_table_monotonic) {
+    for (int m = 0; m < (int)ARRAY_SIZE(modes); m++) {
+        for (int b = 0; b < BATTERY_BAND_COUNT; b++) {
+            const struct reconnect_profile *p = reconnect_profile_get(modes[m], b);
+
+            zassert_true(p->base_ms > 0 && p->base_ms <= p->max_ms, "mode %d band %d", m, b);
+            if (b > 0) {
+                const struct reconnect_profile *q = reconnect_profile_get(modes[m], b - 1);
+                zassert_true(p->base_ms >= q->base_ms && p->max_ms >= q->max_ms,
+                             "mode %d band %d", m, b);
+            }
+            if (m > 0) {
+                const struct reconnect_profile *q = reconnect_profile_get(modes[m - 1], b);
+                zassert_true(p->base_ms >= q->base_ms && p->max_ms >= q->max_ms,
+                             "mode %d band %d", m, b);
+            }
+        }
+        zassert_equal(reconnect_profile_get(modes[m], BATTERY_BAND_NORMAL)->max_attempts, 0);
+        zassert_not_equal(reconnect_profile_get(modes[m], BATTERY_BAND_LOW)->max_attempts, 0);
+    }
+}
+
+// 低电量档的总寻找时间有上限：退避次数用尽后停止
+ZTEST(reconnect_backoff, test_low_battery_bounded) {
+    for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+        const struct reconnect_profile *p = reconnect_profile_get(modes[m], BATTERY_BAND_LOW);
+        uint64_t total = 0;
+        uint32_t a;
+
+        for (a = 0; reconnect_backoff_ms(p, a) != UINT32_MAX; a++)
+            total += reconnect_backoff_ms(p, a);
+        zassert_equal(a, p->max_attempts);
+        zassert_true(total <= (uint64_t)p->max_ms * p->max_attempts);
+    }
+}
+
+ZTEST(reconnect_backoff, test_out_of_range_clamps) {
+    zassert_equal_ptr(reconnect_profile_get((power_mode_t)7, BATTERY_BAND_NORMAL),
+                      reconnect_profile_get(POWER_MODE_DEEP_SLEEP, BATTERY_BAND_NORMAL));
+    zassert_equal_ptr(reconnect_profile_get(POWER_MODE_ACTIVE, (enum battery_band)9),
+                      reconnect_profile_get(POWER_MODE_ACTIVE, BATTERY_BAND_LOW));
+    zassert_equal_ptr(scan_profile_get((power_mode_t)7), scan_profile_get(POWER_MODE_DEEP_SLEEP));
+    zassert_equal_ptr(adv_profile_get((power_mode_t)7), adv_profile_get(POWER_MODE_DEEP_SLEEP));
+}
+
+// 扫描占空比随模式降低；慢速广播间隔不超过 1.05 s，一个搜索窗口 (2.1 s) 内能收到两次
+ZTEST(reconnect_backoff, test_scan_and_adv_profiles) {
+    for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+        const struct scan_profile *s = scan_profile_get(modes[m]);
+        const struct adv_profile *a = adv_profile_get(modes[m]);
+
+        zassert_true(s->window <= s->interval);
+        zassert_true(s->window * 625 >= 30000, "window covers one adv event");
+        zassert_true(a->interval_min <= a->interval_max);
+        zassert_true(a->interval_max * 625 <= 1050000);
+        if (m > 0) {
+            const struct scan_profile *q = scan_profile_get(modes[m - 1]);
+            zassert_true((uint32_t)s->window * q->interval <= (uint32_t)q->window * s->interval);
+        }
+    }
+}
+
+// 退避中的广播间隔逐次加倍，封顶后加上 advDelay (10 ms) 仍在 2.1 s 的搜索窗口内
+ZTEST(reconnect_backoff, test_adv_backoff) {
+    for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+        const struct adv_profile *p = adv_profile_get(modes[m]);
+        struct adv_profile prev = adv_profile_backoff(p, 0);
+
+        zassert_equal(prev.interval_min, p->interval_min);
+        zassert_equal(prev.interval_max, p->interval_max);
+        for (uint32_t a = 1; a < 40; a++) {
+            struct adv_profile b = adv_profile_backoff(p, a);
+
+            zassert_true(b.interval_min <= b.interval_max);
+            zassert_true(b.interval_max <= ADV_BACKOFF_INTERVAL_MAX);
+            zassert_true(b.interval_max >= prev.interval_max);
+            zassert_true(b.interval_max == ADV_BACKOFF_INTERVAL_MAX ||
+                         b.interval_max == 2 * prev.interval_max);
+            prev = b;
+        }
+        zassert_equal(prev.interval_min, ADV_BACKOFF_INTERVAL_MAX);
+    }
+    zassert_true(ADV_BACKOFF_INTERVAL_MAX * 625 / 1000 + 10 < 2100);
+    zassert_equal(adv_profile_backoff(adv_profile_get(POWER_MODE_ACTIVE), 1).interval_min,
+                  2 * adv_profile_get(POWER_MODE_ACTIVE)->interval_min);
+    zassert_equal(adv_profile_backoff(adv_profile_get(POWER_MODE_ACTIVE), UINT32_MAX).interval_max,
+                  ADV_BACKOFF_INTERVAL_MAX);
+}
+
+ZTEST_SUITE(reconnect_backoff, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,106 @@
+// test_ring_analytics.c -- 距离阈值、功耗策略和电量曲线
+#include <zephyr/ztest.h>
+#include "ring_analytics.h"
+
+static const struct ring_tunables defaults = RING_TUNABLES_DEFAULT;
+
+ZTEST(ring_analytics, test_tunables_valid) {
+    struct ring_tunables t = defaults;
+
+    zassert_true(ring_tunables_valid(&t));
+    t.rssi_threshold[2] = t.rssi_threshold[1];
+    zassert_false(ring_tunables_valid(&t), "thresholds must strictly decrease");
+    t = defaults;
+    t.power_threshold_ms[1] = t.power_threshold_ms[2];
+    zassert_false(ring_tunables_valid(&t), "power thresholds must strictly increase");
+    t = defaults;
+    t.power_threshold_ms[0] = 0;
+    zassert_false(ring_tunables_valid(&t));
+    t = defaults;
+    t.hr_sync_threshold = 0;
+    zassert_false(ring_tunables_valid(&t));
+}
+
+// 阈值是各区域的下限，等于阈值属于较近的区域
+ZTEST(ring_analytics, test_estimate_distance_boundaries) {
+    zassert_equal(estimate_distance(&defaults, 0), DISTANCE_VERY_CLOSE);
+    zassert_equal(estimate_distance(&defaults, RSSI_VERY_CLOSE_THRESHOLD), DISTANCE_VERY_CLOSE);
+    zassert_equal(estimate_distance(&defaults, RSSI_VERY_CLOSE_THRESHOLD - 1), DISTANCE_CLOSE);
+    zassert_equal(estimate_distance(&defaults, RSSI_CLOSE_THRESHOLD), DISTANCE_CLOSE);
+    zassert_equal(estimate_distance(&defaults, RSSI_MEDIUM_THRESHOLD), DISTANCE_MEDIUM);
+    zassert_equal(estimate_distance(&defaults, RSSI_FAR_THRESHOLD), DISTANCE_FAR);
+    zassert_equal(estimate_distance(&defaults, RSSI_FAR_THRESHOLD - 1), DISTANCE_VERY_FAR);
+    zassert_equal(estimate_distance(&defaults, INT8_MIN), DISTANCE_VERY_FAR);
+    zassert_str_equal(distance_level_str(DISTANCE_MEDIUM), "Medium");
+    zassert_str_equal(distance_level_str((distance_level_t)42), "?");
+}
+
+// 策略用 “>” 比较：恰好到阈值时仍留在较浅的模式，下一 ms 切换
+ZTEST(ring_analytics, test_power_policy) {
+    zassert_equal(power_policy_target_mode(&defaults, 0), POWER_MODE_ACTIVE);
+    zassert_equal(power_policy_target_mode(&defaults, IDLE_THRESHOLD_MS), POWER_MODE_ACTIVE);
+    zassert_equal(power_policy_target_mode(&defaults, IDLE_THRESHOLD_MS + 1), POWER_MODE_IDLE);
+    zassert_equal(power_policy_target_mode(&defaults, SLEEP_THRESHOLD_MS + 1), POWER_MODE_SLEEP);
+    zassert_equal(power_policy_target_mode(&defaults, DEEP_SLEEP_THRESHOLD_MS + 1),
+                  POWER_MODE_DEEP_SLEEP);
+
+    zassert_equal(power_policy_next_deadline(&defaults, 0), IDLE_THRESHOLD_MS + 1);
+    zassert_equal(power_policy_next_deadline(&defaults, IDLE_THRESHOLD_MS), 1);
+    zassert_equal(power_policy_next_deadline(&defaults, IDLE_THRESHOLD_MS + 1),
+                  SLEEP_THRESHOLD_MS - IDLE_THRESHOLD_MS);
+    zassert_equal(power_policy_next_deadline(&defaults, DEEP_SLEEP_THRESHOLD_MS + 1), UINT32_MAX);
+}
+
+// 截止时刻总是落在策略切换的那一 ms
+ZTEST(ring_analytics, test_power_deadline_matches_policy) {
+    for (uint32_t idle = 0; idle <= DEEP_SLEEP_THRESHOLD_MS; idle += 250) {
+        uint32_t d = power_policy_next_deadline(&defaults, idle);
+        power_mode_t mode = power_policy_target_mode(&defaults, idle);
+
+        zassert_equal(power_policy_target_mode(&defaults, idle + d - 1), mode, "idle %u", idle);
+        zassert_not_equal(power_policy_target_mode(&defaults, idle + d), mode, "idle %u", idle);
+    }
+}
+
+ZTEST(ring_analytics, test_battery_soc) {
+    zassert_equal(battery_soc_from_mv(4300), 100);
+    zassert_equal(battery_soc_from_mv(4200), 100);
+    zassert_equal(battery_soc_from_mv(3700), 40);
+    // 3700..3800 mV 对应 40..56%，中点插值
+    zassert_equal(battery_soc_from_mv(3750), 48);
+    zassert_equal(battery_soc_from_mv(3300), 0);
+    zassert_equal(battery_soc_from_mv(2800), 0);
+
+    // 单调不增
+    uint8_t prev = 100;
+    for (uint16_t mv = 4200; mv >= 3300; mv -= 5) {
+        uint8_t soc = battery_soc_from_mv(mv);
+        zassert_true(soc <= prev, "%u mV", mv);
+        prev = soc;
+    }
+}
+
+ZTEST(ring_analytics, test_battery_low_hysteresis) {
+    zassert_false(battery_low_state(false, BATTERY_LOW_ENTER_LEVEL + 1));
+    zassert_true(battery_low_state(false, BATTERY_LOW_ENTER_LEVEL));
+    zassert_true(battery_low_state(true, BATTERY_LOW_EXIT_LEVEL - 1));
+    zassert_false(battery_low_state(true, BATTERY_LOW_EXIT_LEVEL));
+    zassert_equal(battery_band_get(true, 90), BATTERY_BAND_LOW);
+    zassert_equal(battery_band_get(false, BATTERY_REDUCED_LEVEL), BATTERY_BAND_REDUCED);
+    zassert_equal(battery_band_get(false, BATTERY_REDUCED_LEVEL + 1), BATTERY_BAND_NORMAL);
+}
+
+// 1M：(前导码 1 + 接入地址 4 + 头 2 + 载荷 + CRC 3) × 8 µs + 40 µs 启动
+ZTEST(ring_analytics, test_adv_airtime) {
+    zassert_equal(adv_event_airtime_us(0, false, false), 3 * ((10 + 6) * 8 + 40));
+    zassert_equal(adv_event_airtime_us(18, true, false),
+                  3 * ((10 + 7) * 8 + 40) + (10 + 10 + 18) * 8 + 40);
+    // AUX_SYNC_IND 只多一个扩展头长度字节
+    zassert_equal(per_adv_event_airtime_us(20, false), (10 + 1 + 20) * 8 + 40);
+    zassert_equal(per_adv_event_airtime_us(20, true), 376 + (2 + 1 + 20 + 3) * 64 + 24 + 40);
+    // 同样的载荷，周期广播一个事件只发一次，比扩展广播事件短
+    for (uint8_t len = 0; len < 200; len += 10)
+        zassert_true(per_adv_event_airtime_us(len, false) < adv_event_airtime_us(len, true, false));
+}
+
+ZTEST_SUITE(ring_analytics, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,96 @@
+// test_rssi_filter.c -- 四种 RSSI 滤波模式
+#include <zephyr/ztest.h>
+#include "rssi_filter.h"
+
+static const rssi_filter_mode_t modes[] = {
+    RSSI_FILTER_BOXCAR, RSSI_FILTER_EMA, RSSI_FILTER_MEDIAN, RSSI_FILTER_KALMAN,
+};
+
+// 输入 n 个相同样本后的输出；没有输出时返回 INT8_MIN
+static int8_t feed(struct rssi_filter *f, int8_t rssi, int n) {
+    int8_t out;
+
+    while (n--)
+        rssi_filter_add(f, rssi);
+    return rssi_filter_get(f, &out) ? out : INT8_MIN;
+}
+
+ZTEST(rssi_filter, test_empty) {
+    struct rssi_filter f;
+    int8_t rssi = 7;
+
+    for (size_t i = 0; i < ARRAY_SIZE(modes); i++) {
+        rssi_filter_init(&f, modes[i]);
+        zassert_false(rssi_filter_get(&f, &rssi), "%s", rssi_filter_mode_str(modes[i]));
+        zassert_equal(rssi, 7, "output written without samples");
+    }
+}
+
+// 恒定输入时每种模式都输出输入值，首个样本立即生效
+ZTEST(rssi_filter, test_constant_input) {
+    struct rssi_filter f;
+
+    for (size_t i = 0; i < ARRAY_SIZE(modes); i++) {
+        rssi_filter_init(&f, modes[i]);
+        zassert_equal(feed(&f, -63, 1), -63, "%s", rssi_filter_mode_str(modes[i]));
+        zassert_equal(feed(&f, -63, 40), -63, "%s", rssi_filter_mode_str(modes[i]));
+    }
+}
+
+ZTEST(rssi_filter, test_boxcar_window) {
+    struct rssi_filter f;
+
+    rssi_filter_init(&f, RSSI_FILTER_BOXCAR);
+    rssi_filter_add(&f, -60);
+    zassert_equal(feed(&f, -70, 1), -65);
+    // 整个窗口被新值替换后，旧值不再影响平均
+    zassert_equal(feed(&f, -80, RSSI_FILTER_WINDOW), -80);
+}
+
+// 单个离群值不改变中值
+ZTEST(rssi_filter, test_median_rejects_outlier) {
+    struct rssi_filter f;
+
+    rssi_filter_init(&f, RSSI_FILTER_MEDIAN);
+    feed(&f, -60, RSSI_FILTER_WINDOW);
+    zassert_equal(feed(&f, -20, 1), -60);
+    zassert_equal(feed(&f, -90, 1), -60);
+    // 窗口中的离群值被移出后仍保持有序
+    zassert_equal(feed(&f, -61, RSSI_FILTER_WINDOW), -61);
+}
+
+// 阶跃 20 dB 后，EMA 和卡尔曼在有限样本内收敛到 1 dB 以内且不超调
+ZTEST(rssi_filter, test_step_convergence) {
+    static const rssi_filter_mode_t smooth[] = { RSSI_FILTER_EMA, RSSI_FILTER_KALMAN };
+    struct rssi_filter f;
+
+    for (size_t i = 0; i < ARRAY_SIZE(smooth); i++) {
+        int8_t out, prev = -60;
+        int n;
+
+        rssi_filter_init(&f, smooth[i]);
+        feed(&f, -60, 50);
+        for (n = 1; n <= 60; n++) {
+            out = feed(&f, -80, 1);
+            zassert_true(out <= prev && out >= -80, "%s: %d", rssi_filter_mode_str(smooth[i]), out);
+            prev = out;
+            if (out <= -79)
+                break;
+        }
+        zassert_true(n <= 40, "%s took %d samples", rssi_filter_mode_str(smooth[i]), n);
+    }
+}
+
+ZTEST(rssi_filter, test_set_mode_clears_history) {
+    struct rssi_filter f;
+    int8_t rssi;
+
+    rssi_filter_init(&f, RSSI_FILTER_EMA);
+    feed(&f, -50, 10);
+    rssi_filter_set_mode(&f, RSSI_FILTER_MEDIAN);
+    zassert_false(rssi_filter_get(&f, &rssi));
+    zassert_equal(feed(&f, -75, 1), -75);
+    zassert_str_equal(rssi_filter_mode_str(RSSI_FILTER_KALMAN), "Kalman");
+}
+
+ZTEST_SUITE(rssi_filter, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,24 @@
+// captures.h -- 基准回放的 RSSI 采集 (scripts/rssi_capture.py 转换)，按 ACTIVE 轮询周期采样。
+// 新采集放到 captures/ 下并加进 captures[]；采集的来源写在各 .inc 文件头里
+#ifndef CAPTURES_H
+#define CAPTURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+struct capture {
+    const char *name;
+    const int8_t *rssi;
+    size_t len;
+};
+
+static const int8_t standin_rooms[] = {
+#include "../captures/standin_rooms.inc"
+};
+
+static const struct capture captures[] = {
+    { "standin_rooms", standin_rooms, ARRAY_SIZE(standin_rooms) },
+};
+
+#endif // CAPTURES_H
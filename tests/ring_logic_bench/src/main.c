@@ -0,0 +1,204 @@
+// main.c -- ring_logic 基准：RSSI 滤波 + 距离区域跟踪的每样本周期数、阶跃收敛时间、
+// 区域翻转次数。每个版本跑一次，和上一版本的输出对比。
+// 轨迹为固定种子生成的合成轨迹，另外回放 captures.h 里的 RSSI 采集，均按 ACTIVE 模式的
+// RSSI 轮询周期采样。
+// native_sim 上代码执行不推进仿真时间，周期数为 0，以硬件上的结果为准
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/timing/timing.h>
+#include "distance_tracker.h"
+#include "ring_analytics.h"
+#include "rssi_filter.h"
+#include "captures.h"
+
+#define SAMPLE_MS    RSSI_INTERVAL_ACTIVE
+#define TRACE_LEN    600                 // 30 分钟
+#define STEP_AT      100
+#define STEP_FROM    (-60)
+#define STEP_TO      (-80)
+#define TIMING_RUNS  20
+
+enum trace_id {
+    TRACE_HOVER,     // 静止在 MEDIUM/FAR 边界上，4 dB 噪声
+    TRACE_WALK,      // 从 -45 dBm 走到 -90 dBm，4 dB 噪声加人体遮挡的短时衰落
+    TRACE_STEP,      // STEP_FROM 到 STEP_TO 的阶跃，无噪声
+    TRACE_COUNT
+};
+
+static const char *const trace_names[TRACE_COUNT] = { "hover", "walk", "step" };
+static const rssi_filter_mode_t modes[] = {
+    RSSI_FILTER_BOXCAR, RSSI_FILTER_EMA, RSSI_FILTER_MEDIAN, RSSI_FILTER_KALMAN,
+};
+
+static int8_t traces[TRACE_COUNT][TRACE_LEN];
+static const struct ring_tunables tunables = RING_TUNABLES_DEFAULT;
+static const struct distance_tracker_config tracker_cfg = DISTANCE_TRACKER_CONFIG_DEFAULT;
+static uint32_t rng = 0x2545f491;
+
+static uint32_t rng_next(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// 四个均匀分布之和近似正态分布，sigma 为标准差 (dB)
+static int noise(int sigma) {
+    int32_t sum = 0;
+
+    for (int i = 0; i < 4; i++)
+        sum += (int32_t)(rng_next() % 1001) - 500;
+    // 四个 [-500, 500] 均匀分布之和的标准差约 577
+    return sum * sigma / 577;
+}
+
+static int8_t clamp_rssi(int v) {
+    return (int8_t)CLAMP(v, -127, 20);
+}
+
+static void traces_build(void) {
+    int fade = 0;
+
+    for (int i = 0; i < TRACE_LEN; i++) {
+        int walk = -45 - 45 * i / (TRACE_LEN - 1);
+
+        traces[TRACE_HOVER][i] = clamp_rssi(RSSI_MEDIUM_THRESHOLD + noise(4));
+        // 大约每分钟一次、持续 2 到 3 个样本的 10 dB 衰落
+        if (!fade && rng_next() % 20 == 0)
+            fade = 2 + rng_next() % 2;
+        if (fade) {
+            walk -= 10;
+            fade--;
+        }
+        traces[TRACE_WALK][i] = clamp_rssi(walk + noise(4));
+        traces[TRACE_STEP][i] = i < STEP_AT ? STEP_FROM : STEP_TO;
+    }
+}
+
+struct run_result {
+    uint16_t raw_changes;      // 滤波后直接查阈值
+    uint16_t raw_flaps;
+    uint16_t changes;          // 经过距离跟踪器
+    uint16_t flaps;
+    int16_t settle;            // 阶跃后滤波输出进入 1 dB 以内的样本数，-1 为未收敛
+    int16_t zone_settle;       // 阶跃后跟踪器报告新区域的样本数
+};
+
+// 方向与上一次变化相反的区域变化记为一次翻转
+static void count_change(distance_level_t from, distance_level_t to, int *last_dir,
+                         uint16_t *changes, uint16_t *flaps) {
+    int dir = to > from ? 1 : -1;
+
+    (*changes)++;
+    if (*last_dir && dir != *last_dir)
+        (*flaps)++;
+    *last_dir = dir;
+}
+
+static void run(const int8_t *trace, size_t len, rssi_filter_mode_t mode,
+                struct run_result *r) {
+    struct rssi_filter filter;
+    struct distance_tracker tracker;
+    distance_level_t raw = DISTANCE_UNKNOWN;
+    int raw_dir = 0, dir = 0;
+
+    *r = (struct run_result){ .settle = -1, .zone_settle = -1 };
+    rssi_filter_init(&filter, mode);
+    distance_tracker_init(&tracker);
+    for (size_t i = 0; i < len; i++) {
+        distance_level_t zone = tracker.zone;
+        distance_level_t level;
+        int8_t rssi;
+
+        rssi_filter_add(&filter, trace[i]);
+        rssi_filter_get(&filter, &rssi);
+        level = estimate_distance(&tunables, rssi);
+        if (raw != DISTANCE_UNKNOWN && level != raw)
+            count_change(raw, level, &raw_dir, &r->raw_changes, &r->raw_flaps);
+        raw = level;
+        if (distance_tracker_update(&tracker, &tracker_cfg, rssi, i * SAMPLE_MS) &&
+            zone != DISTANCE_UNKNOWN) {
+            count_change(zone, tracker.zone, &dir, &r->changes, &r->flaps);
+            if (i >= STEP_AT && r->zone_settle < 0)
+                r->zone_settle = i - STEP_AT + 1;
+        }
+        if (i >= STEP_AT && r->settle < 0 && rssi <= STEP_TO + 1)
+            r->settle = i - STEP_AT + 1;
+    }
+}
+
+// 滤波、取值和区域跟踪合计的每样本周期数，取多次运行的最小值
+static uint32_t cycles_per_sample(rssi_filter_mode_t mode) {
+    uint64_t best = UINT64_MAX;
+
+    for (int n = 0; n < TIMING_RUNS; n++) {
+        struct rssi_filter filter;
+        struct distance_tracker tracker;
+        timing_t start, end;
+        uint64_t cycles;
+        int8_t rssi;
+
+        rssi_filter_init(&filter, mode);
+        distance_tracker_init(&tracker);
+        start = timing_counter_get();
+        for (int t = 0; t < TRACE_COUNT; t++) {
+            for (int i = 0; i < TRACE_LEN; i++) {
+                rssi_filter_add(&filter, traces[t][i]);
+                rssi_filter_get(&filter, &rssi);
+                distance_tracker_update(&tracker, &tracker_cfg, rssi, i * SAMPLE_MS);
+            }
+        }
+        end = timing_counter_get();
+        cycles = timing_cycles_get(&start, &end);
+        best = MIN(best, cycles);
+    }
+    return (uint32_t)(best / (TRACE_COUNT * TRACE_LEN));
+}
+
+int main(void) {
+    struct run_result r;
+
+    timing_init();
+    timing_start();
+    traces_build();
+
+    printk("ring_logic bench: %d samples per trace, %d ms per sample\n", TRACE_LEN, SAMPLE_MS);
+    printk("hysteresis %d dB, dwell %d ms, filter window %d, EMA alpha %d/256\n",
+           DISTANCE_HYSTERESIS_DB, DISTANCE_DWELL_MS, RSSI_FILTER_WINDOW, RSSI_FILTER_EMA_ALPHA);
+
+    printk("\ncycles per sample (filter + tracker)\n");
+    for (size_t m = 0; m < ARRAY_SIZE(modes); m++)
+        printk("  %-7s %u\n", rssi_filter_mode_str(modes[m]), cycles_per_sample(modes[m]));
+
+    printk("\nstep %d -> %d dBm: samples (ms) until within 1 dB / zone reported\n",
+           STEP_FROM, STEP_TO);
+    for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+        run(traces[TRACE_STEP], TRACE_LEN, modes[m], &r);
+        printk("  %-7s %d (%d) / %d (%d)\n", rssi_filter_mode_str(modes[m]), r.settle,
+               r.settle * SAMPLE_MS, r.zone_settle, r.zone_settle * SAMPLE_MS);
+    }
+
+    printk("\nzone changes/flaps: filtered thresholds vs tracker\n");
+    for (int t = 0; t < TRACE_STEP; t++) {
+        for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+            run(traces[t], TRACE_LEN, modes[m], &r);
+            printk("  %-5s %-7s %u/%u vs %u/%u\n", trace_names[t], rssi_filter_mode_str(modes[m]),
+                   r.raw_changes, r.raw_flaps, r.changes, r.flaps);
+        }
+    }
+
+    printk("\nzone changes/flaps on captures: filtered thresholds vs tracker\n");
+    for (size_t c = 0; c < ARRAY_SIZE(captures); c++) {
+        printk("  %s: %u samples\n", captures[c].name, (unsigned int)captures[c].len);
+        for (size_t m = 0; m < ARRAY_SIZE(modes); m++) {
+            run(captures[c].rssi, captures[c].len, modes[m], &r);
+            printk("    %-7s %u/%u vs %u/%u\n", rssi_filter_mode_str(modes[m]),
+                   r.raw_changes, r.raw_flaps, r.changes, r.flaps);
+        }
+    }
+
+    timing_stop();
+    printk("\nbench done\n");
+    return 0;
+}